@@ -0,0 +1,301 @@
+/**
+ * @file ipc_bench.c
+ * author Animesh0817 (mailtome.anni@gmail.com)
+ * @brief Benchmark of libipc transports with per-message performance counters.
+ *
+ * Runs a workload over one transport inside a single process and reports
+ * latency together with cycles, instructions, cache misses, context switches
+ * and system calls per message (see ipc_perf.h):
+ * - socket: framed TCP ping-pong over loopback with an echo thread; the
+ *   socket tuning options (-w, -r, -b) apply to both ends;
+ * - slab: one-way stream through a shared-memory slab queue to a consumer
+ *   thread.
+ *
+ * Both transports can add CRC32C checksums to every message (-c).
+ *
+ * Example: `ipc_bench -t socket -n 100000 -s 64 -r 65536`
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <sys/socket.h>
+#include "ipc_socket.h"
+#include "ipc_slab.h"
+#include "ipc_perf.h"
+
+/**
+ * A Structure that will hold the benchmark settings:
+ * Transport, message count and size
+ * Socket port and tuning options
+ * Whether messages carry CRC32C checksums
+ */
+typedef struct {
+    const char *transport; /**< "socket" or "slab". */
+    long messages; /**< Messages to exchange. */
+    size_t size; /**< Message size in bytes. */
+    int port; /**< Loopback port of the socket transport. */
+    size_t write_buffer; /**< ipc_socket_set_write_buffer() capacity, 0 for none. */
+    size_t read_ahead; /**< ipc_socket_set_read_ahead() capacity, 0 for none. */
+    unsigned int spin_us; /**< ipc_socket_set_busy_poll() budget, 0 for none. */
+    int checksum; /**< Compute and verify CRC32C checksums on both ends. */
+} bench_config_t;
+
+static bench_config_t config = { "socket", 100000, 64, 9099, 0, 0, 0, 0 };
+
+/**
+ * @brief Apply the socket tuning options to a connected socket.
+ */
+static int tune_socket(ipc_handle_t *sock) {
+    if (config.write_buffer && ipc_socket_set_write_buffer(sock, config.write_buffer, 0) != IPC_SUCCESS) {
+        return IPC_FAILURE;
+    }
+    if (config.read_ahead && ipc_socket_set_read_ahead(sock, config.read_ahead) != IPC_SUCCESS) {
+        return IPC_FAILURE;
+    }
+    if (config.spin_us && ipc_socket_set_busy_poll(sock, -1, config.spin_us) != IPC_SUCCESS) {
+        return IPC_FAILURE;
+    }
+    return ipc_socket_set_checksum(sock, config.checksum);
+}
+
+/**
+ * @brief Echo thread of the socket benchmark.
+ */
+static void *socket_echo(void *arg) {
+    ipc_handle_t *server = (ipc_handle_t *)arg;
+    ipc_handle_t *conn = server->accept(server);
+    char *buf = (char *)malloc(config.size ? config.size : 1);
+    int n;
+
+    if (conn && buf && tune_socket(conn) == IPC_SUCCESS) {
+        while ((n = conn->receive(conn, buf, config.size)) >= 0) {
+            if (conn->send(conn, buf, (size_t)n) != IPC_SUCCESS) {
+                break;
+            }
+        }
+    }
+    if (conn) {
+        conn->destroy(conn);
+    }
+    free(buf);
+    return NULL;
+}
+
+/**
+ * @brief Framed TCP ping-pong over loopback.
+ */
+static int bench_socket(ipc_perf_t *perf, ipc_perf_sample_t *sample) {
+    ipc_handle_t *server = ipc_socket_create("127.0.0.1", config.port, 1);
+    ipc_handle_t *client = ipc_socket_create("127.0.0.1", config.port, 0);
+    char *buf = (char *)calloc(1, config.size ? config.size : 1);
+    pthread_t echo;
+    int ret = IPC_FAILURE;
+
+    if (!server || !client || !buf) {
+        goto out;
+    }
+    ipc_socket_set_framing(server, 1);
+    ipc_socket_set_framing(client, 1);
+    if (server->init(server) != IPC_SUCCESS) {
+        printf("Failed to listen on port %d.\n", config.port);
+        goto out;
+    }
+    // The echo thread is created after the counters are opened, so it is counted
+    if (pthread_create(&echo, NULL, socket_echo, server) != 0) {
+        goto out;
+    }
+    if (client->init(client) == IPC_SUCCESS && tune_socket(client) == IPC_SUCCESS) {
+        ipc_perf_start(perf);
+        long i;
+        for (i = 0; i < config.messages; i++) {
+            if (client->send(client, buf, config.size) != IPC_SUCCESS ||
+                client->receive(client, buf, config.size) != (int)config.size) {
+                break;
+            }
+        }
+        ipc_perf_stop(perf, sample);
+        ret = i == config.messages ? IPC_SUCCESS : IPC_FAILURE;
+    }
+    client->destroy(client);
+    client = NULL;
+    // Wake the echo thread if it is still in accept() because the client never connected
+    shutdown(server->get_fd(server), SHUT_RDWR);
+    pthread_join(echo, NULL);
+
+out:
+    if (client) {
+        client->destroy(client);
+    }
+    if (server) {
+        server->destroy(server);
+    }
+    free(buf);
+    return ret;
+}
+
+/**
+ * A Structure that will hold the following:
+ * Handle the slab consumer reads from
+ * Number of messages it received
+ * Flag set once it stopped, so the producer no longer waits for room
+ */
+typedef struct {
+    ipc_handle_t *rx; /**< Consumer handle. */
+    long received; /**< Messages received. */
+    atomic_int done; /**< Set when the consumer thread exits. */
+} slab_consumer_t;
+
+/**
+ * @brief Consumer thread of the slab benchmark.
+ */
+static void *slab_consume(void *arg) {
+    slab_consumer_t *consumer = (slab_consumer_t *)arg;
+    const void *data;
+    uint64_t off;
+    size_t len;
+
+    while (consumer->received < config.messages) {
+        if (ipc_slab_receive_view(consumer->rx, &off, &data, &len, 5000) != IPC_SUCCESS) {
+            break;
+        }
+        ipc_slab_free(consumer->rx, off);
+        consumer->received++;
+    }
+    atomic_store(&consumer->done, 1);
+    return NULL;
+}
+
+/**
+ * @brief One-way stream through a shared-memory slab queue.
+ */
+static int bench_slab(ipc_perf_t *perf, ipc_perf_sample_t *sample) {
+    char name[64];
+    snprintf(name, sizeof(name), "/ipc_bench_%d", (int)getpid());
+
+    ipc_handle_t *tx = ipc_slab_create(name, 64 << 20, 1024, 1);
+    ipc_handle_t *rx = ipc_slab_create(name, 0, 0, 0);
+    char *buf = (char *)calloc(1, config.size ? config.size : 1);
+    slab_consumer_t consumer = { .rx = rx, .received = 0 };
+    pthread_t thread;
+    int ret = IPC_FAILURE;
+
+    if (!tx || !rx || !buf || tx->init(tx) != IPC_SUCCESS || rx->init(rx) != IPC_SUCCESS ||
+        ipc_slab_set_checksum(tx, config.checksum) != IPC_SUCCESS ||
+        ipc_slab_set_checksum(rx, config.checksum) != IPC_SUCCESS ||
+        pthread_create(&thread, NULL, slab_consume, &consumer) != 0) {
+        goto out;
+    }
+    ipc_perf_start(perf);
+    long i;
+    for (i = 0; i < config.messages; i++) {
+        int sent;
+        // Wait for the consumer when the queue or the heap is full, unless it gave up
+        while ((sent = tx->send(tx, buf, config.size)) != IPC_SUCCESS && (errno == EAGAIN || errno == ENOMEM) &&
+               !atomic_load(&consumer.done)) {
+            sched_yield();
+        }
+        if (sent != IPC_SUCCESS) {
+            break;
+        }
+    }
+    pthread_join(thread, NULL);
+    ipc_perf_stop(perf, sample);
+    ret = i == config.messages && consumer.received == config.messages ? IPC_SUCCESS : IPC_FAILURE;
+
+out:
+    if (rx) {
+        rx->destroy(rx);
+    }
+    if (tx) {
+        tx->destroy(tx);
+    }
+    ipc_slab_unlink(name);
+    free(buf);
+    return ret;
+}
+
+/**
+ * @brief Print the sample per message.
+ */
+static void report(const ipc_perf_sample_t *sample) {
+    double n = (double)config.messages;
+
+    printf("transport %s, %ld messages of %zu bytes\n", config.transport, config.messages, config.size);
+    printf("%-18s %14.1f\n", "ns/msg", sample->elapsed_ns / n);
+    for (int c = 0; c < IPC_PERF_COUNTERS; c++) {
+        if (sample->valid & (1u << c)) {
+            printf("%-18s %14.2f\n", ipc_perf_counter_name((ipc_perf_counter_t)c), sample->value[c] / n);
+        } else {
+            printf("%-18s %14s\n", ipc_perf_counter_name((ipc_perf_counter_t)c), "n/a");
+        }
+    }
+    uint32_t ipc_mask = (1u << IPC_PERF_CYCLES) | (1u << IPC_PERF_INSTRUCTIONS);
+    if ((sample->valid & ipc_mask) == ipc_mask && sample->value[IPC_PERF_CYCLES]) {
+        printf("%-18s %14.2f\n", "insn/cycle",
+               (double)sample->value[IPC_PERF_INSTRUCTIONS] / sample->value[IPC_PERF_CYCLES]);
+    }
+}
+
+/**
+ * @brief Print the command line options.
+ */
+static void usage(const char *prog) {
+    printf("Usage: %s [-t socket|slab] [-n messages] [-s size] [-p port] [-c]\n"
+           "          [-w write_buffer] [-r read_ahead] [-b spin_us]\n", prog);
+}
+
+/**
+ * @brief Main Driver Function.
+ */
+int main(int argc, char **argv) {
+    ipc_perf_sample_t sample;
+    int opt, ret;
+
+    while ((opt = getopt(argc, argv, "t:n:s:p:w:r:b:ch")) != -1) {
+        switch (opt) {
+        case 't': config.transport = optarg; break;
+        case 'n': config.messages = atol(optarg); break;
+        case 's': config.size = (size_t)atol(optarg); break;
+        case 'p': config.port = atoi(optarg); break;
+        case 'w': config.write_buffer = (size_t)atol(optarg); break;
+        case 'r': config.read_ahead = (size_t)atol(optarg); break;
+        case 'b': config.spin_us = (unsigned int)atoi(optarg); break;
+        case 'c': config.checksum = 1; break;
+        default: usage(argv[0]); return opt == 'h' ? 0 : 1;
+        }
+    }
+    if (config.messages <= 0) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    ipc_perf_t *perf = ipc_perf_open(1);
+    if (!perf) {
+        printf("No performance counters available: %s.\n", strerror(errno));
+        return 1;
+    }
+
+    if (strcmp(config.transport, "socket") == 0) {
+        ret = bench_socket(perf, &sample);
+    } else if (strcmp(config.transport, "slab") == 0) {
+        ret = bench_slab(perf, &sample);
+    } else {
+        usage(argv[0]);
+        ipc_perf_close(perf);
+        return 1;
+    }
+
+    if (ret == IPC_SUCCESS) {
+        report(&sample);
+    } else {
+        printf("Benchmark failed.\n");
+    }
+    ipc_perf_close(perf);
+    return ret == IPC_SUCCESS ? 0 : 1;
+}
@@ -0,0 +1,94 @@
+/**
+ * @file ipc_rpc_client.c
+ * author Animesh0817 (mailtome.anni@gmail.com)
+ * @brief RPC client using libipc: pipelines several calls on one connection.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ipc_socket.h"
+#include "ipc_rpc.h"
+
+#define SERVER_IP "127.0.0.1"
+#define PORT 8081
+#define MAX_MSG 1024
+#define MAX_INFLIGHT 64
+
+#define METHOD_ECHO 1
+#define METHOD_UPPER 2
+
+/**
+ * @brief Completion callback printing the response of one call.
+ */
+static void on_reply(ipc_rpc_t *rpc, int status, const void *resp, size_t len, void *user) {
+    (void)rpc;
+    printf("Call %s -> status %d: %.*s\n", (const char *)user, status, (int)len, (const char *)resp);
+}
+
+/**
+ * @brief Function to perform client side of RPC via LIBIPC.
+ */
+int rpc_client_example() {
+    static const char *words[] = { "alpha", "bravo", "charlie", "delta" };
+
+    ipc_handle_t *client_socket = ipc_socket_create(SERVER_IP, PORT, 0);  // Pass 0 for client
+    if (client_socket == NULL) {
+        printf("Failed to create client socket.\n");
+        return IPC_FAILURE;
+    }
+
+    ipc_socket_set_framing(client_socket, 1);
+
+    if (client_socket->init(client_socket) != IPC_SUCCESS) {
+        printf("Failed to initialize client socket.\n");
+        client_socket->destroy(client_socket);
+        return IPC_FAILURE;
+    }
+
+    ipc_rpc_t *rpc = ipc_rpc_create(client_socket, MAX_MSG, MAX_INFLIGHT);
+    if (rpc == NULL) {
+        printf("Failed to create RPC endpoint.\n");
+        client_socket->destroy(client_socket);
+        return IPC_FAILURE;
+    }
+
+    // Pipeline all calls before waiting for any response
+    for (size_t i = 0; i < sizeof(words) / sizeof(words[0]); i++) {
+        uint32_t method = (i % 2) ? METHOD_UPPER : METHOD_ECHO;
+        if (ipc_rpc_call_async(rpc, method, words[i], strlen(words[i]), on_reply, (void *)words[i], NULL) != IPC_SUCCESS) {
+            printf("Failed to send call %s.\n", words[i]);
+        }
+    }
+
+    // Collect responses in whatever order they arrive
+    while (ipc_rpc_pending(rpc) > 0) {
+        if (ipc_rpc_poll(rpc) != IPC_SUCCESS) {
+            printf("Connection failed with calls outstanding.\n");
+            break;
+        }
+    }
+
+    // A blocking call on the same connection
+    char buffer[MAX_MSG];
+    size_t len = 0;
+    int status = ipc_rpc_call(rpc, METHOD_UPPER, "sync", 4, buffer, sizeof(buffer), &len);
+    printf("Sync call -> status %d: %.*s\n", status, (int)len, buffer);
+
+    ipc_rpc_destroy(rpc);
+    client_socket->destroy(client_socket);
+
+    return IPC_SUCCESS;
+}
+
+/**
+ * @brief Main Driver Function.
+ */
+int main() {
+    int ret = -1;
+    printf("Starting IPC Library Example RPC Client Application...\n");
+
+    ret = rpc_client_example();
+    printf("IPC Library Example RPC Client Application completed. Return is %d\n", ret);
+    return ret;
+}
@@ -0,0 +1,115 @@
+/**
+ * @file ipc_rpc_server.c
+ * author Animesh0817 (mailtome.anni@gmail.com)
+ * @brief RPC server using libipc: many pipelined calls served on one connection.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include "ipc_socket.h"
+#include "ipc_rpc.h"
+#include "ipc.h"
+
+#define DEFAULT_IP "0.0.0.0"
+#define PORT 8081
+#define MAX_MSG 1024
+#define MAX_INFLIGHT 64
+
+#define METHOD_ECHO 1
+#define METHOD_UPPER 2
+
+/**
+ * @brief Handler for METHOD_ECHO: returns the request unchanged.
+ */
+static int echo_handler(ipc_rpc_t *rpc, uint64_t id, const void *req, size_t len, void *user) {
+    (void)user;
+    return ipc_rpc_respond(rpc, id, IPC_RPC_OK, req, len);
+}
+
+/**
+ * @brief Handler for METHOD_UPPER: returns the request in upper case.
+ */
+static int upper_handler(ipc_rpc_t *rpc, uint64_t id, const void *req, size_t len, void *user) {
+    char out[MAX_MSG];
+    (void)user;
+
+    for (size_t i = 0; i < len; i++) {
+        out[i] = (char)toupper(((const unsigned char *)req)[i]);
+    }
+    return ipc_rpc_respond(rpc, id, IPC_RPC_OK, out, len);
+}
+
+/**
+ * @brief Serves RPC requests on one client connection until it closes.
+ *
+ * @param client_sock The IPC socket handle for the connected client.
+ */
+int handle_client(ipc_handle_t *client_sock) {
+    ipc_rpc_t *rpc = ipc_rpc_create(client_sock, MAX_MSG, MAX_INFLIGHT);
+    if (rpc == NULL) {
+        printf("Failed to create RPC endpoint.\n");
+        client_sock->destroy(client_sock);
+        return IPC_FAILURE;
+    }
+
+    ipc_rpc_register(rpc, METHOD_ECHO, echo_handler, NULL);
+    ipc_rpc_register(rpc, METHOD_UPPER, upper_handler, NULL);
+
+    // Dispatch requests until the client disconnects
+    while (ipc_rpc_poll(rpc) == IPC_SUCCESS) {
+    }
+
+    ipc_rpc_destroy(rpc);
+    client_sock->destroy(client_sock);
+    return IPC_SUCCESS;
+}
+
+/**
+ * @brief Function to perform Server side of RPC via LIBIPC
+ */
+int rpc_server_example() {
+    ipc_handle_t *server_socket = ipc_socket_create(DEFAULT_IP, PORT, 1); // 1 for server
+    if (server_socket == NULL) {
+        printf("Failed to create server socket.\n");
+        return IPC_FAILURE;
+    }
+
+    // RPC needs message boundaries; accepted connections inherit framing
+    ipc_socket_set_framing(server_socket, 1);
+
+    if (server_socket->init(server_socket) != IPC_SUCCESS) {
+        printf("Failed to initialize server socket.\n");
+        server_socket->destroy(server_socket);
+        return IPC_FAILURE;
+    }
+
+    printf("RPC server listening on port %d\n", PORT);
+
+    while (1) {
+        ipc_handle_t *client_socket = server_socket->accept(server_socket);
+        if (client_socket == NULL) {
+            continue;
+        }
+
+        printf("Client connected\n");
+        handle_client(client_socket);
+    }
+
+    // Destroy the server socket (unreachable code)
+    server_socket->destroy(server_socket);
+    return IPC_SUCCESS;
+}
+
+/**
+ * @brief Main Driver function
+ */
+int main() {
+    int ret = -1;
+    printf("Starting IPC Library Example RPC Server Application...\n");
+
+    ret = rpc_server_example();
+    printf("IPC Library Example RPC Server Application completed. Return is %d\n", ret);
+    return ret;
+}
@@ -9,26 +9,28 @@
 #include <string.h>
 #include <unistd.h>
 #include "ipc_socket.h"
+#include "ipc_directory.h"
 
-#define SERVER_IP "127.0.0.1"
-#define PORT 8080
+#define CHANNEL "example_socket"
+#define WAIT_MS 10000
 #define BUFFER_SIZE 1024
 
 /**
  * @brief Function to perform client side of IPC via LIBIPC.
  */
 int socket_client_example() {
-    // Create a client IPC socket handle using libipc
-    ipc_handle_t *client_socket = ipc_socket_create(SERVER_IP, PORT, 0);  // Pass 0 for client
-    if (client_socket == NULL) {
-        printf("Failed to create client socket.\n");
+    // Resolve the server through the channel directory instead of a fixed address
+    ipc_directory_t *dir = ipc_directory_open(NULL, 0);
+    if (dir == NULL) {
+        printf("Failed to open the channel directory.\n");
         return IPC_FAILURE;
     }
 
-    // Initialize the client socket
-    if (client_socket->init(client_socket) != IPC_SUCCESS) {
-        printf("Failed to initialize client socket.\n");
-        client_socket->destroy(client_socket);
+    // Wait for the server to register, then connect to it
+    ipc_handle_t *client_socket = ipc_directory_attach(dir, CHANNEL, WAIT_MS);
+    ipc_directory_close(dir);
+    if (client_socket == NULL) {
+        printf("Failed to connect to channel %s.\n", CHANNEL);
         return IPC_FAILURE;
     }
 
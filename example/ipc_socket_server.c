@@ -10,9 +10,11 @@
 #include <unistd.h>
 #include "ipc_socket.h"
 #include "ipc.h"
+#include "ipc_directory.h"
 
 #define DEFAULT_IP "0.0.0.0"
 #define PORT 8080
+#define CHANNEL "example_socket"
 #define BUFFER_SIZE 1024
 
 /**
@@ -62,6 +64,14 @@ int socket_server_example() {
 
     printf("Server listening on port %d\n", PORT);
 
+    // Publish the channel so clients can find it without knowing the port
+    ipc_directory_t *dir = ipc_directory_open(NULL, 0);
+    ipc_directory_entry_t entry = { .transport = IPC_DIRECTORY_SOCKET, .port = PORT };
+    strcpy(entry.address, "127.0.0.1");
+    if (dir == NULL || ipc_directory_register(dir, CHANNEL, &entry) != IPC_SUCCESS) {
+        printf("Failed to register channel %s; clients cannot find the server.\n", CHANNEL);
+    }
+
     // Loop to accept and handle client connections
     while (1) {
         ipc_handle_t *client_socket = server_socket->accept((ipc_handle_t *)server_socket);
@@ -76,7 +86,11 @@ int socket_server_example() {
         handle_client(client_socket);
     }
 
-    // Destroy the server socket (unreachable code)
+    // Unregister and destroy the server socket (unreachable code)
+    if (dir != NULL) {
+        ipc_directory_unregister(dir, CHANNEL);
+        ipc_directory_close(dir);
+    }
     server_socket->destroy(server_socket);
     return IPC_SUCCESS;
 }
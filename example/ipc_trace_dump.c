@@ -0,0 +1,93 @@
+/**
+ * @file ipc_trace_dump.c
+ * author Animesh0817 (mailtome.anni@gmail.com)
+ * @brief Prints the latency histograms and recent records of a libipc trace.
+ *
+ * Runs as a separate process next to an application that enabled tracing
+ * with ipc_socket_enable_tracing(), e.g. `example_trace_dump /svc_conn1`.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <inttypes.h>
+#include "ipc_trace.h"
+
+#define RECENT_RECORDS 16
+
+static const char *metric_names[IPC_TRACE_METRICS] = {
+    "tx user+stack (handed to libipc -> scheduler)",
+    "tx kernel     (scheduler -> device)",
+    "tx peer       (device -> acknowledged)",
+    "rx queue      (kernel -> returned to caller)",
+};
+
+/**
+ * @brief Prints a latency difference, or '-' if either stamp is missing.
+ */
+static void print_delta(uint64_t from_ns, uint64_t to_ns) {
+    if (from_ns && to_ns && to_ns >= from_ns) {
+        printf(" %10" PRIu64, to_ns - from_ns);
+    } else {
+        printf(" %10s", "-");
+    }
+}
+
+/**
+ * @brief Function to dump a trace via LIBIPC.
+ */
+int trace_dump_example(const char *name) {
+    ipc_trace_t *trace = ipc_trace_open(name);
+    if (trace == NULL) {
+        printf("Failed to open trace %s.\n", name);
+        return -1;
+    }
+
+    printf("%-48s %10s %10s %10s %10s\n", "stage", "count", "avg ns", "p50 <= ns", "p99 <= ns");
+    for (int m = 0; m < IPC_TRACE_METRICS; m++) {
+        uint64_t count = 0, sum = 0;
+        ipc_trace_histogram(trace, m, NULL, &count, &sum);
+        printf("%-48s %10" PRIu64 " %10" PRIu64 " %10" PRIu64 " %10" PRIu64 "\n", metric_names[m], count,
+               count ? sum / count : 0, ipc_trace_percentile(trace, m, 0.50), ipc_trace_percentile(trace, m, 0.99));
+    }
+
+    // Read everything still in the ring and print the newest records
+    ipc_trace_record_t recs[RECENT_RECORDS];
+    ipc_trace_record_t chunk[RECENT_RECORDS];
+    uint64_t cursor = 0;
+    size_t kept = 0, n;
+    while ((n = ipc_trace_read(trace, &cursor, chunk, RECENT_RECORDS)) > 0) {
+        for (size_t i = 0; i < n; i++) {
+            recs[kept++ % RECENT_RECORDS] = chunk[i];
+        }
+    }
+
+    printf("\n%8s %4s %8s %10s %10s %10s\n", "seq", "dir", "bytes", "stack ns", "kernel ns", "peer/rx ns");
+    size_t first = kept > RECENT_RECORDS ? kept - RECENT_RECORDS : 0;
+    for (size_t i = first; i < kept; i++) {
+        const ipc_trace_record_t *r = &recs[i % RECENT_RECORDS];
+        printf("%8" PRIu64 " %4s %8u", r->seq, r->kind == IPC_TRACE_KIND_TX ? "tx" : "rx", r->len);
+        if (r->kind == IPC_TRACE_KIND_TX) {
+            print_delta(r->user_ns, r->sched_ns);
+            print_delta(r->sched_ns, r->kernel_ns);
+            print_delta(r->kernel_ns, r->ack_ns);
+        } else {
+            printf(" %10s %10s", "-", "-");
+            print_delta(r->kernel_ns, r->user_ns);
+        }
+        printf("\n");
+    }
+
+    ipc_trace_close(trace);
+    return 0;
+}
+
+/**
+ * @brief Main Driver function
+ */
+int main(int argc, char **argv) {
+    if (argc != 2) {
+        printf("Usage: %s <trace shm name>\n", argv[0]);
+        return 1;
+    }
+    return trace_dump_example(argv[1]);
+}
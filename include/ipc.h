@@ -130,9 +130,25 @@ typedef struct ipc_handle_t {
      */
     struct ipc_handle_t *(*accept)(struct ipc_handle_t *server_handle);
 
+    /**
+     * @brief Returns a pollable file descriptor for the IPC mechanism.
+     *
+     * The descriptor becomes readable when the handle has data to receive,
+     * so handles of different types can be waited on together in a single
+     * poll/epoll/io_uring loop. Sockets return their socket descriptor;
+     * shared-memory and queue backends return an eventfd "doorbell" that
+     * producers signal only while the consumer is parked (see ipc_doorbell.h).
+     *
+     * @param ctx context pointer for different IPCs to the function pointers
+     * @return The file descriptor on success, or a negative error code if the
+     *         mechanism has no pollable descriptor.
+     */
+    int (*get_fd)(void *ctx);
+
 } ipc_handle_t;
 
 ipc_handle_t *ipc_create();
 void ipc_destroy(ipc_handle_t *handle);
+int ipc_handle_get_fd(ipc_handle_t *handle);
 
 #endif // IPC_H
@@ -0,0 +1,34 @@
+/**
+ * @file ipc_crc32c.h
+ * author Animesh0817 (mailtome.anni@gmail.com)
+ * @brief CRC32C (Castagnoli) checksums for message integrity.
+ *
+ * The checksum is computed with the CPU's CRC32C instructions when it has
+ * them (SSE4.2 on x86-64, the CRC extension on ARMv8) and with a
+ * slice-by-8 table otherwise; the choice is made once at run time, and
+ * IPC_CRC32C_BACKEND=slice-by-8 in the environment forces the table. All
+ * implementations give the same result, so peers on different CPUs agree.
+ *
+ * Checksums can be chained over several buffers:
+ * @code
+ * uint32_t crc = ipc_crc32c(0, hdr, hdr_len);
+ * crc = ipc_crc32c(crc, payload, payload_len);
+ * @endcode
+ */
+
+#ifndef IPC_CRC32C_H
+#define IPC_CRC32C_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * @def IPC_CRC32C_SIZE
+ * @brief Size in bytes of a checksum on the wire or in shared memory.
+ */
+#define IPC_CRC32C_SIZE 4
+
+uint32_t ipc_crc32c(uint32_t crc, const void *data, size_t len);
+const char *ipc_crc32c_backend(void);
+
+#endif // IPC_CRC32C_H
@@ -0,0 +1,110 @@
+/**
+ * @file ipc_directory.h
+ * author Animesh0817 (mailtome.anni@gmail.com)
+ * @brief Shared-memory name service mapping channel names to transport parameters.
+ *
+ * The directory is a well-known POSIX shared-memory segment holding a hash
+ * table of channels. A server registers a channel under a name once it is
+ * ready to accept clients (after listen(), after creating its segment); a
+ * client resolves the name and attaches to it, so neither side hardcodes an
+ * address, a port or a segment name, and a client that starts first waits
+ * for the registration instead of retrying connect().
+ *
+ * Lookups are lock-free and never write to shared memory: each slot is
+ * guarded by a sequence counter, and a lookup copies the entry and retries if
+ * it changed meanwhile. A slot is bound to one name for the life of the
+ * segment, so registering a name again (after a restart, on another port)
+ * updates the entry in place, and unregistering only marks it missing.
+ * Clients waiting for a name sleep on a futex that every change wakes.
+ *
+ * Example usage:
+ * @code
+ * // Server
+ * ipc_directory_t *dir = ipc_directory_open(NULL, 0);
+ * ipc_directory_entry_t entry = { .transport = IPC_DIRECTORY_SOCKET,
+ *                                 .flags = IPC_DIRECTORY_FRAMED, .port = 8080 };
+ * strcpy(entry.address, "127.0.0.1");
+ * ipc_directory_register(dir, "pricing", &entry);
+ *
+ * // Client
+ * ipc_directory_t *dir = ipc_directory_open(NULL, 0);
+ * ipc_handle_t *chan = ipc_directory_attach(dir, "pricing", 5000);
+ * @endcode
+ */
+
+#ifndef IPC_DIRECTORY_H
+#define IPC_DIRECTORY_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "ipc.h"
+
+/**
+ * @def IPC_DIRECTORY_DEFAULT
+ * @brief Shared-memory name of the directory used when none is given.
+ */
+#define IPC_DIRECTORY_DEFAULT "/ipc_directory"
+
+/**
+ * @def IPC_DIRECTORY_SLOTS
+ * @brief Number of channels a directory created with 0 slots can hold.
+ */
+#define IPC_DIRECTORY_SLOTS 1024
+
+/**
+ * @def IPC_DIRECTORY_NAME_MAX
+ * @brief Size of a channel name, including the terminating NUL.
+ */
+#define IPC_DIRECTORY_NAME_MAX 64
+
+/**
+ * @def IPC_DIRECTORY_ADDRESS_MAX
+ * @brief Size of an entry address, including the terminating NUL.
+ */
+#define IPC_DIRECTORY_ADDRESS_MAX 128
+
+#define IPC_DIRECTORY_FRAMED (1u << 0) /**< Socket channel uses ipc_socket_set_framing(). */
+#define IPC_DIRECTORY_CHECKSUM (1u << 1) /**< Channel carries CRC32C checksums. */
+
+/**
+ * @brief Transport of a registered channel.
+ */
+typedef enum {
+    IPC_DIRECTORY_SOCKET = 1, /**< TCP: address is the IP address, port the TCP port. */
+    IPC_DIRECTORY_UDP, /**< UDP: address is the IP address, port the UDP port. */
+    IPC_DIRECTORY_SLAB, /**< Slab queue: address is the shared-memory name. */
+    IPC_DIRECTORY_SEQLOCK, /**< Seqlock channel: address is the shared-memory name. */
+    IPC_DIRECTORY_JOURNAL /**< Journal: address is the directory path, capacity the segment size. */
+} ipc_directory_transport_t;
+
+/**
+ * A Structure that will hold the following:
+ * Transport of the channel and its option flags
+ * Port, capacity and address, interpreted per transport
+ * Process that registered the channel
+ */
+typedef struct {
+    uint32_t transport; /**< ipc_directory_transport_t. */
+    uint32_t flags; /**< IPC_DIRECTORY_FRAMED, IPC_DIRECTORY_CHECKSUM. */
+    int32_t port; /**< TCP or UDP port, 0 for shared-memory transports. */
+    int32_t pid; /**< Registering process; filled in by ipc_directory_register(). */
+    uint64_t capacity; /**< Value capacity, heap size or segment size, 0 if not needed to attach. */
+    char address[IPC_DIRECTORY_ADDRESS_MAX]; /**< IP address, shared-memory name or path. */
+} ipc_directory_entry_t;
+
+/**
+ * @typedef ipc_directory_t
+ * @brief Opaque handle to a mapped directory segment.
+ */
+typedef struct ipc_directory ipc_directory_t;
+
+ipc_directory_t *ipc_directory_open(const char *name, size_t slots);
+void ipc_directory_close(ipc_directory_t *dir);
+int ipc_directory_unlink(const char *name);
+int ipc_directory_register(ipc_directory_t *dir, const char *channel, const ipc_directory_entry_t *entry);
+int ipc_directory_unregister(ipc_directory_t *dir, const char *channel);
+int ipc_directory_lookup(ipc_directory_t *dir, const char *channel, ipc_directory_entry_t *entry);
+int ipc_directory_wait(ipc_directory_t *dir, const char *channel, ipc_directory_entry_t *entry, int timeout_ms);
+ipc_handle_t *ipc_directory_attach(ipc_directory_t *dir, const char *channel, int timeout_ms);
+
+#endif // IPC_DIRECTORY_H
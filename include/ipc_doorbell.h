@@ -0,0 +1,97 @@
+/**
+ * @file ipc_doorbell.h
+ * author Animesh0817 (mailtome.anni@gmail.com)
+ * @brief eventfd based wake-up notification for shared-memory IPC backends.
+ *
+ * Shared-memory and queue backends have no kernel object that becomes
+ * readable when data arrives. A doorbell pairs an eventfd with a "parked"
+ * word that lives next to the queue (usually in the shared segment). The
+ * consumer sets the word before it blocks, and producers only pay for the
+ * eventfd write while it is set, so the fast path stays free of syscalls.
+ *
+ * Consumer protocol:
+ * @code
+ * while (queue_empty(q)) {
+ *     ipc_doorbell_park(&db);
+ *     if (!queue_empty(q)) {        // re-check after announcing ourselves
+ *         ipc_doorbell_unpark(&db);
+ *         break;
+ *     }
+ *     ipc_doorbell_wait(&db, -1);   // or poll ipc_doorbell_fd(&db)
+ *     ipc_doorbell_unpark(&db);
+ * }
+ * @endcode
+ *
+ * Producer protocol: publish the data, then call ipc_doorbell_ring().
+ *
+ * The header also holds the primitives the shared-memory backends build on:
+ * futex waits and wake-ups on a word in a shared mapping, absolute
+ * CLOCK_MONOTONIC deadlines for those waits, and the sequence counter used
+ * by the seqlock and directory slots.
+ *
+ * Seqcount writer:
+ * @code
+ * uint64_t seq = ipc_seqcount_write_begin(&slot->seq);
+ * ... update the guarded fields ...
+ * ipc_seqcount_write_end(&slot->seq, seq);
+ * @endcode
+ *
+ * Seqcount reader:
+ * @code
+ * for (int tries = 0; tries < IPC_SEQCOUNT_READ_RETRIES; tries++) {
+ *     uint64_t seq;
+ *     if (ipc_seqcount_read_begin(&slot->seq, &seq) != IPC_SUCCESS) {
+ *         continue;                 // write in progress
+ *     }
+ *     ... copy the guarded fields ...
+ *     if (ipc_seqcount_read_end(&slot->seq, seq) == IPC_SUCCESS) {
+ *         return ...;               // the copy is consistent
+ *     }
+ * }
+ * errno = EBUSY;
+ * @endcode
+ */
+
+#ifndef IPC_DOORBELL_H
+#define IPC_DOORBELL_H
+
+#include <stdatomic.h>
+#include <stdint.h>
+#include <time.h>
+#include "ipc.h"
+
+#define IPC_SEQCOUNT_READ_RETRIES 1000 /**< Copies a reader tries before giving up on a write in progress. */
+
+/**
+ * A Structure that will hold the following:
+ * eventfd used to wake the consumer
+ * Pointer to the parked word (shared or local)
+ * Local parked word used when no shared word is supplied
+ * Flag to indicate if the eventfd is owned and closed by the doorbell
+ */
+typedef struct {
+    int efd; /**< eventfd used to wake the consumer. */
+    atomic_uint *parked; /**< Non-zero while the consumer is blocked. */
+    atomic_uint local_parked; /**< Backing store when no shared word is given. */
+    int owns_fd; /**< Close efd in ipc_doorbell_close(). */
+} ipc_doorbell_t;
+
+int ipc_doorbell_open(ipc_doorbell_t *db, atomic_uint *parked);
+int ipc_doorbell_attach(ipc_doorbell_t *db, int efd, atomic_uint *parked);
+int ipc_doorbell_fd(const ipc_doorbell_t *db);
+void ipc_doorbell_park(ipc_doorbell_t *db);
+void ipc_doorbell_unpark(ipc_doorbell_t *db);
+int ipc_doorbell_ring(ipc_doorbell_t *db);
+int ipc_doorbell_wait(ipc_doorbell_t *db, int timeout_ms);
+void ipc_doorbell_close(ipc_doorbell_t *db);
+
+const struct timespec *ipc_futex_deadline(struct timespec *deadline, int timeout_ms);
+int ipc_futex_wait(atomic_uint *word, unsigned int seen, const struct timespec *deadline);
+void ipc_futex_wake(atomic_uint *word, int count);
+
+uint64_t ipc_seqcount_write_begin(atomic_uint_fast64_t *seq);
+void ipc_seqcount_write_end(atomic_uint_fast64_t *seq, uint64_t begun);
+int ipc_seqcount_read_begin(atomic_uint_fast64_t *seq, uint64_t *begun);
+int ipc_seqcount_read_end(atomic_uint_fast64_t *seq, uint64_t begun);
+
+#endif // IPC_DOORBELL_H
@@ -0,0 +1,69 @@
+/**
+ * @file ipc_frame.h
+ * author Animesh0817 (mailtome.anni@gmail.com)
+ * @brief Wire format for length-prefixed messages on stream transports.
+ *
+ * Stream transports such as TCP sockets have no message boundaries. When
+ * framing is enabled on a handle, every `send` is prefixed with a frame
+ * header and every `receive` returns exactly one message, which makes the
+ * handle message-oriented like the shared-memory backends. Layers such as
+ * RPC rely on this.
+ *
+ * Header layout (all fields in network byte order):
+ * @code
+ * +----------------+----------------+
+ * | length (u32)   | flags (u32)    |
+ * +----------------+----------------+
+ * | payload (length bytes) ...      |
+ * +----------------+----------------+
+ * | crc32c (u32), if flagged        |
+ * +---------------------------------+
+ * @endcode
+ *
+ * A frame with IPC_FRAME_FLAG_CRC32C is followed by the CRC32C of its
+ * payload (see ipc_crc32c.h), which the length field does not count.
+ */
+
+#ifndef IPC_FRAME_H
+#define IPC_FRAME_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * @def IPC_FRAME_HDR_SIZE
+ * @brief Size in bytes of an encoded frame header.
+ */
+#define IPC_FRAME_HDR_SIZE 8
+
+/**
+ * @def IPC_FRAME_MAX_PAYLOAD
+ * @brief Largest payload accepted in a single frame.
+ *
+ * Bounds the length field so that a corrupted or hostile header cannot make
+ * the receiver wait for gigabytes of data.
+ */
+#define IPC_FRAME_MAX_PAYLOAD (1U << 30)
+
+/**
+ * @def IPC_FRAME_FLAG_CRC32C
+ * @brief Frame flag: the payload is followed by its CRC32C.
+ */
+#define IPC_FRAME_FLAG_CRC32C (1U << 0)
+
+/**
+ * A Structure that will hold the following:
+ * Payload length in bytes
+ * Frame flags
+ */
+typedef struct {
+    uint32_t length; /**< Payload length in bytes. */
+    uint32_t flags; /**< Frame flags (IPC_FRAME_FLAG_*); unknown bits are ignored. */
+} ipc_frame_hdr_t;
+
+void ipc_frame_hdr_encode(void *buf, const ipc_frame_hdr_t *hdr);
+int ipc_frame_hdr_decode(const void *buf, ipc_frame_hdr_t *hdr);
+void ipc_frame_crc_encode(void *buf, uint32_t crc);
+uint32_t ipc_frame_crc_decode(const void *buf);
+
+#endif // IPC_FRAME_H
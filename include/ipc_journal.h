@@ -0,0 +1,108 @@
+/**
+ * @file ipc_journal.h
+ * author Animesh0817 (mailtome.anni@gmail.com)
+ * @brief Durable IPC through an append-only, memory-mapped, segmented log.
+ *
+ * A journal is a directory holding a small metadata file and a sequence of
+ * fixed-size segment files. Every `send` appends one framed record; every
+ * `receive` returns the record at the handle's read offset and advances it.
+ * Records stay on disk after they are read, so a consumer that restarts can
+ * seek back to the offset it last processed and catch up without the
+ * producer re-sending anything, and any reader can replay from any position.
+ *
+ * Several writers, in any number of processes, may append concurrently: a
+ * writer reserves space with a single atomic bump of the shared tail, copies
+ * its record in place through the mapping, then publishes it by writing the
+ * record header. Readers never take locks.
+ *
+ * Record layout (8-byte aligned):
+ * @code
+ * +------------------------+----------------------+--------------------+
+ * | state | length (u32)   | crc32c or 0 (u32)    | payload ...        |
+ * +------------------------+----------------------+--------------------+
+ * @endcode
+ *
+ * The checksum is written and verified by handles that enabled it with
+ * ipc_journal_set_checksum().
+ *
+ * A reader either blocks in ipc_journal_wait() or polls get_fd(), an eventfd
+ * doorbell armed by a read that finds nothing and rung by writers sharing it
+ * (see ipc_journal_attach_doorbell()).
+ *
+ * Example usage:
+ * @code
+ * ipc_handle_t *log = ipc_journal_create("/var/lib/svc/journal", 0);
+ * log->init(log);
+ * ipc_journal_seek(log, saved_offset);             // resume after a restart
+ * while (log->receive(log, buf, sizeof(buf)) >= 0) {
+ *     process(buf);
+ *     saved_offset = ipc_journal_position(log);
+ * }
+ * @endcode
+ */
+
+#ifndef IPC_JOURNAL_H
+#define IPC_JOURNAL_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "ipc.h"
+#include "ipc_doorbell.h"
+
+/**
+ * @def IPC_JOURNAL_DEFAULT_SEGMENT
+ * @brief Segment size used when ipc_journal_create() is given 0.
+ */
+#define IPC_JOURNAL_DEFAULT_SEGMENT (64u << 20)
+
+/**
+ * @def IPC_JOURNAL_HDR_SIZE
+ * @brief Size in bytes of a record header.
+ */
+#define IPC_JOURNAL_HDR_SIZE 8
+
+/**
+ * @def IPC_JOURNAL_MAX_RECORD
+ * @brief Largest payload of a single record (it must also fit in a segment).
+ */
+#define IPC_JOURNAL_MAX_RECORD ((1u << 28) - 1)
+
+/**
+ * A Structure that will hold the following:
+ * Base IPC handle structure
+ * Journal directory and the mapped metadata shared by all users
+ * Mapping of the segment currently written and of the one currently read
+ * Read offset of this handle
+ * Doorbell rung on append, returned by get_fd()
+ * Flag to indicate if records carry and verify a CRC32C
+ */
+typedef struct {
+    ipc_handle_t base; /**< Base IPC handle structure. */
+    char *dir; /**< Journal directory. */
+    size_t segment_size; /**< Size of one segment file (taken from the journal once opened). */
+    int meta_fd; /**< Descriptor of the metadata file. */
+    struct ipc_journal_meta *meta; /**< Mapped metadata (tail, wake-up words). */
+    uint64_t w_index; /**< Index of the segment mapped at w_map. */
+    unsigned char *w_map; /**< Mapping used by appends, or NULL. */
+    uint64_t r_index; /**< Index of the segment mapped at r_map. */
+    unsigned char *r_map; /**< Mapping used by reads, or NULL. */
+    uint64_t r_pos; /**< Offset of the next record to read. */
+    ipc_doorbell_t doorbell; /**< eventfd doorbell (efd is -1 until init()). */
+    int checksum; /**< Flag to indicate if records carry a CRC32C (see ipc_journal_set_checksum). */
+} ipc_journal_t;
+
+ipc_handle_t *ipc_journal_create(const char *dir, size_t segment_size);
+int ipc_journal_append(ipc_handle_t *handle, const void *data, size_t len, uint64_t *offset);
+int ipc_journal_read_view(ipc_handle_t *handle, const void **data, size_t *len);
+int ipc_journal_seek(ipc_handle_t *handle, uint64_t offset);
+uint64_t ipc_journal_position(ipc_handle_t *handle);
+uint64_t ipc_journal_tail(ipc_handle_t *handle);
+uint64_t ipc_journal_head(ipc_handle_t *handle);
+int ipc_journal_wait(ipc_handle_t *handle, int timeout_ms);
+int ipc_journal_sync(ipc_handle_t *handle);
+int ipc_journal_recover(ipc_handle_t *handle);
+int ipc_journal_truncate(ipc_handle_t *handle, uint64_t offset);
+int ipc_journal_attach_doorbell(ipc_handle_t *handle, int efd);
+int ipc_journal_set_checksum(ipc_handle_t *handle, int enable);
+
+#endif // IPC_JOURNAL_H
@@ -0,0 +1,82 @@
+/**
+ * @file ipc_mux.h
+ * author Animesh0817 (mailtome.anni@gmail.com)
+ * @brief Prioritized logical lanes multiplexed over one message-oriented IPC handle.
+ *
+ * A multiplexer carries up to IPC_MUX_MAX_LANES independent message streams
+ * ("lanes") over a single connection. Messages are cut into chunks of at most
+ * chunk_size bytes and the sender picks the next chunk to put on the wire
+ * across all lanes with queued data:
+ * - strictly by priority class first (class 0 is served before class 1, ...);
+ * - within a class by deficit round robin, so each lane gets a share of the
+ *   bandwidth proportional to its weight.
+ *
+ * A small control message queued behind a 50 MB bulk transfer therefore waits
+ * for at most one chunk instead of the whole transfer. The receiver
+ * reassembles chunks per lane and returns whole messages.
+ *
+ * The underlying handle must be message-oriented, e.g. a socket with
+ * ipc_socket_set_framing() enabled. Each chunk is one message on it:
+ * @code
+ * +-----------+-----------+----------------+---------------------+---------+
+ * | lane (u8) | flags(u8) | reserved (u16) | message length (u32)| data ...|
+ * +-----------+-----------+----------------+---------------------+---------+
+ * @endcode
+ *
+ * Example usage:
+ * @code
+ * ipc_socket_set_framing(sock, 1);
+ * ipc_mux_t *mux = ipc_mux_create(sock, 0, 64 << 20);
+ * ipc_mux_open_lane(mux, LANE_CONTROL, 0, 1);
+ * ipc_mux_open_lane(mux, LANE_BULK, 1, 1);
+ * ipc_mux_send(mux, LANE_BULK, blob, blob_len);       // thread A
+ * ipc_mux_send(mux, LANE_CONTROL, &cmd, sizeof(cmd)); // thread B, not stuck behind A
+ * @endcode
+ */
+
+#ifndef IPC_MUX_H
+#define IPC_MUX_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "ipc.h"
+
+/**
+ * @def IPC_MUX_MAX_LANES
+ * @brief Number of lanes; lane IDs must be below it.
+ */
+#define IPC_MUX_MAX_LANES 256
+
+/**
+ * @def IPC_MUX_PRIORITIES
+ * @brief Number of priority classes; 0 is the most urgent.
+ */
+#define IPC_MUX_PRIORITIES 8
+
+/**
+ * @def IPC_MUX_HDR_SIZE
+ * @brief Size in bytes of the header that precedes every chunk.
+ */
+#define IPC_MUX_HDR_SIZE 8
+
+/**
+ * @def IPC_MUX_DEFAULT_CHUNK
+ * @brief Chunk size used when ipc_mux_create() is given 0.
+ */
+#define IPC_MUX_DEFAULT_CHUNK (16u << 10)
+
+/**
+ * @typedef ipc_mux_t
+ * @brief Opaque multiplexer bound to one IPC handle.
+ */
+typedef struct ipc_mux ipc_mux_t;
+
+ipc_mux_t *ipc_mux_create(ipc_handle_t *handle, size_t chunk_size, size_t max_msg);
+void ipc_mux_destroy(ipc_mux_t *mux);
+int ipc_mux_open_lane(ipc_mux_t *mux, unsigned int lane, unsigned int priority, unsigned int weight);
+int ipc_mux_send(ipc_mux_t *mux, unsigned int lane, const void *msg, size_t len);
+int ipc_mux_queue(ipc_mux_t *mux, unsigned int lane, const void *msg, size_t len);
+int ipc_mux_flush(ipc_mux_t *mux);
+int ipc_mux_receive(ipc_mux_t *mux, unsigned int *lane, const void **msg, size_t *len);
+
+#endif // IPC_MUX_H
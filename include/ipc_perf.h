@@ -0,0 +1,73 @@
+/**
+ * @file ipc_perf.h
+ * author Animesh0817 (mailtome.anni@gmail.com)
+ * @brief Hardware and software performance counters around IPC workloads.
+ *
+ * A thin wrapper over perf_event_open() that counts CPU cycles,
+ * instructions, cache misses, context switches and system calls between
+ * ipc_perf_start() and ipc_perf_stop(). Dividing the counts by the number
+ * of messages exchanged shows why a transport got slower, not just that it
+ * did: more syscalls per message, more cache misses from an extra copy, or
+ * context switches from blocking receives.
+ *
+ * Counters the kernel or the machine does not provide (no PMU in a VM,
+ * tracefs not mounted, perf_event_paranoid too strict) are left out and
+ * marked invalid in the sample; the others still work.
+ *
+ * Example usage:
+ * @code
+ * ipc_perf_t *perf = ipc_perf_open(1);
+ * ipc_perf_sample_t sample;
+ * ipc_perf_start(perf);
+ * for (int i = 0; i < n; i++) {
+ *     handle->send(handle, msg, len);
+ * }
+ * ipc_perf_stop(perf, &sample);
+ * if (sample.valid & (1u << IPC_PERF_CACHE_MISSES)) {
+ *     printf("%.2f cache misses/msg\n", (double)sample.value[IPC_PERF_CACHE_MISSES] / n);
+ * }
+ * ipc_perf_close(perf);
+ * @endcode
+ */
+
+#ifndef IPC_PERF_H
+#define IPC_PERF_H
+
+#include <stdint.h>
+#include "ipc.h"
+
+/**
+ * @brief Events counted by an ipc_perf_t.
+ */
+typedef enum {
+    IPC_PERF_CYCLES = 0, /**< CPU cycles. */
+    IPC_PERF_INSTRUCTIONS = 1, /**< Retired instructions. */
+    IPC_PERF_CACHE_MISSES = 2, /**< Last-level cache misses. */
+    IPC_PERF_CONTEXT_SWITCHES = 3, /**< Context switches. */
+    IPC_PERF_SYSCALLS = 4, /**< System call entries (raw_syscalls:sys_enter). */
+    IPC_PERF_COUNTERS = 5 /**< Number of counters. */
+} ipc_perf_counter_t;
+
+/**
+ * A Structure that will hold the following:
+ * Counter values between start and stop, scaled if the kernel multiplexed them
+ * Mask of the counters that were measured
+ * Wall-clock time between start and stop
+ */
+typedef struct {
+    uint64_t value[IPC_PERF_COUNTERS]; /**< Counter values, indexed by ipc_perf_counter_t. */
+    uint32_t valid; /**< Bit (1u << counter) is set for each counter in value. */
+    uint64_t elapsed_ns; /**< CLOCK_MONOTONIC time between start and stop. */
+} ipc_perf_sample_t;
+
+/** Opaque set of counters. */
+typedef struct ipc_perf ipc_perf_t;
+
+ipc_perf_t *ipc_perf_open(int inherit);
+int ipc_perf_start(ipc_perf_t *perf);
+int ipc_perf_stop(ipc_perf_t *perf, ipc_perf_sample_t *sample);
+uint32_t ipc_perf_available(const ipc_perf_t *perf);
+const char *ipc_perf_counter_name(ipc_perf_counter_t counter);
+void ipc_perf_close(ipc_perf_t *perf);
+
+#endif // IPC_PERF_H
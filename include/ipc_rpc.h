@@ -0,0 +1,91 @@
+/**
+ * @file ipc_rpc.h
+ * author Animesh0817 (mailtome.anni@gmail.com)
+ * @brief Request/response RPC layer over any message-oriented IPC handle.
+ *
+ * Every request carries a 64-bit correlation ID, so many calls can be in
+ * flight on one connection and responses may arrive in any order. Incoming
+ * requests are dispatched through a table that maps method IDs to handlers.
+ *
+ * The underlying handle must be message-oriented: each `send` delivers one
+ * message and each `receive` returns one message and its length. For sockets
+ * this means enabling framing with ipc_socket_set_framing().
+ *
+ * Example usage:
+ * @code
+ * ipc_socket_set_framing(sock, 1);
+ * ipc_rpc_t *rpc = ipc_rpc_create(sock, 4096, 256);
+ * ipc_rpc_call_async(rpc, METHOD_GET, key, key_len, on_reply, ctx, NULL);
+ * ipc_rpc_call_async(rpc, METHOD_GET, key2, key2_len, on_reply, ctx, NULL);
+ * while (ipc_rpc_pending(rpc) > 0) {
+ *     ipc_rpc_poll(rpc);   // invokes on_reply as responses arrive
+ * }
+ * ipc_rpc_destroy(rpc);
+ * @endcode
+ */
+
+#ifndef IPC_RPC_H
+#define IPC_RPC_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "ipc.h"
+
+/**
+ * @def IPC_RPC_MAX_METHODS
+ * @brief Number of entries in the dispatch table; method IDs must be below it.
+ */
+#define IPC_RPC_MAX_METHODS 256
+
+/**
+ * @def IPC_RPC_HDR_SIZE
+ * @brief Size in bytes of the RPC header that precedes every payload.
+ */
+#define IPC_RPC_HDR_SIZE 16
+
+/**
+ * @brief Status carried in RPC responses.
+ */
+typedef enum {
+    IPC_RPC_OK = 0, /**< The handler completed successfully. */
+    IPC_RPC_ERR_NO_METHOD = 1, /**< No handler is registered for the method ID. */
+    IPC_RPC_ERR_HANDLER = 2, /**< The handler reported a failure. */
+    IPC_RPC_ERR_TRANSPORT = 3, /**< The connection failed before a response arrived. */
+    IPC_RPC_ERR_TOO_LARGE = 4 /**< The response did not fit the caller's buffer. */
+} ipc_rpc_status_t;
+
+/**
+ * @typedef ipc_rpc_t
+ * @brief Opaque RPC endpoint bound to one IPC handle.
+ */
+typedef struct ipc_rpc ipc_rpc_t;
+
+/**
+ * @brief Handler invoked for an incoming request.
+ *
+ * The handler answers with ipc_rpc_respond(), either before returning or
+ * later from any thread, which lets a server complete requests out of order.
+ * Returning IPC_FAILURE without responding makes the layer answer with
+ * IPC_RPC_ERR_HANDLER.
+ */
+typedef int (*ipc_rpc_handler_t)(ipc_rpc_t *rpc, uint64_t id, const void *req, size_t len, void *user);
+
+/**
+ * @brief Completion callback invoked when a response arrives.
+ *
+ * The response buffer is only valid for the duration of the callback.
+ */
+typedef void (*ipc_rpc_callback_t)(ipc_rpc_t *rpc, int status, const void *resp, size_t len, void *user);
+
+ipc_rpc_t *ipc_rpc_create(ipc_handle_t *handle, size_t max_msg, size_t max_inflight);
+void ipc_rpc_destroy(ipc_rpc_t *rpc);
+int ipc_rpc_register(ipc_rpc_t *rpc, uint32_t method, ipc_rpc_handler_t handler, void *user);
+int ipc_rpc_call_async(ipc_rpc_t *rpc, uint32_t method, const void *req, size_t len,
+                       ipc_rpc_callback_t cb, void *user, uint64_t *id);
+int ipc_rpc_call(ipc_rpc_t *rpc, uint32_t method, const void *req, size_t len,
+                 void *resp, size_t cap, size_t *resp_len);
+int ipc_rpc_respond(ipc_rpc_t *rpc, uint64_t id, int status, const void *resp, size_t len);
+int ipc_rpc_poll(ipc_rpc_t *rpc);
+size_t ipc_rpc_pending(ipc_rpc_t *rpc);
+
+#endif // IPC_RPC_H
@@ -0,0 +1,71 @@
+/**
+ * @file ipc_seqlock.h
+ * author Animesh0817 (mailtome.anni@gmail.com)
+ * @brief "Last value wins" shared-memory channel protected by a seqlock.
+ *
+ * The channel is a named POSIX shared-memory segment holding a single value
+ * slot. Every `send` overwrites the slot; every `receive` returns the newest
+ * value published since the caller's previous receive, skipping whatever was
+ * overwritten in between. It suits feeds (prices, state snapshots) where only
+ * the latest value matters: a slow reader never works through a stale backlog
+ * and a writer never waits for readers.
+ *
+ * The slot is guarded by a sequence counter that is odd while a write is in
+ * progress. Readers copy the slot and retry if the counter was odd or changed
+ * during the copy, so any number of readers in any number of processes get a
+ * consistent snapshot without taking a lock or writing to shared memory.
+ *
+ * Example usage:
+ * @code
+ * // Publisher
+ * ipc_handle_t *feed = ipc_seqlock_create("/quotes", sizeof(quote_t), 1);
+ * feed->init(feed);
+ * feed->send(feed, &quote, sizeof(quote));
+ *
+ * // Subscriber
+ * ipc_handle_t *feed = ipc_seqlock_create("/quotes", 0, 0);
+ * feed->init(feed);
+ * while (feed->receive(feed, &quote, sizeof(quote)) >= 0) {
+ *     reprice(&quote);   // always the newest quote
+ * }
+ * @endcode
+ */
+
+#ifndef IPC_SEQLOCK_H
+#define IPC_SEQLOCK_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "ipc.h"
+#include "ipc_doorbell.h"
+
+/**
+ * A Structure that will hold the following:
+ * Base IPC handle structure
+ * Name and capacity of the shared segment, and whether this handle created it
+ * Mapping of the segment
+ * Version of the last value returned by receive
+ * Doorbell shared with pollers, when the eventfd is available
+ * Flag to indicate if values carry and verify a CRC32C
+ */
+typedef struct {
+    ipc_handle_t base; /**< Base IPC handle structure. */
+    char *name; /**< POSIX shared-memory name. */
+    size_t capacity; /**< Largest value the slot holds. */
+    int is_owner; /**< Create (and initialize) the segment in init(). */
+    struct ipc_seqlock_shm *shm; /**< Mapped segment. */
+    size_t map_size; /**< Size of the mapping. */
+    uint64_t last_version; /**< Version returned by the previous receive, 0 if none. */
+    ipc_doorbell_t doorbell; /**< eventfd doorbell (efd is -1 if unavailable). */
+    int checksum; /**< Flag to indicate if values carry a CRC32C (see ipc_seqlock_set_checksum). */
+} ipc_seqlock_t;
+
+ipc_handle_t *ipc_seqlock_create(const char *name, size_t capacity, int is_owner);
+int ipc_seqlock_unlink(const char *name);
+int ipc_seqlock_read(ipc_handle_t *handle, void *buffer, size_t size, uint64_t *version);
+uint64_t ipc_seqlock_version(ipc_handle_t *handle);
+int ipc_seqlock_wait(ipc_handle_t *handle, uint64_t version, int timeout_ms);
+int ipc_seqlock_attach_doorbell(ipc_handle_t *handle, int efd);
+int ipc_seqlock_set_checksum(ipc_handle_t *handle, int enable);
+
+#endif // IPC_SEQLOCK_H
@@ -0,0 +1,102 @@
+/**
+ * @file ipc_slab.h
+ * author Animesh0817 (mailtome.anni@gmail.com)
+ * @brief Shared-memory slab heap and offset queue for variable-size messages.
+ *
+ * A slab segment is a named POSIX shared-memory segment holding:
+ * - a heap carved into blocks of power-of-two size classes (64 bytes up to
+ *   IPC_SLAB_MAX_BLOCK), each class with its own lock-free free list, so any
+ *   process attached to the segment can allocate and free;
+ * - a bounded multi-producer/multi-consumer queue of block offsets.
+ *
+ * Offsets, not pointers, travel between processes because each process maps
+ * the segment at a different address. A sender allocates a block, builds the
+ * message directly in it and queues only its offset; the receiver reads the
+ * message in place and frees the block. No byte of the payload is copied by
+ * the transport:
+ * @code
+ * uint64_t off;
+ * struct order *o = ipc_slab_alloc(tx, sizeof(*o) + n, &off);
+ * fill_order(o, n);
+ * ipc_slab_send_offset(tx, off, sizeof(*o) + n);
+ *
+ * const void *msg;
+ * size_t len;
+ * ipc_slab_receive_view(rx, &off, &msg, &len, -1);
+ * handle_order(msg, len);
+ * ipc_slab_free(rx, off);
+ * @endcode
+ *
+ * The generic `send`/`receive` operations copy in and out of a block, for
+ * callers that only speak ipc_handle_t.
+ *
+ * Blocking receivers sleep on a futex inside the segment, which works between
+ * unrelated processes. get_fd() returns the doorbell eventfd of the process
+ * that created the segment; it is only usable by processes that obtained that
+ * eventfd, through fork() or SCM_RIGHTS and ipc_slab_attach_doorbell(), and
+ * only if every sender has it too.
+ */
+
+#ifndef IPC_SLAB_H
+#define IPC_SLAB_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "ipc.h"
+#include "ipc_doorbell.h"
+
+/**
+ * @def IPC_SLAB_MIN_BLOCK
+ * @brief Size of the smallest block, including its 8-byte header.
+ */
+#define IPC_SLAB_MIN_BLOCK 64
+
+/**
+ * @def IPC_SLAB_CLASSES
+ * @brief Number of size classes; block sizes are IPC_SLAB_MIN_BLOCK << class.
+ */
+#define IPC_SLAB_CLASSES 21
+
+/**
+ * @def IPC_SLAB_MAX_BLOCK
+ * @brief Size of the largest block (64 MiB).
+ */
+#define IPC_SLAB_MAX_BLOCK ((size_t)IPC_SLAB_MIN_BLOCK << (IPC_SLAB_CLASSES - 1))
+
+/**
+ * @def IPC_SLAB_BLOCK_HDR
+ * @brief Bytes of every block used for its header.
+ */
+#define IPC_SLAB_BLOCK_HDR 8
+
+/**
+ * A Structure that will hold the following:
+ * Base IPC handle structure
+ * Name and sizes of the shared segment, and whether this handle created it
+ * Mapping of the segment
+ * Doorbell shared with pollers, when the eventfd is available
+ * Flag to indicate if messages carry and verify a CRC32C
+ */
+typedef struct {
+    ipc_handle_t base; /**< Base IPC handle structure. */
+    char *name; /**< POSIX shared-memory name. */
+    size_t heap_size; /**< Bytes available for blocks. */
+    size_t queue_depth; /**< Number of offsets the queue holds. */
+    int is_owner; /**< Create (and initialize) the segment in init(). */
+    struct ipc_slab_shm *shm; /**< Mapped segment. */
+    size_t map_size; /**< Size of the mapping. */
+    ipc_doorbell_t doorbell; /**< eventfd doorbell (efd is -1 if unavailable). */
+    int checksum; /**< Flag to indicate if messages carry a CRC32C (see ipc_slab_set_checksum). */
+} ipc_slab_t;
+
+ipc_handle_t *ipc_slab_create(const char *name, size_t heap_size, size_t queue_depth, int is_owner);
+int ipc_slab_unlink(const char *name);
+void *ipc_slab_alloc(ipc_handle_t *handle, size_t len, uint64_t *offset);
+int ipc_slab_free(ipc_handle_t *handle, uint64_t offset);
+void *ipc_slab_ptr(ipc_handle_t *handle, uint64_t offset);
+int ipc_slab_send_offset(ipc_handle_t *handle, uint64_t offset, size_t len);
+int ipc_slab_receive_view(ipc_handle_t *handle, uint64_t *offset, const void **data, size_t *len, int timeout_ms);
+int ipc_slab_attach_doorbell(ipc_handle_t *handle, int efd);
+int ipc_slab_set_checksum(ipc_handle_t *handle, int enable);
+
+#endif // IPC_SLAB_H
@@ -23,14 +23,38 @@
   * File descriptor for the socket
   * Socket address information
   * Flag to indicate if this is a server or client socket.
+  * Flag to indicate if messages are length-prefixed.
+  * Flag to indicate if framed messages carry and verify a CRC32C.
+  * Latency tracing state, NULL unless tracing is enabled.
+  * Write buffer, NULL unless write coalescing is enabled.
+  * Read-ahead buffer, NULL unless read-ahead is enabled.
+  * Busy-poll spin budget, 0 unless busy polling is enabled.
   */
  typedef struct {
      ipc_handle_t base; /**< Base IPC handle structure. */
      int sockfd; /**< File descriptor for the socket. */
      struct sockaddr_in addr; /**< Socket address information. */
      int is_server; /**< Flag to indicate if this is a server or client socket. */
+     int framed; /**< Flag to indicate if messages are length-prefixed (see ipc_frame.h). */
+     int checksum; /**< Flag to indicate if framed messages carry a CRC32C (see ipc_socket_set_checksum). */
+     struct ipc_socket_trace *trace; /**< Latency tracing state (see ipc_socket_enable_tracing). */
+     struct ipc_socket_wbuf *wbuf; /**< Write buffer (see ipc_socket_set_write_buffer). */
+     struct ipc_socket_rbuf *rbuf; /**< Read-ahead buffer (see ipc_socket_set_read_ahead). */
+     unsigned int spin_us; /**< Busy-poll spin budget in microseconds (see ipc_socket_set_busy_poll). */
  } ipc_socket_t;
 
  ipc_handle_t *ipc_socket_create(const char *address, int port, int is_server);
+ int ipc_socket_set_framing(ipc_handle_t *handle, int enable);
+ int ipc_socket_set_checksum(ipc_handle_t *handle, int enable);
+ int ipc_send_file(ipc_handle_t *handle, int fd, off_t offset, size_t len);
+ int ipc_socket_enable_tracing(ipc_handle_t *handle, const char *trace_name, size_t capacity);
+ int ipc_socket_trace_poll(ipc_handle_t *handle);
+ int ipc_socket_disable_tracing(ipc_handle_t *handle);
+ int ipc_socket_set_write_buffer(ipc_handle_t *handle, size_t capacity, unsigned int flush_us);
+ int ipc_socket_flush(ipc_handle_t *handle);
+ int ipc_socket_flush_due(ipc_handle_t *handle, int *next_us);
+ int ipc_socket_set_read_ahead(ipc_handle_t *handle, size_t capacity);
+ int ipc_socket_receive_view(ipc_handle_t *handle, const void **data, size_t *len);
+ int ipc_socket_set_busy_poll(ipc_handle_t *handle, int cpu, unsigned int spin_us);
 
  #endif // IPC_SOCKET_H
@@ -0,0 +1,103 @@
+/**
+ * @file ipc_trace.h
+ * author Animesh0817 (mailtome.anni@gmail.com)
+ * @brief Per-message latency trace shared with other processes.
+ *
+ * A trace lives in a named POSIX shared-memory segment so that a separate
+ * process (a dashboard, a debugging tool) can read it while the traced
+ * application runs. It holds:
+ * - a ring buffer of per-message records with user-space and kernel
+ *   timestamps, overwritten oldest first;
+ * - log2 latency histograms for each stage of a message's journey, which
+ *   show whether time is spent queueing in user space, in the kernel, or
+ *   on the network and at the peer.
+ *
+ * All timestamps are CLOCK_REALTIME nanoseconds, the clock used by kernel
+ * software timestamps. A zero timestamp means the stage was not observed.
+ *
+ * Reading from another process:
+ * @code
+ * ipc_trace_t *trace = ipc_trace_open("/my_service_trace");
+ * uint64_t cursor = 0;
+ * ipc_trace_record_t recs[64];
+ * size_t n = ipc_trace_read(trace, &cursor, recs, 64);
+ * uint64_t p99 = ipc_trace_percentile(trace, IPC_TRACE_TX_PEER, 0.99);
+ * ipc_trace_close(trace);
+ * @endcode
+ */
+
+#ifndef IPC_TRACE_H
+#define IPC_TRACE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdatomic.h>
+#include "ipc.h"
+
+/**
+ * @def IPC_TRACE_BUCKETS
+ * @brief Number of histogram buckets; bucket i counts latencies in [2^(i-1), 2^i) ns.
+ */
+#define IPC_TRACE_BUCKETS 64
+
+/**
+ * @brief Direction of a traced message.
+ */
+typedef enum {
+    IPC_TRACE_KIND_TX = 1, /**< Message sent by the traced handle. */
+    IPC_TRACE_KIND_RX = 2 /**< Message received by the traced handle. */
+} ipc_trace_kind_t;
+
+/**
+ * @brief Latency stages tracked by the histograms.
+ */
+typedef enum {
+    IPC_TRACE_TX_STACK = 0, /**< Handed to libipc until it entered the packet scheduler. */
+    IPC_TRACE_TX_KERNEL, /**< Packet scheduler until handed to the device. */
+    IPC_TRACE_TX_PEER, /**< Handed to the device until acknowledged by the peer. */
+    IPC_TRACE_RX_QUEUE, /**< Received by the kernel until returned to the caller. */
+    IPC_TRACE_METRICS /**< Number of stages. */
+} ipc_trace_metric_t;
+
+/**
+ * A Structure that will hold one traced message:
+ * Publication sequence, direction and length
+ * User-space and kernel timestamps of each stage
+ */
+typedef struct {
+    uint64_t seq; /**< Position in the trace plus one; written last. */
+    uint32_t kind; /**< ipc_trace_kind_t. */
+    uint32_t len; /**< Message length in bytes. */
+    uint64_t user_ns; /**< TX: handed to libipc. RX: returned to the caller. */
+    uint64_t sched_ns; /**< TX: entered the packet scheduler. */
+    uint64_t kernel_ns; /**< TX: handed to the device. RX: received by the kernel. */
+    uint64_t ack_ns; /**< TX: acknowledged by the peer. */
+} ipc_trace_record_t;
+
+/**
+ * A Structure that will hold one latency histogram.
+ */
+typedef struct {
+    atomic_uint_fast64_t buckets[IPC_TRACE_BUCKETS]; /**< Sample counts per log2 bucket. */
+    atomic_uint_fast64_t count; /**< Number of samples. */
+    atomic_uint_fast64_t sum_ns; /**< Sum of all samples. */
+} ipc_trace_hist_t;
+
+/**
+ * @typedef ipc_trace_t
+ * @brief Opaque handle to a mapped trace segment.
+ */
+typedef struct ipc_trace ipc_trace_t;
+
+ipc_trace_t *ipc_trace_create(const char *name, size_t capacity);
+ipc_trace_t *ipc_trace_open(const char *name);
+void ipc_trace_close(ipc_trace_t *trace);
+int ipc_trace_unlink(const char *name);
+uint64_t ipc_trace_now(void);
+int ipc_trace_record(ipc_trace_t *trace, const ipc_trace_record_t *rec);
+size_t ipc_trace_read(ipc_trace_t *trace, uint64_t *cursor, ipc_trace_record_t *out, size_t max);
+int ipc_trace_histogram(ipc_trace_t *trace, int metric, uint64_t buckets[IPC_TRACE_BUCKETS],
+                        uint64_t *count, uint64_t *sum_ns);
+uint64_t ipc_trace_percentile(ipc_trace_t *trace, int metric, double pct);
+
+#endif // IPC_TRACE_H
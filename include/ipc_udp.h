@@ -0,0 +1,87 @@
+/**
+ * @file ipc_udp.h
+ * author Animesh0817 (mailtome.anni@gmail.com)
+ * @brief IPC using UDP datagrams, for loss-tolerant high-rate traffic.
+ *
+ * Each `send` is one datagram and each `receive` returns one datagram and its
+ * length. Delivery and ordering are not guaranteed.
+ *
+ * To move many small messages per syscall:
+ * - ipc_udp_set_batch() queues outgoing datagrams and flushes them with one
+ *   sendmmsg() call, and receives up to the batch size with one recvmmsg().
+ * - ipc_udp_set_offload() enables UDP generic segmentation (UDP_SEGMENT), so a
+ *   flush of equally sized datagrams is one buffer that the kernel or NIC
+ *   splits, and generic receive offload (UDP_GRO), so the kernel may deliver
+ *   several datagrams in one buffer that is split back up on receive.
+ *
+ * Example usage:
+ * @code
+ * ipc_handle_t *tx = ipc_udp_create("127.0.0.1", 9000, 0);
+ * ipc_udp_set_batch(tx, 32, 256);
+ * ipc_udp_set_offload(tx, 1, 0);
+ * tx->init(tx);
+ * for (int i = 0; i < n; i++) {
+ *     tx->send(tx, &samples[i], sizeof(samples[i]));   // flushed every 32
+ * }
+ * ipc_udp_flush(tx);
+ * @endcode
+ */
+
+#ifndef IPC_UDP_H
+#define IPC_UDP_H
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include "ipc.h"
+
+/**
+ * @def IPC_UDP_MAX_DATAGRAM
+ * @brief Largest UDP payload over IPv4.
+ */
+#define IPC_UDP_MAX_DATAGRAM 65507
+
+/**
+ * @def IPC_UDP_MAX_BATCH
+ * @brief Largest number of datagrams moved by one sendmmsg()/recvmmsg() call.
+ */
+#define IPC_UDP_MAX_BATCH 64
+
+/**
+ * A Structure that will hold the following:
+ * Base IPC handle structure
+ * File descriptor and addresses of the socket
+ * Transmit batch: queued payloads laid out back to back, with their destinations
+ * Receive batch: datagrams returned by the last recvmmsg() call
+ */
+typedef struct {
+    ipc_handle_t base; /**< Base IPC handle structure. */
+    int sockfd; /**< File descriptor for the socket. */
+    struct sockaddr_in addr; /**< Local address (server) or peer address (client). */
+    struct sockaddr_in peer; /**< Sender of the last datagram received by a server. */
+    int is_server; /**< Flag to indicate if this is a server or client socket. */
+    int gso; /**< Send equally sized batches as one UDP_SEGMENT buffer. */
+    int gro; /**< UDP_GRO is enabled on the socket. */
+    size_t batch; /**< Datagrams per sendmmsg()/recvmmsg() call. */
+    size_t max_msg; /**< Largest datagram expected on receive. */
+
+    unsigned char *tx_buf; /**< Queued payloads, back to back. */
+    size_t tx_used; /**< Bytes used in tx_buf. */
+    size_t tx_count; /**< Number of queued datagrams. */
+    size_t tx_len[IPC_UDP_MAX_BATCH]; /**< Length of each queued datagram. */
+    struct sockaddr_in tx_to[IPC_UDP_MAX_BATCH]; /**< Destination of each queued datagram (server only). */
+
+    struct ipc_udp_rx *rx; /**< Receive slots and recvmmsg() descriptors. */
+    size_t rx_count; /**< Slots filled by the last recvmmsg(). */
+    size_t rx_next; /**< Next slot to hand out. */
+    size_t rx_off; /**< Offset of the next segment within a GRO slot. */
+} ipc_udp_t;
+
+ipc_handle_t *ipc_udp_create(const char *address, int port, int is_server);
+int ipc_udp_set_batch(ipc_handle_t *handle, size_t batch, size_t max_msg);
+int ipc_udp_set_offload(ipc_handle_t *handle, int gso, int gro);
+int ipc_udp_flush(ipc_handle_t *handle);
+size_t ipc_udp_pending(ipc_handle_t *handle);
+
+#endif // IPC_UDP_H
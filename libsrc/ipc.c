@@ -31,7 +31,7 @@
  * @endcode
  */
 ipc_handle_t *ipc_create(void) {
-    ipc_handle_t *handle = (ipc_handle_t *)malloc(sizeof(ipc_handle_t));
+    ipc_handle_t *handle = (ipc_handle_t *)calloc(1, sizeof(ipc_handle_t));
     if (!handle) {
         return NULL;
     }
@@ -67,3 +67,28 @@ void ipc_destroy(ipc_handle_t *handle) {
         free(handle);
     }
 }
+
+/**
+ * @brief Get the pollable file descriptor of an IPC handle.
+ *
+ * Every transport exposes a descriptor that becomes readable when the handle
+ * has something to receive. This lets an application wait on TCP clients and
+ * local shared-memory channels together in one epoll/io_uring loop instead of
+ * dedicating a spinning thread to each shared-memory channel.
+ *
+ * @param handle Pointer to the IPC handle.
+ * @return The file descriptor, or `IPC_FAILURE` if the handle is `NULL` or its
+ * mechanism does not provide one.
+ *
+ * Example usage:
+ * @code
+ * struct epoll_event ev = { .events = EPOLLIN, .data.ptr = handle };
+ * epoll_ctl(epfd, EPOLL_CTL_ADD, ipc_handle_get_fd(handle), &ev);
+ * @endcode
+ */
+int ipc_handle_get_fd(ipc_handle_t *handle) {
+    if (!handle || !handle->get_fd) {
+        return IPC_FAILURE;
+    }
+    return handle->get_fd(handle);
+}
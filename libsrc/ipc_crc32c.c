@@ -0,0 +1,285 @@
+/**
+ * @file ipc_crc32c.c
+ * author Animesh0817 (mailtome.anni@gmail.com)
+ * @brief Implementation of CRC32C with run-time selection of the fastest backend.
+ */
+
+#include "ipc_crc32c.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <nmmintrin.h>
+#define IPC_CRC32C_X86 1
+#elif defined(__aarch64__) && defined(__GNUC__)
+#include <arm_acle.h>
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#define IPC_CRC32C_ARM 1
+#endif
+
+#define IPC_CRC32C_POLY 0x82f63b78u /* Castagnoli, bit-reflected */
+
+static uint32_t ipc_crc32c_table[8][256];
+static uint32_t (*ipc_crc32c_impl)(uint32_t, const unsigned char *, size_t);
+static const char *ipc_crc32c_name;
+static pthread_once_t ipc_crc32c_once = PTHREAD_ONCE_INIT;
+
+/**
+ * @brief Load 8 bytes in little-endian order from a possibly unaligned address.
+ */
+static uint64_t ipc_crc32c_load64(const unsigned char *p) {
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    v = __builtin_bswap64(v);
+#endif
+    return v;
+}
+
+/**
+ * @brief Portable CRC32C processing 8 bytes per step with 8 lookup tables.
+ */
+static uint32_t ipc_crc32c_sw(uint32_t crc, const unsigned char *p, size_t len) {
+    while (len && ((uintptr_t)p & 7)) {
+        crc = ipc_crc32c_table[0][(crc ^ *p++) & 0xff] ^ (crc >> 8);
+        len--;
+    }
+    while (len >= 8) {
+        uint64_t v = ipc_crc32c_load64(p) ^ crc;
+        crc = ipc_crc32c_table[7][v & 0xff] ^
+              ipc_crc32c_table[6][(v >> 8) & 0xff] ^
+              ipc_crc32c_table[5][(v >> 16) & 0xff] ^
+              ipc_crc32c_table[4][(v >> 24) & 0xff] ^
+              ipc_crc32c_table[3][(v >> 32) & 0xff] ^
+              ipc_crc32c_table[2][(v >> 40) & 0xff] ^
+              ipc_crc32c_table[1][(v >> 48) & 0xff] ^
+              ipc_crc32c_table[0][v >> 56];
+        p += 8;
+        len -= 8;
+    }
+    while (len--) {
+        crc = ipc_crc32c_table[0][(crc ^ *p++) & 0xff] ^ (crc >> 8);
+    }
+    return crc;
+}
+
+/*
+ * The CRC instructions have a latency of several cycles but can start one
+ * per cycle, so the hardware path runs three independent streams over
+ * adjacent blocks and merges them by shifting a CRC over the length of a
+ * block (a multiplication in GF(2), done with precomputed tables).
+ */
+#define IPC_CRC32C_LONG 8192
+#define IPC_CRC32C_SHORT 256
+
+static uint32_t ipc_crc32c_long[4][256];
+static uint32_t ipc_crc32c_short[4][256];
+
+/**
+ * @brief Multiply a 32x32 GF(2) matrix by a vector.
+ */
+static uint32_t ipc_crc32c_gf2_times(const uint32_t *mat, uint32_t vec) {
+    uint32_t sum = 0;
+
+    while (vec) {
+        if (vec & 1) {
+            sum ^= *mat;
+        }
+        vec >>= 1;
+        mat++;
+    }
+    return sum;
+}
+
+/**
+ * @brief Square a 32x32 GF(2) matrix.
+ */
+static void ipc_crc32c_gf2_square(uint32_t *square, const uint32_t *mat) {
+    for (int n = 0; n < 32; n++) {
+        square[n] = ipc_crc32c_gf2_times(mat, mat[n]);
+    }
+}
+
+/**
+ * @brief Build the tables that advance a CRC over len zero bytes (len a power of two).
+ */
+static void ipc_crc32c_zeros(uint32_t zeros[4][256], size_t len) {
+    uint32_t even[32], odd[32];
+    uint32_t row = 1;
+
+    // Operator for one zero bit, then square up to one zero byte and beyond
+    odd[0] = IPC_CRC32C_POLY;
+    for (int n = 1; n < 32; n++) {
+        odd[n] = row;
+        row <<= 1;
+    }
+    ipc_crc32c_gf2_square(even, odd);
+    ipc_crc32c_gf2_square(odd, even);
+    for (;;) {
+        ipc_crc32c_gf2_square(even, odd);
+        len >>= 1;
+        if (len == 0) {
+            break;
+        }
+        ipc_crc32c_gf2_square(odd, even);
+        len >>= 1;
+        if (len == 0) {
+            memcpy(even, odd, sizeof(even));
+            break;
+        }
+    }
+    for (uint32_t n = 0; n < 256; n++) {
+        zeros[0][n] = ipc_crc32c_gf2_times(even, n);
+        zeros[1][n] = ipc_crc32c_gf2_times(even, n << 8);
+        zeros[2][n] = ipc_crc32c_gf2_times(even, n << 16);
+        zeros[3][n] = ipc_crc32c_gf2_times(even, n << 24);
+    }
+}
+
+/**
+ * @brief Advance a CRC over the zero bytes described by a table set.
+ */
+static uint32_t ipc_crc32c_shift(uint32_t zeros[4][256], uint32_t crc) {
+    return zeros[0][crc & 0xff] ^ zeros[1][(crc >> 8) & 0xff] ^
+           zeros[2][(crc >> 16) & 0xff] ^ zeros[3][crc >> 24];
+}
+
+#if defined(IPC_CRC32C_X86)
+#define IPC_CRC32C_HW_TARGET __attribute__((target("sse4.2")))
+#define IPC_CRC32C_HW_U8(crc, v) _mm_crc32_u8((crc), (v))
+#define IPC_CRC32C_HW_U64(crc, v) ((uint32_t)_mm_crc32_u64((crc), (v)))
+#elif defined(IPC_CRC32C_ARM) && defined(__clang__)
+#define IPC_CRC32C_HW_TARGET __attribute__((target("crc")))
+#define IPC_CRC32C_HW_U8(crc, v) __crc32cb((crc), (v))
+#define IPC_CRC32C_HW_U64(crc, v) __crc32cd((crc), (v))
+#elif defined(IPC_CRC32C_ARM)
+#define IPC_CRC32C_HW_TARGET __attribute__((target("+crc")))
+#define IPC_CRC32C_HW_U8(crc, v) __crc32cb((crc), (v))
+#define IPC_CRC32C_HW_U64(crc, v) __crc32cd((crc), (v))
+#endif
+
+#ifdef IPC_CRC32C_HW_TARGET
+/**
+ * @brief CRC32C of three adjacent blocks of size bytes each, merged into crc.
+ */
+IPC_CRC32C_HW_TARGET
+static uint32_t ipc_crc32c_hw_blocks(uint32_t crc, const unsigned char *p, size_t size, uint32_t zeros[4][256]) {
+    uint32_t crc0 = crc, crc1 = 0, crc2 = 0;
+
+    for (size_t i = 0; i < size; i += 8) {
+        uint64_t v0, v1, v2;
+        memcpy(&v0, p + i, 8);
+        memcpy(&v1, p + size + i, 8);
+        memcpy(&v2, p + 2 * size + i, 8);
+        crc0 = IPC_CRC32C_HW_U64(crc0, v0);
+        crc1 = IPC_CRC32C_HW_U64(crc1, v1);
+        crc2 = IPC_CRC32C_HW_U64(crc2, v2);
+    }
+    crc0 = ipc_crc32c_shift(zeros, crc0) ^ crc1;
+    return ipc_crc32c_shift(zeros, crc0) ^ crc2;
+}
+
+/**
+ * @brief CRC32C with the CPU's crc32c instructions (SSE4.2 or ARMv8 CRC).
+ */
+IPC_CRC32C_HW_TARGET
+static uint32_t ipc_crc32c_hw(uint32_t crc, const unsigned char *p, size_t len) {
+    while (len && ((uintptr_t)p & 7)) {
+        crc = IPC_CRC32C_HW_U8(crc, *p++);
+        len--;
+    }
+    while (len >= 3 * IPC_CRC32C_LONG) {
+        crc = ipc_crc32c_hw_blocks(crc, p, IPC_CRC32C_LONG, ipc_crc32c_long);
+        p += 3 * IPC_CRC32C_LONG;
+        len -= 3 * IPC_CRC32C_LONG;
+    }
+    while (len >= 3 * IPC_CRC32C_SHORT) {
+        crc = ipc_crc32c_hw_blocks(crc, p, IPC_CRC32C_SHORT, ipc_crc32c_short);
+        p += 3 * IPC_CRC32C_SHORT;
+        len -= 3 * IPC_CRC32C_SHORT;
+    }
+    while (len >= 8) {
+        uint64_t v;
+        memcpy(&v, p, sizeof(v));
+        crc = IPC_CRC32C_HW_U64(crc, v);
+        p += 8;
+        len -= 8;
+    }
+    while (len--) {
+        crc = IPC_CRC32C_HW_U8(crc, *p++);
+    }
+    return crc;
+}
+#endif
+
+/**
+ * @brief Build the slice-by-8 tables and pick the backend for this CPU.
+ *
+ * Setting IPC_CRC32C_BACKEND=slice-by-8 in the environment forces the
+ * portable backend, so it can be tested on CPUs with CRC instructions.
+ */
+static void ipc_crc32c_setup(void) {
+    const char *force = getenv("IPC_CRC32C_BACKEND");
+
+    for (uint32_t n = 0; n < 256; n++) {
+        uint32_t crc = n;
+        for (int k = 0; k < 8; k++) {
+            crc = (crc >> 1) ^ (IPC_CRC32C_POLY & (0u - (crc & 1)));
+        }
+        ipc_crc32c_table[0][n] = crc;
+    }
+    for (uint32_t n = 0; n < 256; n++) {
+        for (int t = 1; t < 8; t++) {
+            uint32_t prev = ipc_crc32c_table[t - 1][n];
+            ipc_crc32c_table[t][n] = ipc_crc32c_table[0][prev & 0xff] ^ (prev >> 8);
+        }
+    }
+
+    ipc_crc32c_impl = ipc_crc32c_sw;
+    ipc_crc32c_name = "slice-by-8";
+    if (force && strcmp(force, "slice-by-8") == 0) {
+        return;
+    }
+#if defined(IPC_CRC32C_X86)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse4.2")) {
+        ipc_crc32c_impl = ipc_crc32c_hw;
+        ipc_crc32c_name = "sse4.2";
+    }
+#elif defined(IPC_CRC32C_ARM)
+    if (getauxval(AT_HWCAP) & HWCAP_CRC32) {
+        ipc_crc32c_impl = ipc_crc32c_hw;
+        ipc_crc32c_name = "armv8-crc";
+    }
+#endif
+    if (ipc_crc32c_impl != ipc_crc32c_sw) {
+        ipc_crc32c_zeros(ipc_crc32c_long, IPC_CRC32C_LONG);
+        ipc_crc32c_zeros(ipc_crc32c_short, IPC_CRC32C_SHORT);
+    }
+}
+
+/**
+ * @brief Compute or extend a CRC32C checksum.
+ *
+ * @param crc 0 to start a new checksum, or the result of a previous call to
+ *        continue it over more data.
+ * @param data Pointer to the data.
+ * @param len Length of the data.
+ * @return The checksum of everything processed so far.
+ */
+uint32_t ipc_crc32c(uint32_t crc, const void *data, size_t len) {
+    pthread_once(&ipc_crc32c_once, ipc_crc32c_setup);
+    return ~ipc_crc32c_impl(~crc, (const unsigned char *)data, len);
+}
+
+/**
+ * @brief Get the name of the backend ipc_crc32c() uses on this CPU.
+ *
+ * @return "sse4.2", "armv8-crc" or "slice-by-8".
+ */
+const char *ipc_crc32c_backend(void) {
+    pthread_once(&ipc_crc32c_once, ipc_crc32c_setup);
+    return ipc_crc32c_name;
+}
@@ -0,0 +1,499 @@
+/**
+ * @file ipc_directory.c
+ * author Animesh0817 (mailtome.anni@gmail.com)
+ * @brief Implementation of the shared-memory channel directory.
+ */
+
+#include "ipc_directory.h"
+#include "ipc_socket.h"
+#include "ipc_udp.h"
+#include "ipc_slab.h"
+#include "ipc_seqlock.h"
+#include "ipc_journal.h"
+#include "ipc_doorbell.h"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <stdatomic.h>
+#include <stdalign.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <sched.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include <errno.h>
+
+#define IPC_DIRECTORY_MAGIC 0x49504444u /* "IPDD" */
+#define IPC_DIRECTORY_VERSION 1u
+
+#define IPC_DIRECTORY_FREE 0u /**< Slot never used. */
+#define IPC_DIRECTORY_CLAIMED 1u /**< Slot taken, name being written. */
+#define IPC_DIRECTORY_BOUND 2u /**< Slot bound to its name for good. */
+
+#define IPC_DIRECTORY_OPEN_WAIT_MS 1000 /**< How long to wait for another process to initialize the segment. */
+
+/**
+ * A Structure that will hold one channel:
+ * Binding of the slot to a name
+ * Sequence counter, odd while the entry is being updated
+ * Whether the channel is registered, and its entry
+ */
+struct ipc_directory_slot {
+    alignas(64) atomic_uint key; /**< IPC_DIRECTORY_FREE, _CLAIMED or _BOUND. */
+    uint32_t hash; /**< Hash of name, set before key is BOUND. */
+    char name[IPC_DIRECTORY_NAME_MAX]; /**< Channel name, set before key is BOUND. */
+    atomic_uint_fast64_t seq; /**< Twice the number of updates, plus one during an update. */
+    uint32_t live; /**< Non-zero while the channel is registered, guarded by seq. */
+    ipc_directory_entry_t entry; /**< Transport parameters, guarded by seq. */
+};
+
+/**
+ * A Structure that will hold the layout of the segment:
+ * Header identifying the segment and the table size
+ * Words used to wake processes waiting for a name
+ * Open-addressing table of channels
+ */
+struct ipc_directory_shm {
+    uint32_t magic; /**< IPC_DIRECTORY_MAGIC once the segment is initialized. */
+    uint32_t version; /**< Layout version. */
+    uint64_t slots; /**< Number of slots, a power of two. */
+    alignas(64) atomic_uint generation; /**< Futex word bumped on every change. */
+    atomic_uint waiters; /**< Processes blocked on generation. */
+    struct ipc_directory_slot slot[]; /**< Hash table, probed linearly. */
+};
+
+struct ipc_directory {
+    struct ipc_directory_shm *shm; /**< Mapped segment. */
+    size_t map_size; /**< Size of the mapping. */
+};
+
+/**
+ * @brief FNV-1a hash of a channel name.
+ */
+static uint32_t ipc_directory_hash(const char *name) {
+    uint32_t hash = 2166136261u;
+
+    while (*name) {
+        hash = (hash ^ (unsigned char)*name++) * 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * @brief Check that a channel name is non-empty and fits a slot.
+ */
+static int ipc_directory_valid_name(const char *channel) {
+    return channel && channel[0] && memchr(channel, '\0', IPC_DIRECTORY_NAME_MAX) != NULL;
+}
+
+/**
+ * @brief Find the slot bound to a name, optionally binding a free one.
+ *
+ * Slots are never unbound, so every process probing for a name walks the
+ * same sequence and the first to claim a free slot for it wins; the others
+ * wait for the name to be written and then find it there.
+ *
+ * @param dir Pointer to the directory.
+ * @param channel Channel name.
+ * @param claim Non-zero to bind a free slot if the name has none.
+ * @return The slot, or NULL (errno ENOENT, or ENOSPC if the table is full).
+ */
+static struct ipc_directory_slot *ipc_directory_find(ipc_directory_t *dir, const char *channel, int claim) {
+    struct ipc_directory_shm *shm = dir->shm;
+    uint32_t hash = ipc_directory_hash(channel);
+    uint64_t mask = shm->slots - 1;
+
+    for (uint64_t i = 0; i < shm->slots; i++) {
+        struct ipc_directory_slot *slot = &shm->slot[(hash + i) & mask];
+        unsigned int key = atomic_load_explicit(&slot->key, memory_order_acquire);
+
+        if (key == IPC_DIRECTORY_FREE) {
+            if (!claim) {
+                break; // Probe chains have no holes
+            }
+            if (atomic_compare_exchange_strong(&slot->key, &key, IPC_DIRECTORY_CLAIMED)) {
+                slot->hash = hash;
+                strncpy(slot->name, channel, sizeof(slot->name));
+                atomic_store_explicit(&slot->key, IPC_DIRECTORY_BOUND, memory_order_release);
+                return slot;
+            }
+        }
+        // A lookup skips a slot being bound: its name is not registered yet
+        while (claim && key == IPC_DIRECTORY_CLAIMED) {
+            sched_yield();
+            key = atomic_load_explicit(&slot->key, memory_order_acquire);
+        }
+        if (key == IPC_DIRECTORY_BOUND && slot->hash == hash &&
+            strncmp(slot->name, channel, sizeof(slot->name)) == 0) {
+            return slot;
+        }
+    }
+    errno = claim ? ENOSPC : ENOENT;
+    return NULL;
+}
+
+/**
+ * @brief Update the entry of a slot and wake waiting processes.
+ *
+ * @param dir Pointer to the directory.
+ * @param slot Slot to update.
+ * @param entry New entry, or NULL to mark the channel unregistered.
+ * @return IPC_SUCCESS on success, IPC_FAILURE (errno ENOENT) when
+ *         unregistering a channel that is not registered.
+ */
+static int ipc_directory_update(ipc_directory_t *dir, struct ipc_directory_slot *slot,
+                                const ipc_directory_entry_t *entry) {
+    struct ipc_directory_shm *shm = dir->shm;
+    int ret = IPC_SUCCESS;
+
+    uint64_t seq = ipc_seqcount_write_begin(&slot->seq);
+    if (entry) {
+        slot->entry = *entry;
+        slot->live = 1;
+    } else if (slot->live) {
+        slot->live = 0;
+    } else {
+        ret = IPC_FAILURE;
+    }
+    ipc_seqcount_write_end(&slot->seq, seq);
+
+    if (ret == IPC_SUCCESS) {
+        atomic_fetch_add(&shm->generation, 1);
+        if (atomic_load(&shm->waiters)) {
+            ipc_futex_wake(&shm->generation, INT_MAX);
+        }
+    } else {
+        errno = ENOENT;
+    }
+    return ret;
+}
+
+/**
+ * @brief Open the directory, creating it if it does not exist.
+ *
+ * Any process may be the first to open it; the others wait briefly for that
+ * process to initialize the segment.
+ *
+ * @param name POSIX shared-memory name, or NULL for IPC_DIRECTORY_DEFAULT.
+ * @param slots Channels the table holds if it is created here, rounded up to
+ *        a power of two; 0 for IPC_DIRECTORY_SLOTS.
+ * @return Pointer to the directory, or NULL on failure (errno EPROTO if the
+ *         segment is not a directory).
+ */
+ipc_directory_t *ipc_directory_open(const char *name, size_t slots) {
+    size_t count = 1;
+    struct stat st;
+    int created = 1;
+
+    if (!name) {
+        name = IPC_DIRECTORY_DEFAULT;
+    }
+    if (slots == 0) {
+        slots = IPC_DIRECTORY_SLOTS;
+    }
+    while (count < slots) {
+        count <<= 1;
+    }
+
+    ipc_directory_t *dir = (ipc_directory_t *)calloc(1, sizeof(ipc_directory_t));
+    if (!dir) {
+        return NULL;
+    }
+    // Every process registers and waits, so the segment is writable by all
+    int fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR | O_CLOEXEC, 0666);
+    if (fd == -1 && errno == EEXIST) {
+        created = 0;
+        fd = shm_open(name, O_RDWR | O_CLOEXEC, 0);
+    }
+    if (fd == -1) {
+        free(dir);
+        return NULL;
+    }
+
+    if (created) {
+        dir->map_size = sizeof(struct ipc_directory_shm) + count * sizeof(struct ipc_directory_slot);
+        if (ftruncate(fd, (off_t)dir->map_size) == -1) {
+            int err = errno;
+            close(fd);
+            shm_unlink(name);
+            free(dir);
+            errno = err;
+            return NULL;
+        }
+    } else {
+        // The creator sizes the segment before it initializes it
+        for (int ms = 0; fstat(fd, &st) == 0 && st.st_size == 0 && ms < IPC_DIRECTORY_OPEN_WAIT_MS; ms++) {
+            usleep(1000);
+        }
+        if (fstat(fd, &st) == -1 || (size_t)st.st_size < sizeof(struct ipc_directory_shm)) {
+            close(fd);
+            free(dir);
+            errno = EPROTO;
+            return NULL;
+        }
+        dir->map_size = (size_t)st.st_size;
+    }
+    void *map = mmap(NULL, dir->map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        int err = errno;
+        if (created) {
+            shm_unlink(name);
+        }
+        free(dir);
+        errno = err;
+        return NULL;
+    }
+    dir->shm = (struct ipc_directory_shm *)map;
+
+    if (created) {
+        dir->shm->version = IPC_DIRECTORY_VERSION;
+        dir->shm->slots = count;
+        atomic_thread_fence(memory_order_release);
+        dir->shm->magic = IPC_DIRECTORY_MAGIC;
+        return dir;
+    }
+
+    volatile uint32_t *magic = &dir->shm->magic;
+    for (int ms = 0; *magic != IPC_DIRECTORY_MAGIC && ms < IPC_DIRECTORY_OPEN_WAIT_MS; ms++) {
+        usleep(1000);
+    }
+    atomic_thread_fence(memory_order_acquire);
+    struct ipc_directory_shm *shm = dir->shm;
+    if (*magic != IPC_DIRECTORY_MAGIC || shm->version != IPC_DIRECTORY_VERSION || shm->slots == 0 ||
+        (shm->slots & (shm->slots - 1)) != 0 ||
+        sizeof(struct ipc_directory_shm) + shm->slots * sizeof(struct ipc_directory_slot) > dir->map_size) {
+        ipc_directory_close(dir);
+        errno = EPROTO;
+        return NULL;
+    }
+    return dir;
+}
+
+/**
+ * @brief Unmap a directory. The segment itself stays until ipc_directory_unlink().
+ *
+ * @param dir Directory to close.
+ */
+void ipc_directory_close(ipc_directory_t *dir) {
+    if (dir) {
+        munmap(dir->shm, dir->map_size);
+        free(dir);
+    }
+}
+
+/**
+ * @brief Remove a directory segment.
+ *
+ * @param name POSIX shared-memory name, or NULL for IPC_DIRECTORY_DEFAULT.
+ * @return IPC_SUCCESS on success, IPC_FAILURE on failure.
+ */
+int ipc_directory_unlink(const char *name) {
+    return shm_unlink(name ? name : IPC_DIRECTORY_DEFAULT) == 0 ? IPC_SUCCESS : IPC_FAILURE;
+}
+
+/**
+ * @brief Register a channel, or update its entry if the name is registered.
+ *
+ * Register a channel once it accepts clients, since clients attach as soon
+ * as they see the entry.
+ *
+ * @param dir Pointer to the directory.
+ * @param channel Channel name, shorter than IPC_DIRECTORY_NAME_MAX.
+ * @param entry Transport parameters; pid is filled in with the caller's.
+ * @return IPC_SUCCESS on success, IPC_FAILURE on failure (errno ENOSPC if
+ *         the table is full).
+ */
+int ipc_directory_register(ipc_directory_t *dir, const char *channel, const ipc_directory_entry_t *entry) {
+    if (!dir || !ipc_directory_valid_name(channel) || !entry ||
+        entry->transport < IPC_DIRECTORY_SOCKET || entry->transport > IPC_DIRECTORY_JOURNAL ||
+        !memchr(entry->address, '\0', sizeof(entry->address))) {
+        errno = EINVAL;
+        return IPC_FAILURE;
+    }
+    struct ipc_directory_slot *slot = ipc_directory_find(dir, channel, 1);
+    if (!slot) {
+        return IPC_FAILURE;
+    }
+    ipc_directory_entry_t copy = *entry;
+    copy.pid = (int32_t)getpid();
+    return ipc_directory_update(dir, slot, &copy);
+}
+
+/**
+ * @brief Remove a channel from the directory.
+ *
+ * Clients that already attached are not affected.
+ *
+ * @param dir Pointer to the directory.
+ * @param channel Channel name.
+ * @return IPC_SUCCESS on success, IPC_FAILURE on failure (errno ENOENT if
+ *         the channel is not registered).
+ */
+int ipc_directory_unregister(ipc_directory_t *dir, const char *channel) {
+    if (!dir || !ipc_directory_valid_name(channel)) {
+        errno = EINVAL;
+        return IPC_FAILURE;
+    }
+    struct ipc_directory_slot *slot = ipc_directory_find(dir, channel, 0);
+    if (!slot) {
+        return IPC_FAILURE;
+    }
+    return ipc_directory_update(dir, slot, NULL);
+}
+
+/**
+ * @brief Resolve a channel without blocking or taking a lock.
+ *
+ * @param dir Pointer to the directory.
+ * @param channel Channel name.
+ * @param entry Receives a consistent copy of the channel's entry.
+ * @return IPC_SUCCESS on success, IPC_FAILURE on failure (errno ENOENT if
+ *         the channel is not registered, EBUSY if its entry stayed mid-update,
+ *         e.g. because the registering process died while writing it).
+ */
+int ipc_directory_lookup(ipc_directory_t *dir, const char *channel, ipc_directory_entry_t *entry) {
+    if (!dir || !ipc_directory_valid_name(channel) || !entry) {
+        errno = EINVAL;
+        return IPC_FAILURE;
+    }
+    struct ipc_directory_slot *slot = ipc_directory_find(dir, channel, 0);
+    if (!slot) {
+        return IPC_FAILURE;
+    }
+
+    for (int tries = 0; tries < IPC_SEQCOUNT_READ_RETRIES; tries++) {
+        uint64_t before;
+        if (ipc_seqcount_read_begin(&slot->seq, &before) != IPC_SUCCESS) {
+            continue; // Update in progress
+        }
+        uint32_t live = slot->live;
+        ipc_directory_entry_t copy = slot->entry;
+        if (ipc_seqcount_read_end(&slot->seq, before) != IPC_SUCCESS) {
+            continue; // Updated while copying
+        }
+        if (!live) {
+            errno = ENOENT;
+            return IPC_FAILURE;
+        }
+        copy.address[sizeof(copy.address) - 1] = '\0';
+        *entry = copy;
+        return IPC_SUCCESS;
+    }
+    errno = EBUSY;
+    return IPC_FAILURE;
+}
+
+/**
+ * @brief Resolve a channel, waiting for it to be registered.
+ *
+ * @param dir Pointer to the directory.
+ * @param channel Channel name.
+ * @param entry Receives the channel's entry.
+ * @param timeout_ms Timeout in milliseconds, 0 to not wait, or -1 to wait forever.
+ * @return IPC_SUCCESS on success, IPC_FAILURE on timeout (errno ETIMEDOUT) or error.
+ */
+int ipc_directory_wait(ipc_directory_t *dir, const char *channel, ipc_directory_entry_t *entry, int timeout_ms) {
+    struct timespec ts;
+
+    if (!dir || !ipc_directory_valid_name(channel) || !entry) {
+        errno = EINVAL;
+        return IPC_FAILURE;
+    }
+    struct ipc_directory_shm *shm = dir->shm;
+    const struct timespec *deadline = ipc_futex_deadline(&ts, timeout_ms);
+
+    for (;;) {
+        if (ipc_directory_lookup(dir, channel, entry) == IPC_SUCCESS) {
+            return IPC_SUCCESS;
+        }
+        if (errno != ENOENT) {
+            return IPC_FAILURE;
+        }
+        if (timeout_ms == 0) {
+            errno = ETIMEDOUT;
+            return IPC_FAILURE;
+        }
+        // Announce the wait, then check again so no registration is missed
+        atomic_fetch_add(&shm->waiters, 1);
+        unsigned int seen = atomic_load(&shm->generation);
+        if (ipc_directory_lookup(dir, channel, entry) == IPC_SUCCESS) {
+            atomic_fetch_sub(&shm->waiters, 1);
+            return IPC_SUCCESS;
+        }
+        int ret = ipc_futex_wait(&shm->generation, seen, deadline);
+        atomic_fetch_sub(&shm->waiters, 1);
+        if (ret != IPC_SUCCESS && errno == ETIMEDOUT) {
+            return IPC_FAILURE;
+        }
+    }
+}
+
+/**
+ * @brief Resolve a channel and open a client handle to it.
+ *
+ * Waits for the channel to be registered, then creates and initializes the
+ * handle of its transport: a connected socket (framed if the server asked
+ * for it), a UDP client, or an attached slab, seqlock or journal. Checksums
+ * are enabled if the entry has IPC_DIRECTORY_CHECKSUM and the transport
+ * supports them (all but UDP).
+ *
+ * @param dir Pointer to the directory.
+ * @param channel Channel name.
+ * @param timeout_ms Timeout for the registration in milliseconds, or -1 to wait forever.
+ * @return Pointer to the initialized handle, or NULL on failure (errno
+ *         ETIMEDOUT if the channel did not appear, EPROTO for an unknown
+ *         transport, or that of the failed init()).
+ */
+ipc_handle_t *ipc_directory_attach(ipc_directory_t *dir, const char *channel, int timeout_ms) {
+    ipc_directory_entry_t entry;
+    ipc_handle_t *handle = NULL;
+
+    if (ipc_directory_wait(dir, channel, &entry, timeout_ms) != IPC_SUCCESS) {
+        return NULL;
+    }
+    switch (entry.transport) {
+    case IPC_DIRECTORY_SOCKET:
+        handle = ipc_socket_create(entry.address, entry.port, 0);
+        if (handle && (entry.flags & IPC_DIRECTORY_FRAMED)) {
+            ipc_socket_set_framing(handle, 1);
+        }
+        break;
+    case IPC_DIRECTORY_UDP:
+        handle = ipc_udp_create(entry.address, entry.port, 0);
+        break;
+    case IPC_DIRECTORY_SLAB:
+        handle = ipc_slab_create(entry.address, 0, 0, 0);
+        break;
+    case IPC_DIRECTORY_SEQLOCK:
+        handle = ipc_seqlock_create(entry.address, 0, 0);
+        break;
+    case IPC_DIRECTORY_JOURNAL:
+        handle = ipc_journal_create(entry.address, (size_t)entry.capacity);
+        break;
+    default:
+        errno = EPROTO;
+        return NULL;
+    }
+    if (!handle) {
+        return NULL;
+    }
+    if (handle->init(handle) != IPC_SUCCESS) {
+        int err = errno;
+        handle->destroy(handle);
+        errno = err;
+        return NULL;
+    }
+
+    if (entry.flags & IPC_DIRECTORY_CHECKSUM) {
+        switch (entry.transport) {
+        case IPC_DIRECTORY_SOCKET: ipc_socket_set_checksum(handle, 1); break;
+        case IPC_DIRECTORY_SLAB: ipc_slab_set_checksum(handle, 1); break;
+        case IPC_DIRECTORY_SEQLOCK: ipc_seqlock_set_checksum(handle, 1); break;
+        case IPC_DIRECTORY_JOURNAL: ipc_journal_set_checksum(handle, 1); break;
+        default: break;
+        }
+    }
+    return handle;
+}
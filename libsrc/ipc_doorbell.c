@@ -0,0 +1,268 @@
+/**
+ * @file ipc_doorbell.c
+ * author Animesh0817 (mailtome.anni@gmail.com)
+ * @brief Implementation of the eventfd doorbell used by shared-memory backends,
+ *        and of the futex and seqcount primitives they share.
+ */
+
+#include "ipc_doorbell.h"
+#include <sys/eventfd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#include <sched.h>
+#include <poll.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <errno.h>
+
+/**
+ * @brief Create a doorbell backed by a new eventfd.
+ *
+ * @param db Doorbell to initialize.
+ * @param parked Parked word shared with the producers (e.g. inside a shared
+ *        memory segment), or NULL to use a word local to the doorbell.
+ * @return IPC_SUCCESS on success, IPC_FAILURE on failure.
+ */
+int ipc_doorbell_open(ipc_doorbell_t *db, atomic_uint *parked) {
+    int efd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (efd == -1) {
+        return IPC_FAILURE;
+    }
+    if (ipc_doorbell_attach(db, efd, parked) != IPC_SUCCESS) {
+        close(efd);
+        return IPC_FAILURE;
+    }
+    db->owns_fd = 1;
+    return IPC_SUCCESS;
+}
+
+/**
+ * @brief Initialize a doorbell around an existing eventfd.
+ *
+ * Used by processes that received the eventfd from the segment owner, either
+ * through fork() or SCM_RIGHTS. The descriptor is not closed by the doorbell.
+ *
+ * @param db Doorbell to initialize.
+ * @param efd eventfd descriptor.
+ * @param parked Parked word shared with the peer, or NULL for a local one.
+ * @return IPC_SUCCESS on success, IPC_FAILURE on failure.
+ */
+int ipc_doorbell_attach(ipc_doorbell_t *db, int efd, atomic_uint *parked) {
+    if (!db || efd < 0) {
+        errno = EINVAL;
+        return IPC_FAILURE;
+    }
+    db->efd = efd;
+    atomic_init(&db->local_parked, 0);
+    db->parked = parked ? parked : &db->local_parked;
+    db->owns_fd = 0;
+    return IPC_SUCCESS;
+}
+
+/**
+ * @brief Get the pollable descriptor of the doorbell.
+ *
+ * @param db Doorbell.
+ * @return The eventfd, readable once the doorbell has been rung.
+ */
+int ipc_doorbell_fd(const ipc_doorbell_t *db) {
+    return db->efd;
+}
+
+/**
+ * @brief Announce that the consumer is about to block.
+ *
+ * The caller must re-check its queue after parking and before waiting,
+ * otherwise a message published just before the park would be missed.
+ *
+ * @param db Doorbell.
+ */
+void ipc_doorbell_park(ipc_doorbell_t *db) {
+    atomic_store_explicit(db->parked, 1, memory_order_seq_cst);
+}
+
+/**
+ * @brief Clear the parked flag and consume any pending wake-up.
+ *
+ * @param db Doorbell.
+ */
+void ipc_doorbell_unpark(ipc_doorbell_t *db) {
+    uint64_t value;
+
+    atomic_store_explicit(db->parked, 0, memory_order_relaxed);
+    while (read(db->efd, &value, sizeof(value)) == sizeof(value)) {
+    }
+}
+
+/**
+ * @brief Wake the consumer if it is parked.
+ *
+ * Costs a single atomic load when the consumer is busy; the eventfd write is
+ * only issued while the consumer has announced that it is blocking.
+ *
+ * @param db Doorbell.
+ * @return IPC_SUCCESS on success, IPC_FAILURE on failure.
+ */
+int ipc_doorbell_ring(ipc_doorbell_t *db) {
+    const uint64_t one = 1;
+
+    atomic_thread_fence(memory_order_seq_cst);
+    if (!atomic_load_explicit(db->parked, memory_order_relaxed)) {
+        return IPC_SUCCESS;
+    }
+    if (write(db->efd, &one, sizeof(one)) == -1 && errno != EAGAIN) {
+        return IPC_FAILURE;
+    }
+    return IPC_SUCCESS;
+}
+
+/**
+ * @brief Block until the doorbell is rung.
+ *
+ * @param db Doorbell.
+ * @param timeout_ms Timeout in milliseconds, or -1 to wait forever.
+ * @return IPC_SUCCESS when rung, IPC_FAILURE on timeout (errno ETIMEDOUT) or error.
+ */
+int ipc_doorbell_wait(ipc_doorbell_t *db, int timeout_ms) {
+    struct pollfd pfd = { .fd = db->efd, .events = POLLIN };
+    int ret;
+
+    do {
+        ret = poll(&pfd, 1, timeout_ms);
+    } while (ret == -1 && errno == EINTR);
+
+    if (ret == 0) {
+        errno = ETIMEDOUT;
+        return IPC_FAILURE;
+    }
+    return ret > 0 ? IPC_SUCCESS : IPC_FAILURE;
+}
+
+/**
+ * @brief Release the doorbell.
+ *
+ * @param db Doorbell.
+ */
+void ipc_doorbell_close(ipc_doorbell_t *db) {
+    if (db->owns_fd && db->efd >= 0) {
+        close(db->efd);
+    }
+    db->efd = -1;
+}
+
+/**
+ * @brief Turn a relative timeout into an absolute CLOCK_MONOTONIC deadline.
+ *
+ * @param deadline Receives the deadline.
+ * @param timeout_ms Timeout in milliseconds, or -1 to wait forever.
+ * @return deadline, or NULL when timeout_ms is negative, ready to be passed
+ *         to ipc_futex_wait().
+ */
+const struct timespec *ipc_futex_deadline(struct timespec *deadline, int timeout_ms) {
+    if (timeout_ms < 0) {
+        return NULL;
+    }
+    clock_gettime(CLOCK_MONOTONIC, deadline);
+    deadline->tv_sec += timeout_ms / 1000;
+    deadline->tv_nsec += (long)(timeout_ms % 1000) * 1000000L;
+    if (deadline->tv_nsec >= 1000000000L) {
+        deadline->tv_sec++;
+        deadline->tv_nsec -= 1000000000L;
+    }
+    return deadline;
+}
+
+/**
+ * @brief Sleep on a futex word in a shared mapping while it still holds a value.
+ *
+ * Returns early (successfully) if the word already changed or a signal
+ * arrives, so callers re-check their condition in a loop.
+ *
+ * @param word Futex word.
+ * @param seen Value the caller observed before deciding to sleep.
+ * @param deadline Absolute CLOCK_MONOTONIC deadline, or NULL to wait forever.
+ * @return IPC_SUCCESS when woken, IPC_FAILURE on timeout (errno ETIMEDOUT) or error.
+ */
+int ipc_futex_wait(atomic_uint *word, unsigned int seen, const struct timespec *deadline) {
+    if (syscall(SYS_futex, word, FUTEX_WAIT_BITSET, seen, deadline, NULL, FUTEX_BITSET_MATCH_ANY) == -1 &&
+        errno != EAGAIN && errno != EINTR) {
+        return IPC_FAILURE;
+    }
+    return IPC_SUCCESS;
+}
+
+/**
+ * @brief Wake processes sleeping on a futex word in a shared mapping.
+ *
+ * @param word Futex word.
+ * @param count Number of sleepers to wake, INT_MAX for all of them.
+ */
+void ipc_futex_wake(atomic_uint *word, int count) {
+    syscall(SYS_futex, word, FUTEX_WAKE, count, NULL, NULL, 0);
+}
+
+/**
+ * @brief Start a seqcount write section.
+ *
+ * Makes the counter odd, which also excludes other writers until
+ * ipc_seqcount_write_end() is called.
+ *
+ * @param seq Sequence counter.
+ * @return The even counter value the section started from.
+ */
+uint64_t ipc_seqcount_write_begin(atomic_uint_fast64_t *seq) {
+    uint64_t begun = atomic_load_explicit(seq, memory_order_relaxed);
+
+    for (;;) {
+        if (begun & 1) {
+            begun = atomic_load_explicit(seq, memory_order_relaxed);
+            continue;
+        }
+        if (atomic_compare_exchange_weak_explicit(seq, &begun, begun + 1, memory_order_relaxed,
+                                                  memory_order_relaxed)) {
+            break;
+        }
+    }
+    atomic_thread_fence(memory_order_release);
+    return begun;
+}
+
+/**
+ * @brief Publish the fields written since ipc_seqcount_write_begin().
+ *
+ * @param seq Sequence counter.
+ * @param begun Value returned by ipc_seqcount_write_begin().
+ */
+void ipc_seqcount_write_end(atomic_uint_fast64_t *seq, uint64_t begun) {
+    atomic_store_explicit(seq, begun + 2, memory_order_release);
+}
+
+/**
+ * @brief Start a seqcount read.
+ *
+ * @param seq Sequence counter.
+ * @param begun Receives the counter value to pass to ipc_seqcount_read_end().
+ * @return IPC_SUCCESS if the guarded fields may be copied, IPC_FAILURE if a
+ *         write is in progress (the caller has yielded and should retry).
+ */
+int ipc_seqcount_read_begin(atomic_uint_fast64_t *seq, uint64_t *begun) {
+    *begun = atomic_load_explicit(seq, memory_order_acquire);
+    if (*begun & 1) {
+        sched_yield(); // Let the writer finish
+        return IPC_FAILURE;
+    }
+    return IPC_SUCCESS;
+}
+
+/**
+ * @brief Check that the fields copied since ipc_seqcount_read_begin() are consistent.
+ *
+ * @param seq Sequence counter.
+ * @param begun Value returned through ipc_seqcount_read_begin().
+ * @return IPC_SUCCESS if no write happened meanwhile, IPC_FAILURE if the
+ *         copy must be retried.
+ */
+int ipc_seqcount_read_end(atomic_uint_fast64_t *seq, uint64_t begun) {
+    atomic_thread_fence(memory_order_acquire);
+    return atomic_load_explicit(seq, memory_order_relaxed) == begun ? IPC_SUCCESS : IPC_FAILURE;
+}
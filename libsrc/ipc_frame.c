@@ -0,0 +1,68 @@
+/**
+ * @file ipc_frame.c
+ * author Animesh0817 (mailtome.anni@gmail.com)
+ * @brief Encoding and decoding of frame headers.
+ */
+
+#include "ipc_frame.h"
+#include "ipc.h"
+#include <arpa/inet.h>
+#include <string.h>
+#include <errno.h>
+
+/**
+ * @brief Encode a frame header into its wire representation.
+ *
+ * @param buf Destination buffer of at least IPC_FRAME_HDR_SIZE bytes.
+ * @param hdr Header to encode.
+ */
+void ipc_frame_hdr_encode(void *buf, const ipc_frame_hdr_t *hdr) {
+    uint32_t words[2];
+
+    words[0] = htonl(hdr->length);
+    words[1] = htonl(hdr->flags);
+    memcpy(buf, words, IPC_FRAME_HDR_SIZE);
+}
+
+/**
+ * @brief Decode and validate a frame header.
+ *
+ * @param buf Buffer holding IPC_FRAME_HDR_SIZE bytes of wire data.
+ * @param hdr Decoded header.
+ * @return IPC_SUCCESS on success, IPC_FAILURE (errno EPROTO) if the length is out of range.
+ */
+int ipc_frame_hdr_decode(const void *buf, ipc_frame_hdr_t *hdr) {
+    uint32_t words[2];
+
+    memcpy(words, buf, IPC_FRAME_HDR_SIZE);
+    hdr->length = ntohl(words[0]);
+    hdr->flags = ntohl(words[1]);
+    if (hdr->length > IPC_FRAME_MAX_PAYLOAD) {
+        errno = EPROTO;
+        return IPC_FAILURE;
+    }
+    return IPC_SUCCESS;
+}
+
+/**
+ * @brief Encode the CRC32C trailer of a frame.
+ *
+ * @param buf Destination buffer of at least IPC_CRC32C_SIZE bytes.
+ * @param crc Checksum of the payload.
+ */
+void ipc_frame_crc_encode(void *buf, uint32_t crc) {
+    uint32_t word = htonl(crc);
+    memcpy(buf, &word, sizeof(word));
+}
+
+/**
+ * @brief Decode the CRC32C trailer of a frame.
+ *
+ * @param buf Buffer holding IPC_CRC32C_SIZE bytes of wire data.
+ * @return The checksum.
+ */
+uint32_t ipc_frame_crc_decode(const void *buf) {
+    uint32_t word;
+    memcpy(&word, buf, sizeof(word));
+    return ntohl(word);
+}
@@ -0,0 +1,757 @@
+/**
+ * @file ipc_journal.c
+ * author Animesh0817 (mailtome.anni@gmail.com)
+ * @brief Implementation of the memory-mapped journal transport.
+ *
+ * Offsets are logical byte positions in the journal; segment i holds
+ * [i * segment_size, (i + 1) * segment_size) in the file "<i>.seg". A record
+ * never straddles two segments: a writer whose reservation crosses a segment
+ * end turns it into padding on both sides and reserves again.
+ */
+
+#include "ipc_journal.h"
+#include "ipc_crc32c.h"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/file.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include <errno.h>
+
+#define IPC_JOURNAL_MAGIC 0x49504a4cu /* "IPJL" */
+#define IPC_JOURNAL_VERSION 2u /* 2: checksum flag, 28-bit lengths */
+
+/* Record state, kept in the top bits of the first header word */
+#define IPC_JOURNAL_COMMITTED (1u << 31) /**< Payload is complete; low bits are its length. */
+#define IPC_JOURNAL_PADDING (1u << 30) /**< Skip; low bits are the bytes to skip in 8-byte units. */
+#define IPC_JOURNAL_RESERVED (1u << 29) /**< Being written; low bits are its length. */
+#define IPC_JOURNAL_CHECKSUM (1u << 28) /**< The second header word is the payload's CRC32C. */
+#define IPC_JOURNAL_LEN_MASK ((1u << 28) - 1)
+
+#define IPC_JOURNAL_ALIGN(n) (((n) + 7u) & ~(uint64_t)7u)
+
+/* Skips can span almost a whole segment, so they are stored in 8-byte units
+ * to stay clear of the state bits for every allowed segment size */
+#define IPC_JOURNAL_PAD_WORD(skip) (IPC_JOURNAL_PADDING | (uint32_t)((skip) >> 3))
+#define IPC_JOURNAL_PAD_SKIP(word) ((uint64_t)((word) & IPC_JOURNAL_LEN_MASK) << 3)
+
+/**
+ * A Structure that will hold the metadata shared by every user of a journal:
+ * Header identifying the journal and its segment size
+ * Tail (next offset to reserve) and head (oldest retained offset)
+ * Futex words used to wake readers waiting for new records
+ * Doorbell parked word of the reader polling get_fd()
+ */
+struct ipc_journal_meta {
+    uint32_t magic; /**< IPC_JOURNAL_MAGIC once initialized. */
+    uint32_t version; /**< Layout version. */
+    uint64_t segment_size; /**< Size of every segment file. */
+    atomic_uint_fast64_t tail; /**< Next offset to reserve. */
+    atomic_uint_fast64_t head; /**< Oldest offset still on disk. */
+    atomic_uint commits; /**< Bumped when a record is published while readers wait. */
+    atomic_uint waiters; /**< Number of readers blocked in ipc_journal_wait(). */
+    atomic_uint parked; /**< Doorbell parked word. */
+};
+
+/**
+ * @brief Map segment index, creating and sizing its file if needed.
+ *
+ * @return The mapping, or NULL on failure.
+ */
+static unsigned char *ipc_journal_map_segment(ipc_journal_t *jnl, uint64_t index, int create) {
+    char path[PATH_MAX];
+    struct stat st;
+
+    snprintf(path, sizeof(path), "%s/%016llx.seg", jnl->dir, (unsigned long long)index);
+    int fd = open(path, O_RDWR | O_CLOEXEC | (create ? O_CREAT : 0), 0644);
+    if (fd == -1) {
+        return NULL;
+    }
+    // Concurrent creators all extend to the same size, which is harmless
+    if (fstat(fd, &st) == -1 || ((size_t)st.st_size < jnl->segment_size && ftruncate(fd, jnl->segment_size) == -1)) {
+        close(fd);
+        return NULL;
+    }
+    void *map = mmap(NULL, jnl->segment_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    return map == MAP_FAILED ? NULL : (unsigned char *)map;
+}
+
+/**
+ * @brief Get the writer mapping of a segment, switching the cached one if needed.
+ */
+static unsigned char *ipc_journal_writer_segment(ipc_journal_t *jnl, uint64_t index) {
+    if (jnl->w_map && jnl->w_index == index) {
+        return jnl->w_map;
+    }
+    unsigned char *map = ipc_journal_map_segment(jnl, index, 1);
+    if (!map) {
+        return NULL;
+    }
+    if (jnl->w_map) {
+        munmap(jnl->w_map, jnl->segment_size);
+    }
+    jnl->w_map = map;
+    jnl->w_index = index;
+    return map;
+}
+
+/**
+ * @brief Get the reader mapping of a segment, switching the cached one if needed.
+ *
+ * Plain reads never create the file: a missing segment was either truncated
+ * away or not created by its writer yet, and recreating it would hide the
+ * records that follow behind a zero-filled file.
+ */
+static unsigned char *ipc_journal_reader_segment(ipc_journal_t *jnl, uint64_t index, int create) {
+    if (jnl->r_map && jnl->r_index == index) {
+        return jnl->r_map;
+    }
+    unsigned char *map = ipc_journal_map_segment(jnl, index, create);
+    if (!map) {
+        return NULL;
+    }
+    if (jnl->r_map) {
+        munmap(jnl->r_map, jnl->segment_size);
+    }
+    jnl->r_map = map;
+    jnl->r_index = index;
+    return map;
+}
+
+/**
+ * @brief Get the header state word of the record at a mapped position.
+ */
+static atomic_uint *ipc_journal_word(unsigned char *map, uint64_t off) {
+    return (atomic_uint *)(map + off);
+}
+
+/**
+ * @brief Publish a padding record of skip bytes at a logical offset.
+ */
+static int ipc_journal_pad(ipc_journal_t *jnl, uint64_t pos, uint64_t skip) {
+    unsigned char *map = ipc_journal_writer_segment(jnl, pos / jnl->segment_size);
+    if (!map) {
+        return IPC_FAILURE;
+    }
+    atomic_store_explicit(ipc_journal_word(map, pos % jnl->segment_size),
+                          IPC_JOURNAL_PAD_WORD(skip), memory_order_release);
+    return IPC_SUCCESS;
+}
+
+/**
+ * @brief Wake readers blocked in ipc_journal_wait(), if there are any.
+ */
+static void ipc_journal_notify(ipc_journal_t *jnl) {
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load_explicit(&jnl->meta->waiters, memory_order_relaxed)) {
+        atomic_fetch_add_explicit(&jnl->meta->commits, 1, memory_order_release);
+        ipc_futex_wake(&jnl->meta->commits, INT_MAX);
+    }
+    if (jnl->doorbell.efd >= 0) {
+        ipc_doorbell_ring(&jnl->doorbell);
+    }
+}
+
+/**
+ * @brief Open the journal: create the directory and metadata if needed and map it.
+ *
+ * @param handle Pointer to the IPC journal handle.
+ * @return IPC_SUCCESS on success, IPC_FAILURE on failure.
+ */
+static int ipc_journal_init(ipc_handle_t *handle) {
+    ipc_journal_t *jnl = (ipc_journal_t *)handle;
+    char path[PATH_MAX];
+    struct stat st;
+
+    if (mkdir(jnl->dir, 0755) == -1 && errno != EEXIST) {
+        return IPC_FAILURE;
+    }
+    snprintf(path, sizeof(path), "%s/journal.meta", jnl->dir);
+    jnl->meta_fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (jnl->meta_fd == -1) {
+        return IPC_FAILURE;
+    }
+
+    // Serialize first-time initialization between processes
+    flock(jnl->meta_fd, LOCK_EX);
+    if (fstat(jnl->meta_fd, &st) == -1 ||
+        ((size_t)st.st_size < sizeof(struct ipc_journal_meta) &&
+         ftruncate(jnl->meta_fd, sizeof(struct ipc_journal_meta)) == -1)) {
+        flock(jnl->meta_fd, LOCK_UN);
+        close(jnl->meta_fd);
+        return IPC_FAILURE;
+    }
+    void *map = mmap(NULL, sizeof(struct ipc_journal_meta), PROT_READ | PROT_WRITE, MAP_SHARED, jnl->meta_fd, 0);
+    if (map == MAP_FAILED) {
+        flock(jnl->meta_fd, LOCK_UN);
+        close(jnl->meta_fd);
+        return IPC_FAILURE;
+    }
+    jnl->meta = (struct ipc_journal_meta *)map;
+    if (jnl->meta->magic != IPC_JOURNAL_MAGIC) {
+        jnl->meta->version = IPC_JOURNAL_VERSION;
+        jnl->meta->segment_size = jnl->segment_size;
+        atomic_store(&jnl->meta->tail, 0);
+        atomic_store(&jnl->meta->head, 0);
+        jnl->meta->magic = IPC_JOURNAL_MAGIC;
+        msync(map, sizeof(struct ipc_journal_meta), MS_SYNC);
+    }
+    flock(jnl->meta_fd, LOCK_UN);
+
+    if (jnl->meta->version != IPC_JOURNAL_VERSION) {
+        errno = EPROTO;
+        return IPC_FAILURE;
+    }
+    // An existing journal keeps the segment size it was created with
+    jnl->segment_size = jnl->meta->segment_size;
+    jnl->r_pos = atomic_load(&jnl->meta->head);
+    return ipc_doorbell_open(&jnl->doorbell, &jnl->meta->parked);
+}
+
+/**
+ * @brief Append a record to the journal.
+ *
+ * @param handle Pointer to the IPC journal handle.
+ * @param data Record payload.
+ * @param len Length of the payload.
+ * @param offset If not NULL, receives the offset of the record, usable with ipc_journal_seek().
+ * @return IPC_SUCCESS on success, IPC_FAILURE on failure.
+ */
+int ipc_journal_append(ipc_handle_t *handle, const void *data, size_t len, uint64_t *offset) {
+    ipc_journal_t *jnl = (ipc_journal_t *)handle;
+    uint64_t total = IPC_JOURNAL_ALIGN(IPC_JOURNAL_HDR_SIZE + len);
+    uint64_t seg_size;
+    uint64_t pos;
+
+    if (!jnl || !jnl->meta) {
+        errno = EINVAL;
+        return IPC_FAILURE;
+    }
+    seg_size = jnl->segment_size;
+    if (len > IPC_JOURNAL_MAX_RECORD || total > seg_size) {
+        errno = EMSGSIZE;
+        return IPC_FAILURE;
+    }
+
+    for (;;) {
+        pos = atomic_fetch_add_explicit(&jnl->meta->tail, total, memory_order_relaxed);
+        uint64_t off = pos % seg_size;
+        if (off + total <= seg_size) {
+            break;
+        }
+        // The reservation crosses a segment end: pad both pieces and retry
+        uint64_t next = pos - off + seg_size;
+        if (ipc_journal_pad(jnl, pos, seg_size - off) != IPC_SUCCESS ||
+            ipc_journal_pad(jnl, next, pos + total - next) != IPC_SUCCESS) {
+            return IPC_FAILURE;
+        }
+        ipc_journal_notify(jnl);
+    }
+
+    unsigned char *map = ipc_journal_writer_segment(jnl, pos / seg_size);
+    if (!map) {
+        return IPC_FAILURE;
+    }
+    uint64_t off = pos % seg_size;
+    atomic_uint *state = ipc_journal_word(map, off);
+
+    // Record the length first so a crashed write can be skipped by ipc_journal_recover()
+    atomic_store_explicit(state, IPC_JOURNAL_RESERVED | (uint32_t)len, memory_order_relaxed);
+    uint32_t crc = jnl->checksum ? ipc_crc32c(0, data, len) : 0;
+    memcpy(map + off + 4, &crc, sizeof(crc));
+    if (len) {
+        memcpy(map + off + IPC_JOURNAL_HDR_SIZE, data, len);
+    }
+    atomic_store_explicit(state, IPC_JOURNAL_COMMITTED | (jnl->checksum ? IPC_JOURNAL_CHECKSUM : 0) | (uint32_t)len,
+                          memory_order_release);
+    ipc_journal_notify(jnl);
+
+    if (offset) {
+        *offset = pos;
+    }
+    return IPC_SUCCESS;
+}
+
+/**
+ * @brief Return the next record in place and advance the read offset, without touching the doorbell.
+ */
+static int ipc_journal_next(ipc_journal_t *jnl, const void **data, size_t *len) {
+    for (;;) {
+        if (jnl->r_pos >= atomic_load_explicit(&jnl->meta->tail, memory_order_acquire)) {
+            errno = EAGAIN;
+            return IPC_FAILURE;
+        }
+        if (jnl->r_pos < atomic_load(&jnl->meta->head)) {
+            errno = ERANGE;
+            return IPC_FAILURE;
+        }
+        unsigned char *map = ipc_journal_reader_segment(jnl, jnl->r_pos / jnl->segment_size, 0);
+        if (!map) {
+            if (errno == ENOENT) {
+                // Truncated meanwhile, or the writer has not created it yet
+                errno = jnl->r_pos < atomic_load(&jnl->meta->head) ? ERANGE : EAGAIN;
+            }
+            return IPC_FAILURE;
+        }
+        uint64_t off = jnl->r_pos % jnl->segment_size;
+        uint32_t word = atomic_load_explicit(ipc_journal_word(map, off), memory_order_acquire);
+
+        if (word & IPC_JOURNAL_PADDING) {
+            jnl->r_pos += IPC_JOURNAL_PAD_SKIP(word);
+            continue;
+        }
+        if (!(word & IPC_JOURNAL_COMMITTED)) {
+            // Reserved by a writer that has not published it yet
+            errno = EAGAIN;
+            return IPC_FAILURE;
+        }
+
+        size_t size = word & IPC_JOURNAL_LEN_MASK;
+        jnl->r_pos += IPC_JOURNAL_ALIGN(IPC_JOURNAL_HDR_SIZE + size);
+        if ((word & IPC_JOURNAL_CHECKSUM) && jnl->checksum) {
+            uint32_t crc;
+            memcpy(&crc, map + off + 4, sizeof(crc));
+            if (crc != ipc_crc32c(0, map + off + IPC_JOURNAL_HDR_SIZE, size)) {
+                errno = EBADMSG;
+                return IPC_FAILURE;
+            }
+        }
+        *data = map + off + IPC_JOURNAL_HDR_SIZE;
+        *len = size;
+        return IPC_SUCCESS;
+    }
+}
+
+/**
+ * @brief Return the next record in place and advance the read offset.
+ *
+ * The view points into the mapping and stays valid until the next read call
+ * on this handle. Does not block. A call that finds no record arms the
+ * doorbell, so an event loop can wait for get_fd() to become readable.
+ *
+ * @param handle Pointer to the IPC journal handle.
+ * @param data Receives a pointer to the payload.
+ * @param len Receives the payload length.
+ * @return IPC_SUCCESS on success, IPC_FAILURE on failure (errno EAGAIN when
+ *         the reader has caught up with the writers, ERANGE when the read
+ *         offset was truncated away, EBADMSG when checksums are on and the
+ *         record is corrupt; the read offset then moves past it).
+ */
+int ipc_journal_read_view(ipc_handle_t *handle, const void **data, size_t *len) {
+    ipc_journal_t *jnl = (ipc_journal_t *)handle;
+
+    if (!jnl || !jnl->meta || !data || !len) {
+        errno = EINVAL;
+        return IPC_FAILURE;
+    }
+    if (jnl->doorbell.efd < 0) {
+        return ipc_journal_next(jnl, data, len);
+    }
+    if (ipc_journal_next(jnl, data, len) == IPC_SUCCESS) {
+        if (atomic_load_explicit(jnl->doorbell.parked, memory_order_relaxed)) {
+            ipc_doorbell_unpark(&jnl->doorbell);
+        }
+        return IPC_SUCCESS;
+    }
+    if (errno != EAGAIN) {
+        return IPC_FAILURE;
+    }
+    // Leave the doorbell armed so a poller on get_fd() wakes for the next record
+    ipc_doorbell_park(&jnl->doorbell);
+    return ipc_journal_next(jnl, data, len);
+}
+
+/**
+ * @brief Append a record (ipc_handle_t send operation).
+ */
+static int ipc_journal_send(ipc_handle_t *handle, const void *msg, size_t len) {
+    return ipc_journal_append(handle, msg, len, NULL);
+}
+
+/**
+ * @brief Copy the next record into a buffer (ipc_handle_t receive operation).
+ *
+ * A record larger than the buffer is skipped and the call fails with errno
+ * EMSGSIZE. Does not block; use ipc_journal_wait() to wait for new records.
+ *
+ * @return Length of the record on success, IPC_FAILURE on failure.
+ */
+static int ipc_journal_receive(ipc_handle_t *handle, void *buf, size_t len) {
+    const void *data;
+    size_t size;
+
+    if (ipc_journal_read_view(handle, &data, &size) != IPC_SUCCESS) {
+        return IPC_FAILURE;
+    }
+    if (size > len) {
+        errno = EMSGSIZE;
+        return IPC_FAILURE;
+    }
+    memcpy(buf, data, size);
+    return (int)size;
+}
+
+/**
+ * @brief Get the doorbell eventfd of the handle.
+ *
+ * @return The eventfd, or IPC_FAILURE (errno ENOTSUP) if the handle has none.
+ */
+static int ipc_journal_get_fd(ipc_handle_t *handle) {
+    ipc_journal_t *jnl = (ipc_journal_t *)handle;
+
+    if (jnl->doorbell.efd < 0) {
+        errno = ENOTSUP;
+        return IPC_FAILURE;
+    }
+    return jnl->doorbell.efd;
+}
+
+/**
+ * @brief Unmap the journal and free the handle. Files stay on disk.
+ */
+static int ipc_journal_destroy(ipc_handle_t *handle) {
+    ipc_journal_t *jnl = (ipc_journal_t *)handle;
+
+    ipc_doorbell_close(&jnl->doorbell);
+    if (jnl->w_map) {
+        munmap(jnl->w_map, jnl->segment_size);
+    }
+    if (jnl->r_map) {
+        munmap(jnl->r_map, jnl->segment_size);
+    }
+    if (jnl->meta) {
+        munmap(jnl->meta, sizeof(struct ipc_journal_meta));
+    }
+    if (jnl->meta_fd >= 0) {
+        close(jnl->meta_fd);
+    }
+    free(jnl->dir);
+    free(jnl);
+    return IPC_SUCCESS;
+}
+
+/**
+ * @brief Create a new IPC journal handle.
+ *
+ * Nothing is opened until init(); several handles, in the same or different
+ * processes, can use the same directory.
+ *
+ * @param dir Journal directory; created by init() if missing.
+ * @param segment_size Size of each segment file for a new journal, a multiple
+ *        of the page size, or 0 for IPC_JOURNAL_DEFAULT_SEGMENT. Ignored when
+ *        the journal already exists.
+ * @return Pointer to the created IPC journal handle, or NULL on failure.
+ */
+ipc_handle_t *ipc_journal_create(const char *dir, size_t segment_size) {
+    long page = sysconf(_SC_PAGESIZE);
+
+    if (segment_size == 0) {
+        segment_size = IPC_JOURNAL_DEFAULT_SEGMENT;
+    }
+    if (!dir || segment_size % (size_t)page != 0 || segment_size > (1u << 30)) {
+        errno = EINVAL;
+        return NULL;
+    }
+
+    ipc_journal_t *jnl = (ipc_journal_t *)calloc(1, sizeof(ipc_journal_t));
+    if (!jnl) {
+        return NULL;
+    }
+    jnl->dir = strdup(dir);
+    if (!jnl->dir) {
+        free(jnl);
+        return NULL;
+    }
+    jnl->segment_size = segment_size;
+    jnl->meta_fd = -1;
+    jnl->doorbell.efd = -1;
+
+    // Assign function pointers
+    jnl->base.init = (int (*)(void *))ipc_journal_init;
+    jnl->base.send = (int (*)(void *, const void *, size_t))ipc_journal_send;
+    jnl->base.receive = (int (*)(void *, void *, size_t))ipc_journal_receive;
+    jnl->base.destroy = (int (*)(void *))ipc_journal_destroy;
+    jnl->base.accept = NULL;
+    jnl->base.get_fd = (int (*)(void *))ipc_journal_get_fd;
+
+    return (ipc_handle_t *)jnl;
+}
+
+/**
+ * @brief Move the read offset.
+ *
+ * @param handle Pointer to the IPC journal handle.
+ * @param offset A record offset returned by ipc_journal_append() or
+ *        ipc_journal_position(), or ipc_journal_tail() to skip the backlog.
+ * @return IPC_SUCCESS on success, IPC_FAILURE (errno ERANGE) if the offset
+ *         was truncated away or is beyond the tail.
+ */
+int ipc_journal_seek(ipc_handle_t *handle, uint64_t offset) {
+    ipc_journal_t *jnl = (ipc_journal_t *)handle;
+
+    if (!jnl || !jnl->meta || (offset & 7u)) {
+        errno = EINVAL;
+        return IPC_FAILURE;
+    }
+    if (offset < atomic_load(&jnl->meta->head) || offset > atomic_load(&jnl->meta->tail)) {
+        errno = ERANGE;
+        return IPC_FAILURE;
+    }
+    jnl->r_pos = offset;
+    return IPC_SUCCESS;
+}
+
+/**
+ * @brief Get the read offset, i.e. the offset of the next record to read.
+ *
+ * Persist it after processing a record to resume from there after a restart.
+ *
+ * @param handle Pointer to the IPC journal handle.
+ * @return The read offset.
+ */
+uint64_t ipc_journal_position(ipc_handle_t *handle) {
+    ipc_journal_t *jnl = (ipc_journal_t *)handle;
+    return jnl->r_pos;
+}
+
+/**
+ * @brief Get the offset at which the next record will be appended.
+ *
+ * @param handle Pointer to the IPC journal handle.
+ * @return The tail offset.
+ */
+uint64_t ipc_journal_tail(ipc_handle_t *handle) {
+    ipc_journal_t *jnl = (ipc_journal_t *)handle;
+    return atomic_load(&jnl->meta->tail);
+}
+
+/**
+ * @brief Get the oldest offset still on disk.
+ *
+ * Readers whose offset falls before it (see ipc_journal_truncate()) can
+ * seek here to resume with the oldest retained record.
+ *
+ * @param handle Pointer to the IPC journal handle.
+ * @return The head offset.
+ */
+uint64_t ipc_journal_head(ipc_handle_t *handle) {
+    ipc_journal_t *jnl = (ipc_journal_t *)handle;
+    return atomic_load(&jnl->meta->head);
+}
+
+/**
+ * @brief Block until a record may be available past the read offset.
+ *
+ * Writers only issue the wake-up syscall while a reader is waiting. A read
+ * that would fail for another reason than EAGAIN (e.g. ERANGE) does not
+ * wait, so the caller's next read reports the error.
+ *
+ * @param handle Pointer to the IPC journal handle.
+ * @param timeout_ms Timeout in milliseconds, or -1 to wait forever.
+ * @return IPC_SUCCESS when woken or data is pending, IPC_FAILURE on timeout
+ *         (errno ETIMEDOUT) or error.
+ */
+int ipc_journal_wait(ipc_handle_t *handle, int timeout_ms) {
+    ipc_journal_t *jnl = (ipc_journal_t *)handle;
+    struct timespec ts;
+    const void *data;
+    size_t len;
+
+    if (!jnl || !jnl->meta) {
+        errno = EINVAL;
+        return IPC_FAILURE;
+    }
+    const struct timespec *deadline = ipc_futex_deadline(&ts, timeout_ms);
+
+    atomic_fetch_add(&jnl->meta->waiters, 1);
+    unsigned int seen = atomic_load(&jnl->meta->commits);
+
+    // Re-check after announcing ourselves, without consuming the record
+    uint64_t saved = jnl->r_pos;
+    int ready = ipc_journal_next(jnl, &data, &len) == IPC_SUCCESS || errno != EAGAIN;
+    jnl->r_pos = saved;
+
+    int ret = IPC_SUCCESS;
+    if (!ready) {
+        ret = ipc_futex_wait(&jnl->meta->commits, seen, deadline);
+    }
+    atomic_fetch_sub(&jnl->meta->waiters, 1);
+
+    if (ret != IPC_SUCCESS && errno == ETIMEDOUT) {
+        return IPC_FAILURE;
+    }
+    return IPC_SUCCESS;
+}
+
+/**
+ * @brief Flush the segment written last and the metadata to stable storage.
+ *
+ * Records survive a crash of the writing process without this; it is only
+ * needed to survive a crash of the machine.
+ *
+ * @param handle Pointer to the IPC journal handle.
+ * @return IPC_SUCCESS on success, IPC_FAILURE on failure.
+ */
+int ipc_journal_sync(ipc_handle_t *handle) {
+    ipc_journal_t *jnl = (ipc_journal_t *)handle;
+
+    if (!jnl || !jnl->meta) {
+        errno = EINVAL;
+        return IPC_FAILURE;
+    }
+    if (jnl->w_map && msync(jnl->w_map, jnl->segment_size, MS_SYNC) == -1) {
+        return IPC_FAILURE;
+    }
+    return msync(jnl->meta, sizeof(struct ipc_journal_meta), MS_SYNC) == 0 ? IPC_SUCCESS : IPC_FAILURE;
+}
+
+/**
+ * @brief Skip records left unpublished by writers that crashed mid-append.
+ *
+ * Scans from the read offset to the tail and turns every reserved but never
+ * published record into padding so readers stop waiting on it. Only call this
+ * when no writer is running, e.g. at start-up before producers are launched.
+ *
+ * @param handle Pointer to the IPC journal handle.
+ * @return Number of records skipped, or IPC_FAILURE on failure (errno EPROTO
+ *         if a reservation has no header at all and cannot be skipped).
+ */
+int ipc_journal_recover(ipc_handle_t *handle) {
+    ipc_journal_t *jnl = (ipc_journal_t *)handle;
+    uint64_t tail;
+    uint64_t pos;
+    int skipped = 0;
+
+    if (!jnl || !jnl->meta) {
+        errno = EINVAL;
+        return IPC_FAILURE;
+    }
+    tail = atomic_load(&jnl->meta->tail);
+    pos = jnl->r_pos;
+    if (pos < atomic_load(&jnl->meta->head)) {
+        errno = ERANGE;
+        return IPC_FAILURE;
+    }
+
+    while (pos < tail) {
+        // A writer may have died before creating the file of its reservation
+        unsigned char *map = ipc_journal_reader_segment(jnl, pos / jnl->segment_size, 1);
+        if (!map) {
+            return IPC_FAILURE;
+        }
+        uint64_t off = pos % jnl->segment_size;
+        atomic_uint *state = ipc_journal_word(map, off);
+        uint32_t word = atomic_load(state);
+        uint64_t size;
+
+        if (word & IPC_JOURNAL_PADDING) {
+            size = IPC_JOURNAL_PAD_SKIP(word);
+        } else if (word & (IPC_JOURNAL_COMMITTED | IPC_JOURNAL_RESERVED)) {
+            size = IPC_JOURNAL_ALIGN(IPC_JOURNAL_HDR_SIZE + (word & IPC_JOURNAL_LEN_MASK));
+            if (!(word & IPC_JOURNAL_COMMITTED)) {
+                atomic_store(state, IPC_JOURNAL_PAD_WORD(size));
+                skipped++;
+            }
+        } else if (pos + (jnl->segment_size - off) >= tail) {
+            // Writer died right after reserving the last space before the
+            // tail: nothing follows it, so pad up to the tail
+            size = tail - pos;
+            atomic_store(state, IPC_JOURNAL_PAD_WORD(size));
+            skipped++;
+        } else {
+            errno = EPROTO;
+            return IPC_FAILURE;
+        }
+        pos += size;
+    }
+    return skipped;
+}
+
+/**
+ * @brief Delete whole segments that lie entirely before an offset.
+ *
+ * Reads and seeks positioned before the new head fail with ERANGE; see
+ * ipc_journal_head().
+ *
+ * @param handle Pointer to the IPC journal handle.
+ * @param offset Oldest offset that must be kept.
+ * @return IPC_SUCCESS on success, IPC_FAILURE on failure.
+ */
+int ipc_journal_truncate(ipc_handle_t *handle, uint64_t offset) {
+    ipc_journal_t *jnl = (ipc_journal_t *)handle;
+    char path[PATH_MAX];
+
+    if (!jnl || !jnl->meta || offset > atomic_load(&jnl->meta->tail)) {
+        errno = EINVAL;
+        return IPC_FAILURE;
+    }
+    uint64_t keep = offset / jnl->segment_size;
+    uint64_t head = atomic_load(&jnl->meta->head);
+    uint64_t new_head = keep * jnl->segment_size;
+    if (new_head <= head) {
+        return IPC_SUCCESS;
+    }
+
+    atomic_store(&jnl->meta->head, new_head);
+    for (uint64_t i = head / jnl->segment_size; i < keep; i++) {
+        snprintf(path, sizeof(path), "%s/%016llx.seg", jnl->dir, (unsigned long long)i);
+        if (unlink(path) == -1 && errno != ENOENT) {
+            return IPC_FAILURE;
+        }
+    }
+    return IPC_SUCCESS;
+}
+
+/**
+ * @brief Use another handle's eventfd as doorbell.
+ *
+ * Every handle rings its own doorbell when it appends, so a reader polling
+ * get_fd() is only woken by writers that share its eventfd: pass the
+ * reader's ipc_handle_get_fd() to this call on each writer handle, through
+ * fork() or SCM_RIGHTS across processes. The descriptor is not closed by
+ * the handle.
+ *
+ * @param handle Pointer to an initialized IPC journal handle.
+ * @param efd eventfd descriptor.
+ * @return IPC_SUCCESS on success, IPC_FAILURE on failure.
+ */
+int ipc_journal_attach_doorbell(ipc_handle_t *handle, int efd) {
+    ipc_journal_t *jnl = (ipc_journal_t *)handle;
+
+    if (!jnl || !jnl->meta) {
+        errno = EINVAL;
+        return IPC_FAILURE;
+    }
+    ipc_doorbell_close(&jnl->doorbell);
+    return ipc_doorbell_attach(&jnl->doorbell, efd, &jnl->meta->parked);
+}
+
+/**
+ * @brief Enable or disable CRC32C checksums on a journal handle.
+ *
+ * With checksums on, records appended through this handle store the CRC32C
+ * of their payload in the record header, and records read through it that
+ * carry a checksum are verified, which catches torn or corrupted segment
+ * files after a crash. Records written without a checksum are read as before.
+ *
+ * @param handle Pointer to the IPC journal handle.
+ * @param enable Non-zero to write and verify checksums, zero to skip them.
+ * @return IPC_SUCCESS on success, IPC_FAILURE on failure.
+ */
+int ipc_journal_set_checksum(ipc_handle_t *handle, int enable) {
+    ipc_journal_t *jnl = (ipc_journal_t *)handle;
+
+    if (!jnl) {
+        errno = EINVAL;
+        return IPC_FAILURE;
+    }
+    jnl->checksum = enable ? 1 : 0;
+    return IPC_SUCCESS;
+}
@@ -0,0 +1,606 @@
+/**
+ * @file ipc_mux.c
+ * author Animesh0817 (mailtome.anni@gmail.com)
+ * @brief Implementation of prioritized lanes multiplexed over one IPC handle.
+ *
+ * Senders queue messages on their lane and then take turns "pumping": the
+ * thread that holds the pump puts one chunk at a time on the wire, choosing
+ * each chunk afresh, until its own message is fully sent. It then hands the
+ * pump to the next waiting sender. A message queued on an urgent lane is thus
+ * picked up at the next chunk boundary by whichever thread is pumping.
+ */
+
+#include "ipc_mux.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <endian.h>
+#include <errno.h>
+
+#define IPC_MUX_FLAG_FIRST 0x01 /**< First chunk of a message. */
+#define IPC_MUX_FLAG_LAST 0x02 /**< Last chunk of a message. */
+
+#define IPC_MUX_QUEUED 0 /**< Message still has chunks to send. */
+#define IPC_MUX_SENT 1 /**< Last chunk handed to the transport. */
+#define IPC_MUX_FAILED 2 /**< Transport failed before the message was sent. */
+
+/**
+ * A Structure that will hold the following:
+ * Message data and how much of it has been sent
+ * Completion state, reported to the sender waiting on it
+ */
+typedef struct ipc_mux_msg {
+    struct ipc_mux_msg *next; /**< Next message on the same lane. */
+    const unsigned char *data; /**< Message data. */
+    size_t len; /**< Message length. */
+    size_t off; /**< Bytes already cut into chunks. */
+    int state; /**< IPC_MUX_QUEUED, IPC_MUX_SENT or IPC_MUX_FAILED. */
+    int owned; /**< Allocated by ipc_mux_queue() and freed once sent. */
+} ipc_mux_msg_t;
+
+/**
+ * A Structure that will hold the following:
+ * Scheduling parameters and deficit of the lane
+ * Queue of outgoing messages
+ * Reassembly state of the incoming message
+ */
+typedef struct {
+    int open; /**< Lane may be used for sending. */
+    unsigned int priority; /**< Priority class. */
+    size_t quantum; /**< Bytes credited per round robin turn (weight * chunk). */
+    size_t deficit; /**< Bytes the lane may still send in its current turn. */
+    ipc_mux_msg_t *head; /**< Oldest queued message. */
+    ipc_mux_msg_t *tail; /**< Newest queued message. */
+    unsigned char *rx_buf; /**< Reassembly buffer. */
+    size_t rx_cap; /**< Capacity of rx_buf. */
+    size_t rx_len; /**< Bytes received of the current message. */
+    size_t rx_total; /**< Announced length of the current message. */
+    int rx_active; /**< A message is being reassembled. */
+    int rx_discard; /**< The current message exceeds max_msg and is dropped. */
+} ipc_mux_lane_t;
+
+/**
+ * A Structure that will hold the following:
+ * Lanes belonging to a priority class and the round robin position
+ */
+typedef struct {
+    uint8_t members[IPC_MUX_MAX_LANES]; /**< Lane IDs in the class. */
+    unsigned int count; /**< Number of lanes in the class. */
+    unsigned int cursor; /**< Index in members of the lane whose turn it is. */
+    int credited; /**< The current lane already got its quantum this turn. */
+} ipc_mux_class_t;
+
+struct ipc_mux {
+    ipc_handle_t *handle; /**< Message-oriented transport. */
+    size_t chunk_size; /**< Largest chunk payload. */
+    size_t max_msg; /**< Largest message accepted by the receiver. */
+    unsigned char *tx_buf; /**< Chunk being sent, owned by the pumping thread. */
+    unsigned char *rx_buf; /**< Chunk being received, guarded by rx_lock. */
+    pthread_mutex_t lock; /**< Guards lanes, classes and the pump. */
+    pthread_cond_t cond; /**< Signalled when a message completes or the pump is released. */
+    pthread_mutex_t rx_lock; /**< Admits one receiver at a time. */
+    int pumping; /**< A thread is sending chunks. */
+    size_t queued; /**< Messages with chunks left to send. */
+    int tx_error; /**< errno of a failed send; the stream is unusable afterwards. */
+    ipc_mux_lane_t lanes[IPC_MUX_MAX_LANES]; /**< Lane table. */
+    ipc_mux_class_t classes[IPC_MUX_PRIORITIES]; /**< Priority classes. */
+};
+
+/**
+ * @brief Mark a message as finished and release it if the mux owns it.
+ */
+static void ipc_mux_complete(ipc_mux_t *mux, ipc_mux_msg_t *msg, int state) {
+    mux->queued--;
+    if (msg->owned) {
+        free(msg);
+    } else {
+        msg->state = state;
+    }
+}
+
+/**
+ * @brief Fail every queued message after a transport error. Called with lock held.
+ */
+static void ipc_mux_fail_all(ipc_mux_t *mux) {
+    for (unsigned int i = 0; i < IPC_MUX_MAX_LANES; i++) {
+        ipc_mux_lane_t *lane = &mux->lanes[i];
+        while (lane->head) {
+            ipc_mux_msg_t *msg = lane->head;
+            lane->head = msg->next;
+            ipc_mux_complete(mux, msg, IPC_MUX_FAILED);
+        }
+        lane->tail = NULL;
+    }
+}
+
+/**
+ * @brief Choose the lane that sends the next chunk. Called with lock held.
+ *
+ * Strict priority across classes, deficit round robin within a class.
+ *
+ * @return Lane ID, or -1 if nothing is queued.
+ */
+static int ipc_mux_pick(ipc_mux_t *mux) {
+    for (unsigned int p = 0; p < IPC_MUX_PRIORITIES; p++) {
+        ipc_mux_class_t *cls = &mux->classes[p];
+        if (cls->count == 0) {
+            continue;
+        }
+
+        // Every step either returns or moves to the next lane
+        for (unsigned int step = 0; step < 2 * cls->count + 1; step++) {
+            unsigned int id = cls->members[cls->cursor];
+            ipc_mux_lane_t *lane = &mux->lanes[id];
+
+            if (lane->head) {
+                ipc_mux_msg_t *msg = lane->head;
+                size_t left = msg->len - msg->off;
+                size_t cost = IPC_MUX_HDR_SIZE + (left < mux->chunk_size ? left : mux->chunk_size);
+
+                if (!cls->credited) {
+                    lane->deficit += lane->quantum;
+                    cls->credited = 1;
+                }
+                if (lane->deficit >= cost) {
+                    lane->deficit -= cost;
+                    return (int)id;
+                }
+            } else {
+                // An idle lane does not bank credit
+                lane->deficit = 0;
+            }
+            cls->cursor = (cls->cursor + 1) % cls->count;
+            cls->credited = 0;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Send chunks until a message completes. Called with lock held and the pump taken.
+ *
+ * @param mux Multiplexer.
+ * @param until Message to wait for, or NULL to send everything queued.
+ * @return IPC_SUCCESS on success, IPC_FAILURE on failure.
+ */
+static int ipc_mux_pump(ipc_mux_t *mux, ipc_mux_msg_t *until) {
+    while (until ? until->state == IPC_MUX_QUEUED : mux->queued > 0) {
+        int id = ipc_mux_pick(mux);
+        if (id < 0) {
+            break;
+        }
+        ipc_mux_lane_t *lane = &mux->lanes[id];
+        ipc_mux_msg_t *msg = lane->head;
+        size_t off = msg->off;
+        size_t n = msg->len - off < mux->chunk_size ? msg->len - off : mux->chunk_size;
+        uint8_t flags = (off == 0 ? IPC_MUX_FLAG_FIRST : 0) | (off + n == msg->len ? IPC_MUX_FLAG_LAST : 0);
+        uint32_t total_be = htobe32((uint32_t)msg->len);
+
+        msg->off += n;
+        if (flags & IPC_MUX_FLAG_LAST) {
+            lane->head = msg->next;
+            if (!lane->head) {
+                lane->tail = NULL;
+            }
+        }
+
+        // The sender of msg is blocked until it completes, so its data stays valid
+        pthread_mutex_unlock(&mux->lock);
+        mux->tx_buf[0] = (uint8_t)id;
+        mux->tx_buf[1] = flags;
+        mux->tx_buf[2] = 0;
+        mux->tx_buf[3] = 0;
+        memcpy(mux->tx_buf + 4, &total_be, sizeof(total_be));
+        if (n) {
+            memcpy(mux->tx_buf + IPC_MUX_HDR_SIZE, msg->data + off, n);
+        }
+        int ret = mux->handle->send(mux->handle, mux->tx_buf, IPC_MUX_HDR_SIZE + n);
+        int err = errno;
+        pthread_mutex_lock(&mux->lock);
+
+        if (ret < 0) {
+            mux->tx_error = err ? err : EIO;
+            if (flags & IPC_MUX_FLAG_LAST) {
+                ipc_mux_complete(mux, msg, IPC_MUX_FAILED);
+            }
+            ipc_mux_fail_all(mux);
+            pthread_cond_broadcast(&mux->cond);
+            errno = mux->tx_error;
+            return IPC_FAILURE;
+        }
+        if (flags & IPC_MUX_FLAG_LAST) {
+            ipc_mux_complete(mux, msg, IPC_MUX_SENT);
+            pthread_cond_broadcast(&mux->cond);
+        }
+    }
+    return IPC_SUCCESS;
+}
+
+/**
+ * @brief Append a message to its lane. Called with lock held.
+ *
+ * @return IPC_SUCCESS on success, IPC_FAILURE on failure.
+ */
+static int ipc_mux_enqueue(ipc_mux_t *mux, unsigned int id, ipc_mux_msg_t *msg) {
+    if (mux->tx_error) {
+        errno = mux->tx_error;
+        return IPC_FAILURE;
+    }
+    ipc_mux_lane_t *lane = &mux->lanes[id];
+    if (lane->tail) {
+        lane->tail->next = msg;
+    } else {
+        lane->head = msg;
+    }
+    lane->tail = msg;
+    mux->queued++;
+    return IPC_SUCCESS;
+}
+
+/**
+ * @brief Check the arguments of a send.
+ */
+static int ipc_mux_check_send(ipc_mux_t *mux, unsigned int lane, const void *msg, size_t len) {
+    if (!mux || lane >= IPC_MUX_MAX_LANES || (!msg && len)) {
+        errno = EINVAL;
+        return IPC_FAILURE;
+    }
+    if (len > UINT32_MAX) {
+        errno = EMSGSIZE;
+        return IPC_FAILURE;
+    }
+    return IPC_SUCCESS;
+}
+
+/**
+ * @brief Create a multiplexer on top of an IPC handle.
+ *
+ * The handle is not owned by the multiplexer and must outlive it. Both peers
+ * must use the same chunk size.
+ *
+ * @param handle Message-oriented IPC handle (e.g. a framed socket).
+ * @param chunk_size Largest chunk payload, or 0 for IPC_MUX_DEFAULT_CHUNK.
+ *        Smaller chunks bound the wait of urgent lanes more tightly at the
+ *        cost of more messages on the transport.
+ * @param max_msg Largest message accepted by ipc_mux_receive().
+ * @return Pointer to the multiplexer, or NULL on failure.
+ */
+ipc_mux_t *ipc_mux_create(ipc_handle_t *handle, size_t chunk_size, size_t max_msg) {
+    if (chunk_size == 0) {
+        chunk_size = IPC_MUX_DEFAULT_CHUNK;
+    }
+    if (!handle || !handle->send || !handle->receive || max_msg > UINT32_MAX) {
+        errno = EINVAL;
+        return NULL;
+    }
+
+    ipc_mux_t *mux = (ipc_mux_t *)calloc(1, sizeof(ipc_mux_t));
+    if (!mux) {
+        return NULL;
+    }
+    mux->handle = handle;
+    mux->chunk_size = chunk_size;
+    mux->max_msg = max_msg;
+    mux->tx_buf = (unsigned char *)malloc(IPC_MUX_HDR_SIZE + chunk_size);
+    mux->rx_buf = (unsigned char *)malloc(IPC_MUX_HDR_SIZE + chunk_size);
+    if (!mux->tx_buf || !mux->rx_buf) {
+        free(mux->tx_buf);
+        free(mux->rx_buf);
+        free(mux);
+        return NULL;
+    }
+    pthread_mutex_init(&mux->lock, NULL);
+    pthread_cond_init(&mux->cond, NULL);
+    pthread_mutex_init(&mux->rx_lock, NULL);
+
+    return mux;
+}
+
+/**
+ * @brief Destroy a multiplexer.
+ *
+ * Messages still queued with ipc_mux_queue() are dropped. No thread may be
+ * inside ipc_mux_send(). The underlying handle is left open.
+ *
+ * @param mux Multiplexer.
+ */
+void ipc_mux_destroy(ipc_mux_t *mux) {
+    if (!mux) {
+        return;
+    }
+    ipc_mux_fail_all(mux);
+    for (unsigned int i = 0; i < IPC_MUX_MAX_LANES; i++) {
+        free(mux->lanes[i].rx_buf);
+    }
+    pthread_mutex_destroy(&mux->lock);
+    pthread_cond_destroy(&mux->cond);
+    pthread_mutex_destroy(&mux->rx_lock);
+    free(mux->tx_buf);
+    free(mux->rx_buf);
+    free(mux);
+}
+
+/**
+ * @brief Open a lane for sending, or change its scheduling parameters.
+ *
+ * Receiving needs no setup: messages on any lane are delivered.
+ *
+ * @param mux Multiplexer.
+ * @param lane Lane ID, below IPC_MUX_MAX_LANES. Both peers must agree on its meaning.
+ * @param priority Priority class, below IPC_MUX_PRIORITIES; 0 is the most urgent.
+ * @param weight Relative share of bandwidth among lanes of the same class (at least 1).
+ * @return IPC_SUCCESS on success, IPC_FAILURE on failure.
+ */
+int ipc_mux_open_lane(ipc_mux_t *mux, unsigned int lane, unsigned int priority, unsigned int weight) {
+    if (!mux || lane >= IPC_MUX_MAX_LANES || priority >= IPC_MUX_PRIORITIES || weight == 0) {
+        errno = EINVAL;
+        return IPC_FAILURE;
+    }
+
+    pthread_mutex_lock(&mux->lock);
+    ipc_mux_lane_t *l = &mux->lanes[lane];
+    if (l->open && l->priority != priority) {
+        // Leave the old class
+        ipc_mux_class_t *old = &mux->classes[l->priority];
+        for (unsigned int i = 0; i < old->count; i++) {
+            if (old->members[i] == lane) {
+                memmove(&old->members[i], &old->members[i + 1], old->count - i - 1);
+                old->count--;
+                break;
+            }
+        }
+        old->cursor = 0;
+        old->credited = 0;
+        l->open = 0;
+    }
+    if (!l->open) {
+        ipc_mux_class_t *cls = &mux->classes[priority];
+        cls->members[cls->count++] = (uint8_t)lane;
+        l->open = 1;
+    }
+    l->priority = priority;
+    l->quantum = (size_t)weight * (IPC_MUX_HDR_SIZE + mux->chunk_size);
+    l->deficit = 0;
+    pthread_mutex_unlock(&mux->lock);
+
+    return IPC_SUCCESS;
+}
+
+/**
+ * @brief Send a message on a lane and wait until it is handed to the transport.
+ *
+ * The message is not copied. While waiting, the calling thread may send
+ * chunks of other lanes' messages, in scheduling order.
+ *
+ * @param mux Multiplexer.
+ * @param lane Open lane.
+ * @param msg Message data.
+ * @param len Message length.
+ * @return IPC_SUCCESS on success, IPC_FAILURE on failure. After a transport
+ *         failure every later send fails with the same errno.
+ */
+int ipc_mux_send(ipc_mux_t *mux, unsigned int lane, const void *msg, size_t len) {
+    ipc_mux_msg_t node = { .data = (const unsigned char *)msg, .len = len };
+    int ret = IPC_SUCCESS;
+
+    if (ipc_mux_check_send(mux, lane, msg, len) != IPC_SUCCESS) {
+        return IPC_FAILURE;
+    }
+
+    pthread_mutex_lock(&mux->lock);
+    if (!mux->lanes[lane].open) {
+        pthread_mutex_unlock(&mux->lock);
+        errno = EINVAL;
+        return IPC_FAILURE;
+    }
+    if (ipc_mux_enqueue(mux, lane, &node) != IPC_SUCCESS) {
+        pthread_mutex_unlock(&mux->lock);
+        return IPC_FAILURE;
+    }
+    while (node.state == IPC_MUX_QUEUED) {
+        if (mux->pumping) {
+            pthread_cond_wait(&mux->cond, &mux->lock);
+            continue;
+        }
+        mux->pumping = 1;
+        ipc_mux_pump(mux, &node);
+        mux->pumping = 0;
+        pthread_cond_broadcast(&mux->cond);
+    }
+    if (node.state != IPC_MUX_SENT) {
+        errno = mux->tx_error;
+        ret = IPC_FAILURE;
+    }
+    pthread_mutex_unlock(&mux->lock);
+
+    return ret;
+}
+
+/**
+ * @brief Queue a copy of a message on a lane without sending it.
+ *
+ * Queued messages go out with the next ipc_mux_flush(), or earlier when a
+ * thread pumping for ipc_mux_send() schedules them.
+ *
+ * @param mux Multiplexer.
+ * @param lane Open lane.
+ * @param msg Message data.
+ * @param len Message length.
+ * @return IPC_SUCCESS on success, IPC_FAILURE on failure.
+ */
+int ipc_mux_queue(ipc_mux_t *mux, unsigned int lane, const void *msg, size_t len) {
+    if (ipc_mux_check_send(mux, lane, msg, len) != IPC_SUCCESS) {
+        return IPC_FAILURE;
+    }
+    ipc_mux_msg_t *node = (ipc_mux_msg_t *)calloc(1, sizeof(ipc_mux_msg_t) + len);
+    if (!node) {
+        return IPC_FAILURE;
+    }
+    node->data = (const unsigned char *)(node + 1);
+    node->len = len;
+    node->owned = 1;
+    if (len) {
+        memcpy(node + 1, msg, len);
+    }
+
+    pthread_mutex_lock(&mux->lock);
+    int ret = IPC_FAILURE;
+    if (!mux->lanes[lane].open) {
+        errno = EINVAL;
+    } else {
+        ret = ipc_mux_enqueue(mux, lane, node);
+    }
+    pthread_mutex_unlock(&mux->lock);
+
+    if (ret != IPC_SUCCESS) {
+        free(node);
+    }
+    return ret;
+}
+
+/**
+ * @brief Send every queued message, in scheduling order.
+ *
+ * @param mux Multiplexer.
+ * @return IPC_SUCCESS on success, IPC_FAILURE on failure.
+ */
+int ipc_mux_flush(ipc_mux_t *mux) {
+    if (!mux) {
+        errno = EINVAL;
+        return IPC_FAILURE;
+    }
+
+    pthread_mutex_lock(&mux->lock);
+    while (mux->queued > 0 && !mux->tx_error) {
+        if (mux->pumping) {
+            pthread_cond_wait(&mux->cond, &mux->lock);
+            continue;
+        }
+        mux->pumping = 1;
+        ipc_mux_pump(mux, NULL);
+        mux->pumping = 0;
+        pthread_cond_broadcast(&mux->cond);
+    }
+    int err = mux->tx_error;
+    pthread_mutex_unlock(&mux->lock);
+
+    if (err) {
+        errno = err;
+        return IPC_FAILURE;
+    }
+    return IPC_SUCCESS;
+}
+
+/**
+ * @brief Receive the next complete message on any lane.
+ *
+ * Blocks while the underlying handle blocks. The returned message points into
+ * a buffer owned by the multiplexer and stays valid until the next call.
+ *
+ * @param mux Multiplexer.
+ * @param lane Receives the lane ID of the message.
+ * @param msg Receives a pointer to the message data.
+ * @param len Receives the message length.
+ * @return IPC_SUCCESS on success, IPC_FAILURE on failure (errno EMSGSIZE when
+ *         a message larger than max_msg was dropped, EPROTO on a malformed stream).
+ */
+int ipc_mux_receive(ipc_mux_t *mux, unsigned int *lane, const void **msg, size_t *len) {
+    int ret = IPC_FAILURE;
+
+    if (!mux || !lane || !msg || !len) {
+        errno = EINVAL;
+        return IPC_FAILURE;
+    }
+
+    pthread_mutex_lock(&mux->rx_lock);
+    for (;;) {
+        int n = mux->handle->receive(mux->handle, mux->rx_buf, IPC_MUX_HDR_SIZE + mux->chunk_size);
+        if (n < IPC_MUX_HDR_SIZE) {
+            if (n >= 0) {
+                errno = EPROTO;
+            }
+            break;
+        }
+
+        unsigned int id = mux->rx_buf[0];
+        uint8_t flags = mux->rx_buf[1];
+        uint32_t total;
+        memcpy(&total, mux->rx_buf + 4, sizeof(total));
+        total = be32toh(total);
+        const unsigned char *data = mux->rx_buf + IPC_MUX_HDR_SIZE;
+        size_t dlen = (size_t)n - IPC_MUX_HDR_SIZE;
+        ipc_mux_lane_t *l = &mux->lanes[id];
+
+        if ((flags & IPC_MUX_FLAG_FIRST) && (flags & IPC_MUX_FLAG_LAST) && !l->rx_active) {
+            // Single-chunk message: hand out the receive buffer itself
+            if (dlen != total) {
+                errno = EPROTO;
+                break;
+            }
+            if (total > mux->max_msg) {
+                *lane = id;
+                errno = EMSGSIZE;
+                break;
+            }
+            *lane = id;
+            *msg = data;
+            *len = dlen;
+            ret = IPC_SUCCESS;
+            break;
+        }
+
+        if (flags & IPC_MUX_FLAG_FIRST) {
+            if (l->rx_active) {
+                l->rx_active = 0;
+                errno = EPROTO;
+                break;
+            }
+            l->rx_active = 1;
+            l->rx_len = 0;
+            l->rx_total = total;
+            l->rx_discard = total > mux->max_msg;
+            if (!l->rx_discard && l->rx_cap < total) {
+                unsigned char *buf = (unsigned char *)realloc(l->rx_buf, total);
+                if (!buf) {
+                    l->rx_active = 0;
+                    break;
+                }
+                l->rx_buf = buf;
+                l->rx_cap = total;
+            }
+        } else if (!l->rx_active) {
+            errno = EPROTO;
+            break;
+        }
+
+        if (l->rx_len + dlen > l->rx_total) {
+            l->rx_active = 0;
+            errno = EPROTO;
+            break;
+        }
+        if (!l->rx_discard && dlen) {
+            memcpy(l->rx_buf + l->rx_len, data, dlen);
+        }
+        l->rx_len += dlen;
+
+        if (flags & IPC_MUX_FLAG_LAST) {
+            l->rx_active = 0;
+            *lane = id;
+            if (l->rx_len != l->rx_total) {
+                errno = EPROTO;
+                break;
+            }
+            if (l->rx_discard) {
+                errno = EMSGSIZE;
+                break;
+            }
+            *msg = l->rx_buf;
+            *len = l->rx_len;
+            ret = IPC_SUCCESS;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&mux->rx_lock);
+
+    return ret;
+}
@@ -0,0 +1,234 @@
+/**
+ * @file ipc_perf.c
+ * author Animesh0817 (mailtome.anni@gmail.com)
+ * @brief Implementation of the perf_event_open() counters.
+ */
+
+#include "ipc_perf.h"
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+
+struct ipc_perf {
+    int fd[IPC_PERF_COUNTERS]; /**< Event descriptors, -1 if unavailable. */
+    uint64_t start_ns; /**< CLOCK_MONOTONIC time of ipc_perf_start(). */
+};
+
+static const char *ipc_perf_names[IPC_PERF_COUNTERS] = {
+    "cycles",
+    "instructions",
+    "cache-misses",
+    "context-switches",
+    "syscalls",
+};
+
+/**
+ * @brief Look up the tracepoint id of raw_syscalls:sys_enter in tracefs.
+ *
+ * @return The tracepoint id, or -1 if tracefs is not available.
+ */
+static long long ipc_perf_syscall_tracepoint(void) {
+    static const char *paths[] = {
+        "/sys/kernel/tracing/events/raw_syscalls/sys_enter/id",
+        "/sys/kernel/debug/tracing/events/raw_syscalls/sys_enter/id",
+    };
+
+    for (size_t i = 0; i < sizeof(paths) / sizeof(paths[0]); i++) {
+        FILE *f = fopen(paths[i], "r");
+        long long id;
+        if (!f) {
+            continue;
+        }
+        int ok = fscanf(f, "%lld", &id) == 1;
+        fclose(f);
+        if (ok) {
+            return id;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Open one counter for the calling thread.
+ *
+ * Kernel-side events are included when perf_event_paranoid allows it, since
+ * IPC spends much of its time in system calls; otherwise only user space is
+ * counted.
+ *
+ * @param type perf event type.
+ * @param config perf event config.
+ * @param inherit Also count threads created after the counter is opened.
+ * @return The event descriptor, or -1 on failure.
+ */
+static int ipc_perf_open_event(uint32_t type, uint64_t config, int inherit) {
+    struct perf_event_attr attr;
+
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = 1;
+    attr.inherit = inherit ? 1 : 0;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+    int fd = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, PERF_FLAG_FD_CLOEXEC);
+    if (fd == -1 && (errno == EACCES || errno == EPERM) && type != PERF_TYPE_TRACEPOINT) {
+        attr.exclude_kernel = 1;
+        fd = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, PERF_FLAG_FD_CLOEXEC);
+    }
+    return fd;
+}
+
+/**
+ * @brief Current CLOCK_MONOTONIC time in nanoseconds.
+ */
+static uint64_t ipc_perf_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief Open the counters for the calling thread.
+ *
+ * @param inherit If non-zero, threads the caller creates afterwards are
+ *        counted too, e.g. the peer thread of an in-process benchmark.
+ * @return Pointer to the counters, or NULL if none could be opened (errno is
+ *         that of the last failed perf_event_open()).
+ */
+ipc_perf_t *ipc_perf_open(int inherit) {
+    ipc_perf_t *perf = (ipc_perf_t *)calloc(1, sizeof(ipc_perf_t));
+    if (!perf) {
+        return NULL;
+    }
+
+    long long tracepoint = ipc_perf_syscall_tracepoint();
+    perf->fd[IPC_PERF_CYCLES] = ipc_perf_open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES, inherit);
+    perf->fd[IPC_PERF_INSTRUCTIONS] = ipc_perf_open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS, inherit);
+    perf->fd[IPC_PERF_CACHE_MISSES] = ipc_perf_open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES, inherit);
+    perf->fd[IPC_PERF_CONTEXT_SWITCHES] = ipc_perf_open_event(PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES, inherit);
+    perf->fd[IPC_PERF_SYSCALLS] = tracepoint < 0 ? -1
+        : ipc_perf_open_event(PERF_TYPE_TRACEPOINT, (uint64_t)tracepoint, inherit);
+
+    if (ipc_perf_available(perf) == 0) {
+        int err = errno;
+        free(perf);
+        errno = err;
+        return NULL;
+    }
+    return perf;
+}
+
+/**
+ * @brief Reset the counters and start counting.
+ *
+ * @param perf Pointer to the counters.
+ * @return IPC_SUCCESS on success, IPC_FAILURE on failure.
+ */
+int ipc_perf_start(ipc_perf_t *perf) {
+    if (!perf) {
+        errno = EINVAL;
+        return IPC_FAILURE;
+    }
+    for (int i = 0; i < IPC_PERF_COUNTERS; i++) {
+        if (perf->fd[i] != -1 &&
+            (ioctl(perf->fd[i], PERF_EVENT_IOC_RESET, 0) == -1 ||
+             ioctl(perf->fd[i], PERF_EVENT_IOC_ENABLE, 0) == -1)) {
+            return IPC_FAILURE;
+        }
+    }
+    perf->start_ns = ipc_perf_now_ns();
+    return IPC_SUCCESS;
+}
+
+/**
+ * @brief Stop counting and read the counters.
+ *
+ * When more events are open than the PMU has registers, the kernel time-shares
+ * them; such counts are scaled up to the full interval. A counter that never
+ * got scheduled is reported as invalid.
+ *
+ * @param perf Pointer to the counters.
+ * @param sample Receives the counts since ipc_perf_start().
+ * @return IPC_SUCCESS on success, IPC_FAILURE on failure.
+ */
+int ipc_perf_stop(ipc_perf_t *perf, ipc_perf_sample_t *sample) {
+    if (!perf || !sample) {
+        errno = EINVAL;
+        return IPC_FAILURE;
+    }
+    uint64_t end_ns = ipc_perf_now_ns();
+
+    memset(sample, 0, sizeof(*sample));
+    sample->elapsed_ns = end_ns - perf->start_ns;
+    for (int i = 0; i < IPC_PERF_COUNTERS; i++) {
+        uint64_t data[3]; // value, time enabled, time running
+        if (perf->fd[i] == -1) {
+            continue;
+        }
+        if (ioctl(perf->fd[i], PERF_EVENT_IOC_DISABLE, 0) == -1 ||
+            read(perf->fd[i], data, sizeof(data)) != (ssize_t)sizeof(data)) {
+            return IPC_FAILURE;
+        }
+        if (data[2] == 0) {
+            continue;
+        }
+        sample->value[i] = data[2] < data[1] ? (uint64_t)((double)data[0] * data[1] / data[2]) : data[0];
+        sample->valid |= 1u << i;
+    }
+    return IPC_SUCCESS;
+}
+
+/**
+ * @brief Get the counters that could be opened.
+ *
+ * @param perf Pointer to the counters.
+ * @return Bit (1u << counter) is set for each available counter.
+ */
+uint32_t ipc_perf_available(const ipc_perf_t *perf) {
+    uint32_t mask = 0;
+
+    for (int i = 0; perf && i < IPC_PERF_COUNTERS; i++) {
+        if (perf->fd[i] != -1) {
+            mask |= 1u << i;
+        }
+    }
+    return mask;
+}
+
+/**
+ * @brief Get the printable name of a counter.
+ *
+ * @param counter The counter.
+ * @return Its name, e.g. "cache-misses", or "unknown".
+ */
+const char *ipc_perf_counter_name(ipc_perf_counter_t counter) {
+    if ((unsigned)counter >= IPC_PERF_COUNTERS) {
+        return "unknown";
+    }
+    return ipc_perf_names[counter];
+}
+
+/**
+ * @brief Close the counters.
+ *
+ * @param perf Pointer to the counters.
+ */
+void ipc_perf_close(ipc_perf_t *perf) {
+    if (!perf) {
+        return;
+    }
+    for (int i = 0; i < IPC_PERF_COUNTERS; i++) {
+        if (perf->fd[i] != -1) {
+            close(perf->fd[i]);
+        }
+    }
+    free(perf);
+}
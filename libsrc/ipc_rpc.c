@@ -0,0 +1,436 @@
+/**
+ * @file ipc_rpc.c
+ * author Animesh0817 (mailtome.anni@gmail.com)
+ * @brief Implementation of the request/response RPC layer.
+ *
+ * Wire format of the RPC header that precedes each payload (network byte order):
+ * @code
+ * +--------+--------+----------+--------------+------------------------+
+ * | kind   | status | reserved | method (u32) | correlation ID (u64)   |
+ * | (u8)   | (u8)   | (u16)    |              |                        |
+ * +--------+--------+----------+--------------+------------------------+
+ * @endcode
+ */
+
+#include "ipc_rpc.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <endian.h>
+#include <errno.h>
+
+#define IPC_RPC_KIND_REQUEST 1
+#define IPC_RPC_KIND_RESPONSE 2
+
+/**
+ * A Structure that will hold the following:
+ * Correlation ID of the outstanding call (0 when the slot is free)
+ * Completion callback and its user pointer
+ */
+typedef struct {
+    uint64_t id; /**< Correlation ID, 0 when the slot is free. */
+    ipc_rpc_callback_t cb; /**< Completion callback. */
+    void *user; /**< User pointer passed to cb. */
+} ipc_rpc_pending_t;
+
+/**
+ * A Structure that will hold the following:
+ * Handler registered for a method ID and its user pointer
+ */
+typedef struct {
+    ipc_rpc_handler_t fn; /**< Request handler. */
+    void *user; /**< User pointer passed to fn. */
+} ipc_rpc_method_t;
+
+/**
+ * A Structure that will hold the state of a blocking ipc_rpc_call().
+ */
+typedef struct {
+    void *resp; /**< Caller's response buffer. */
+    size_t cap; /**< Capacity of resp. */
+    size_t len; /**< Length of the received response. */
+    int status; /**< Status of the response. */
+    int done; /**< Set once the response has been delivered. */
+} ipc_rpc_sync_t;
+
+struct ipc_rpc {
+    ipc_handle_t *handle; /**< Message-oriented transport. */
+    size_t max_msg; /**< Largest payload carried by a request or response. */
+    unsigned char *tx_buf; /**< Scratch buffer for outgoing messages, guarded by tx_lock. */
+    unsigned char *rx_buf; /**< Scratch buffer for incoming messages, guarded by rx_lock. */
+    pthread_mutex_t tx_lock; /**< Serializes sends on the handle. */
+    pthread_mutex_t rx_lock; /**< Admits one receiver at a time. */
+    pthread_mutex_t lock; /**< Guards the pending table and next_id. */
+    ipc_rpc_method_t methods[IPC_RPC_MAX_METHODS]; /**< Dispatch table. */
+    ipc_rpc_pending_t *pending; /**< Outstanding calls, indexed by id & pending_mask. */
+    size_t pending_mask; /**< Size of the pending table minus one. */
+    size_t inflight; /**< Number of outstanding calls. */
+    uint64_t next_id; /**< Next correlation ID to hand out. */
+};
+
+/**
+ * @brief Encode a header and payload into the transmit buffer and send it.
+ *
+ * @return IPC_SUCCESS on success, IPC_FAILURE on failure.
+ */
+static int ipc_rpc_send_msg(ipc_rpc_t *rpc, int kind, int status, uint32_t method,
+                            uint64_t id, const void *payload, size_t len) {
+    uint32_t method_be = htobe32(method);
+    uint64_t id_be = htobe64(id);
+    int ret;
+
+    if (len > rpc->max_msg) {
+        errno = EMSGSIZE;
+        return IPC_FAILURE;
+    }
+
+    pthread_mutex_lock(&rpc->tx_lock);
+    rpc->tx_buf[0] = (unsigned char)kind;
+    rpc->tx_buf[1] = (unsigned char)status;
+    rpc->tx_buf[2] = 0;
+    rpc->tx_buf[3] = 0;
+    memcpy(rpc->tx_buf + 4, &method_be, sizeof(method_be));
+    memcpy(rpc->tx_buf + 8, &id_be, sizeof(id_be));
+    if (len) {
+        memcpy(rpc->tx_buf + IPC_RPC_HDR_SIZE, payload, len);
+    }
+    ret = rpc->handle->send(rpc->handle, rpc->tx_buf, IPC_RPC_HDR_SIZE + len);
+    pthread_mutex_unlock(&rpc->tx_lock);
+
+    return ret < 0 ? IPC_FAILURE : IPC_SUCCESS;
+}
+
+/**
+ * @brief Remove an outstanding call from the pending table.
+ *
+ * @return The removed entry; its id is 0 if no call with this ID was pending.
+ */
+static ipc_rpc_pending_t ipc_rpc_take_pending(ipc_rpc_t *rpc, uint64_t id) {
+    ipc_rpc_pending_t entry = {0};
+
+    pthread_mutex_lock(&rpc->lock);
+    ipc_rpc_pending_t *slot = &rpc->pending[id & rpc->pending_mask];
+    if (id != 0 && slot->id == id) {
+        entry = *slot;
+        slot->id = 0;
+        rpc->inflight--;
+    }
+    pthread_mutex_unlock(&rpc->lock);
+
+    return entry;
+}
+
+/**
+ * @brief Completion callback used by ipc_rpc_call().
+ */
+static void ipc_rpc_sync_done(ipc_rpc_t *rpc, int status, const void *resp, size_t len, void *user) {
+    ipc_rpc_sync_t *sync = (ipc_rpc_sync_t *)user;
+    (void)rpc;
+
+    if (status == IPC_RPC_OK && len > sync->cap) {
+        status = IPC_RPC_ERR_TOO_LARGE;
+        len = 0;
+    }
+    if (len) {
+        memcpy(sync->resp, resp, len);
+    }
+    sync->len = len;
+    sync->status = status;
+    sync->done = 1;
+}
+
+/**
+ * @brief Receive and dispatch one message. Must be called with rx_lock held.
+ *
+ * @return IPC_SUCCESS on success, IPC_FAILURE on failure.
+ */
+static int ipc_rpc_poll_locked(ipc_rpc_t *rpc) {
+    uint32_t method;
+    uint64_t id;
+    int len;
+
+    len = rpc->handle->receive(rpc->handle, rpc->rx_buf, IPC_RPC_HDR_SIZE + rpc->max_msg);
+    if (len < IPC_RPC_HDR_SIZE) {
+        if (len >= 0) {
+            errno = EPROTO;
+        }
+        return IPC_FAILURE;
+    }
+
+    memcpy(&method, rpc->rx_buf + 4, sizeof(method));
+    memcpy(&id, rpc->rx_buf + 8, sizeof(id));
+    method = be32toh(method);
+    id = be64toh(id);
+    const unsigned char *payload = rpc->rx_buf + IPC_RPC_HDR_SIZE;
+    size_t payload_len = (size_t)len - IPC_RPC_HDR_SIZE;
+
+    if (rpc->rx_buf[0] == IPC_RPC_KIND_RESPONSE) {
+        ipc_rpc_pending_t entry = ipc_rpc_take_pending(rpc, id);
+        if (entry.id != 0 && entry.cb) {
+            entry.cb(rpc, rpc->rx_buf[1], payload, payload_len, entry.user);
+        }
+        return IPC_SUCCESS;
+    }
+
+    if (rpc->rx_buf[0] != IPC_RPC_KIND_REQUEST) {
+        errno = EPROTO;
+        return IPC_FAILURE;
+    }
+
+    if (method >= IPC_RPC_MAX_METHODS || !rpc->methods[method].fn) {
+        return ipc_rpc_respond(rpc, id, IPC_RPC_ERR_NO_METHOD, NULL, 0);
+    }
+    if (rpc->methods[method].fn(rpc, id, payload, payload_len, rpc->methods[method].user) != IPC_SUCCESS) {
+        return ipc_rpc_respond(rpc, id, IPC_RPC_ERR_HANDLER, NULL, 0);
+    }
+    return IPC_SUCCESS;
+}
+
+/**
+ * @brief Create an RPC endpoint on top of an IPC handle.
+ *
+ * The handle is not owned by the endpoint and must outlive it.
+ *
+ * @param handle Message-oriented IPC handle (e.g. a framed socket).
+ * @param max_msg Largest request or response payload in bytes.
+ * @param max_inflight Maximum number of outstanding calls; rounded up to a power of two.
+ * @return Pointer to the RPC endpoint, or NULL on failure.
+ */
+ipc_rpc_t *ipc_rpc_create(ipc_handle_t *handle, size_t max_msg, size_t max_inflight) {
+    size_t slots = 1;
+
+    if (!handle || !handle->send || !handle->receive || max_inflight == 0) {
+        errno = EINVAL;
+        return NULL;
+    }
+    while (slots < max_inflight) {
+        slots <<= 1;
+    }
+
+    ipc_rpc_t *rpc = (ipc_rpc_t *)calloc(1, sizeof(ipc_rpc_t));
+    if (!rpc) {
+        return NULL;
+    }
+    rpc->handle = handle;
+    rpc->max_msg = max_msg;
+    rpc->pending_mask = slots - 1;
+    rpc->next_id = 1;
+    rpc->tx_buf = (unsigned char *)malloc(IPC_RPC_HDR_SIZE + max_msg);
+    rpc->rx_buf = (unsigned char *)malloc(IPC_RPC_HDR_SIZE + max_msg);
+    rpc->pending = (ipc_rpc_pending_t *)calloc(slots, sizeof(ipc_rpc_pending_t));
+    if (!rpc->tx_buf || !rpc->rx_buf || !rpc->pending) {
+        free(rpc->tx_buf);
+        free(rpc->rx_buf);
+        free(rpc->pending);
+        free(rpc);
+        return NULL;
+    }
+    pthread_mutex_init(&rpc->tx_lock, NULL);
+    pthread_mutex_init(&rpc->rx_lock, NULL);
+    pthread_mutex_init(&rpc->lock, NULL);
+
+    return rpc;
+}
+
+/**
+ * @brief Destroy an RPC endpoint.
+ *
+ * Outstanding calls complete with IPC_RPC_ERR_TRANSPORT. The underlying
+ * handle is left open.
+ *
+ * @param rpc RPC endpoint.
+ */
+void ipc_rpc_destroy(ipc_rpc_t *rpc) {
+    if (!rpc) {
+        return;
+    }
+    for (size_t i = 0; i <= rpc->pending_mask; i++) {
+        ipc_rpc_pending_t entry = rpc->pending[i];
+        if (entry.id != 0 && entry.cb) {
+            entry.cb(rpc, IPC_RPC_ERR_TRANSPORT, NULL, 0, entry.user);
+        }
+    }
+    pthread_mutex_destroy(&rpc->tx_lock);
+    pthread_mutex_destroy(&rpc->rx_lock);
+    pthread_mutex_destroy(&rpc->lock);
+    free(rpc->tx_buf);
+    free(rpc->rx_buf);
+    free(rpc->pending);
+    free(rpc);
+}
+
+/**
+ * @brief Register the handler for a method ID.
+ *
+ * @param rpc RPC endpoint.
+ * @param method Method ID, below IPC_RPC_MAX_METHODS.
+ * @param handler Handler, or NULL to unregister.
+ * @param user User pointer passed to the handler.
+ * @return IPC_SUCCESS on success, IPC_FAILURE on failure.
+ */
+int ipc_rpc_register(ipc_rpc_t *rpc, uint32_t method, ipc_rpc_handler_t handler, void *user) {
+    if (!rpc || method >= IPC_RPC_MAX_METHODS) {
+        errno = EINVAL;
+        return IPC_FAILURE;
+    }
+    rpc->methods[method].fn = handler;
+    rpc->methods[method].user = user;
+    return IPC_SUCCESS;
+}
+
+/**
+ * @brief Issue a request without waiting for its response.
+ *
+ * The callback runs from whichever thread receives the response through
+ * ipc_rpc_poll() or ipc_rpc_call().
+ *
+ * @param rpc RPC endpoint.
+ * @param method Method ID.
+ * @param req Request payload.
+ * @param len Length of the request payload.
+ * @param cb Completion callback, may be NULL.
+ * @param user User pointer passed to cb.
+ * @param id If not NULL, receives the correlation ID of the call.
+ * @return IPC_SUCCESS on success, IPC_FAILURE on failure (errno EAGAIN when
+ *         max_inflight calls are already outstanding).
+ */
+int ipc_rpc_call_async(ipc_rpc_t *rpc, uint32_t method, const void *req, size_t len,
+                       ipc_rpc_callback_t cb, void *user, uint64_t *id) {
+    uint64_t call_id;
+
+    if (!rpc) {
+        errno = EINVAL;
+        return IPC_FAILURE;
+    }
+
+    pthread_mutex_lock(&rpc->lock);
+    if (rpc->inflight > rpc->pending_mask) {
+        pthread_mutex_unlock(&rpc->lock);
+        errno = EAGAIN;
+        return IPC_FAILURE;
+    }
+    // Skip IDs whose slot still holds a slow call; a free slot exists since the table is not full
+    while (rpc->pending[rpc->next_id & rpc->pending_mask].id != 0 || rpc->next_id == 0) {
+        rpc->next_id++;
+    }
+    call_id = rpc->next_id++;
+    ipc_rpc_pending_t *slot = &rpc->pending[call_id & rpc->pending_mask];
+    slot->id = call_id;
+    slot->cb = cb;
+    slot->user = user;
+    rpc->inflight++;
+    pthread_mutex_unlock(&rpc->lock);
+
+    if (id) {
+        *id = call_id;
+    }
+    if (ipc_rpc_send_msg(rpc, IPC_RPC_KIND_REQUEST, 0, method, call_id, req, len) != IPC_SUCCESS) {
+        ipc_rpc_take_pending(rpc, call_id);
+        return IPC_FAILURE;
+    }
+    return IPC_SUCCESS;
+}
+
+/**
+ * @brief Issue a request and wait for its response.
+ *
+ * While waiting, the calling thread takes its turn receiving and dispatches
+ * whatever arrives, including other callers' responses and incoming requests.
+ * Must not be called from a request handler or completion callback.
+ *
+ * @param rpc RPC endpoint.
+ * @param method Method ID.
+ * @param req Request payload.
+ * @param len Length of the request payload.
+ * @param resp Buffer for the response payload.
+ * @param cap Capacity of resp.
+ * @param resp_len If not NULL, receives the response length.
+ * @return The ipc_rpc_status_t of the response, or IPC_FAILURE if the request
+ *         could not be sent or the connection failed.
+ */
+int ipc_rpc_call(ipc_rpc_t *rpc, uint32_t method, const void *req, size_t len,
+                 void *resp, size_t cap, size_t *resp_len) {
+    ipc_rpc_sync_t sync = { .resp = resp, .cap = cap };
+    uint64_t id;
+    int ret = IPC_SUCCESS;
+
+    if (ipc_rpc_call_async(rpc, method, req, len, ipc_rpc_sync_done, &sync, &id) != IPC_SUCCESS) {
+        return IPC_FAILURE;
+    }
+
+    for (;;) {
+        pthread_mutex_lock(&rpc->rx_lock);
+        if (sync.done) {
+            pthread_mutex_unlock(&rpc->rx_lock);
+            break;
+        }
+        ret = ipc_rpc_poll_locked(rpc);
+        pthread_mutex_unlock(&rpc->rx_lock);
+        if (ret != IPC_SUCCESS && errno != EMSGSIZE) {
+            ipc_rpc_take_pending(rpc, id);
+            return IPC_FAILURE;
+        }
+    }
+
+    if (resp_len) {
+        *resp_len = sync.len;
+    }
+    return sync.status;
+}
+
+/**
+ * @brief Send the response for a request.
+ *
+ * May be called from the handler or later from any thread.
+ *
+ * @param rpc RPC endpoint.
+ * @param id Correlation ID passed to the handler.
+ * @param status ipc_rpc_status_t to report to the caller.
+ * @param resp Response payload.
+ * @param len Length of the response payload.
+ * @return IPC_SUCCESS on success, IPC_FAILURE on failure.
+ */
+int ipc_rpc_respond(ipc_rpc_t *rpc, uint64_t id, int status, const void *resp, size_t len) {
+    if (!rpc) {
+        errno = EINVAL;
+        return IPC_FAILURE;
+    }
+    return ipc_rpc_send_msg(rpc, IPC_RPC_KIND_RESPONSE, status, 0, id, resp, len);
+}
+
+/**
+ * @brief Receive one message and dispatch it.
+ *
+ * Requests are passed to their handler; responses complete the matching
+ * outstanding call. Blocks while the underlying handle blocks.
+ *
+ * @param rpc RPC endpoint.
+ * @return IPC_SUCCESS on success, IPC_FAILURE on failure.
+ */
+int ipc_rpc_poll(ipc_rpc_t *rpc) {
+    int ret;
+
+    if (!rpc) {
+        errno = EINVAL;
+        return IPC_FAILURE;
+    }
+    pthread_mutex_lock(&rpc->rx_lock);
+    ret = ipc_rpc_poll_locked(rpc);
+    pthread_mutex_unlock(&rpc->rx_lock);
+    return ret;
+}
+
+/**
+ * @brief Get the number of outstanding calls.
+ *
+ * @param rpc RPC endpoint.
+ * @return Number of calls still waiting for a response.
+ */
+size_t ipc_rpc_pending(ipc_rpc_t *rpc) {
+    size_t n;
+
+    pthread_mutex_lock(&rpc->lock);
+    n = rpc->inflight;
+    pthread_mutex_unlock(&rpc->lock);
+    return n;
+}
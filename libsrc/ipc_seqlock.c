@@ -0,0 +1,429 @@
+/**
+ * @file ipc_seqlock.c
+ * author Animesh0817 (mailtome.anni@gmail.com)
+ * @brief Implementation of the seqlock-protected latest-value channel.
+ */
+
+#include "ipc_seqlock.h"
+#include "ipc_crc32c.h"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <stdatomic.h>
+#include <stdalign.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include <errno.h>
+
+#define IPC_SEQLOCK_MAGIC 0x4950534bu /* "IPSK" */
+#define IPC_SEQLOCK_VERSION 2u
+
+#define IPC_SEQLOCK_CRC 1u /**< crc holds the CRC32C of the current value. */
+
+/**
+ * A Structure that will hold the layout of the segment:
+ * Header identifying the segment and the slot capacity
+ * Sequence counter, odd while a write is in progress
+ * Words used to wake blocked readers
+ * The value slot
+ */
+struct ipc_seqlock_shm {
+    uint32_t magic; /**< IPC_SEQLOCK_MAGIC once the segment is initialized. */
+    uint32_t version; /**< Layout version. */
+    uint64_t capacity; /**< Size of the value slot. */
+    alignas(64) atomic_uint_fast64_t seq; /**< Twice the number of published values, plus one during a write. */
+    uint64_t len; /**< Length of the current value, guarded by seq. */
+    uint32_t crc; /**< CRC32C of the current value, guarded by seq. */
+    uint32_t flags; /**< IPC_SEQLOCK_CRC if crc is set, guarded by seq. */
+    alignas(64) atomic_uint signal; /**< Futex word bumped when readers must wake. */
+    atomic_uint waiters; /**< Readers blocked on signal. */
+    atomic_uint parked; /**< Doorbell parked word. */
+    alignas(64) unsigned char data[]; /**< Value slot, guarded by seq. */
+};
+
+/**
+ * @brief Map and validate (or, for the owner, initialize) the segment.
+ *
+ * @param handle Pointer to the IPC seqlock handle.
+ * @return IPC_SUCCESS on success, IPC_FAILURE on failure.
+ */
+static int ipc_seqlock_init(ipc_handle_t *handle) {
+    ipc_seqlock_t *chan = (ipc_seqlock_t *)handle;
+    struct stat st;
+    int fd;
+
+    if (chan->is_owner) {
+        fd = shm_open(chan->name, O_CREAT | O_RDWR | O_CLOEXEC, 0644);
+        chan->map_size = sizeof(struct ipc_seqlock_shm) + chan->capacity;
+    } else {
+        fd = shm_open(chan->name, O_RDWR | O_CLOEXEC, 0);
+    }
+    if (fd == -1) {
+        return IPC_FAILURE;
+    }
+    if (chan->is_owner) {
+        if (ftruncate(fd, 0) == -1 || ftruncate(fd, (off_t)chan->map_size) == -1) {
+            close(fd);
+            return IPC_FAILURE;
+        }
+    } else {
+        if (fstat(fd, &st) == -1 || (size_t)st.st_size < sizeof(struct ipc_seqlock_shm)) {
+            close(fd);
+            errno = EPROTO;
+            return IPC_FAILURE;
+        }
+        chan->map_size = (size_t)st.st_size;
+    }
+    void *map = mmap(NULL, chan->map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        return IPC_FAILURE;
+    }
+    chan->shm = (struct ipc_seqlock_shm *)map;
+
+    if (chan->is_owner) {
+        chan->shm->version = IPC_SEQLOCK_VERSION;
+        chan->shm->capacity = chan->capacity;
+        atomic_init(&chan->shm->seq, 0);
+        atomic_thread_fence(memory_order_release);
+        chan->shm->magic = IPC_SEQLOCK_MAGIC;
+        if (ipc_doorbell_open(&chan->doorbell, &chan->shm->parked) != IPC_SUCCESS) {
+            munmap(map, chan->map_size);
+            chan->shm = NULL;
+            return IPC_FAILURE;
+        }
+        return IPC_SUCCESS;
+    }
+
+    if (chan->shm->magic != IPC_SEQLOCK_MAGIC || chan->shm->version != IPC_SEQLOCK_VERSION ||
+        sizeof(struct ipc_seqlock_shm) + chan->shm->capacity > chan->map_size) {
+        munmap(map, chan->map_size);
+        chan->shm = NULL;
+        errno = EPROTO;
+        return IPC_FAILURE;
+    }
+    atomic_thread_fence(memory_order_acquire);
+    chan->capacity = chan->shm->capacity;
+    chan->doorbell.parked = &chan->shm->parked;
+    return IPC_SUCCESS;
+}
+
+/**
+ * @brief Publish a new value, replacing the current one.
+ *
+ * Never waits for readers. Concurrent writers are serialized by the sequence
+ * counter itself.
+ *
+ * @param handle Pointer to the IPC seqlock handle.
+ * @param data Value.
+ * @param size Length of the value, at most the capacity.
+ * @return IPC_SUCCESS on success, IPC_FAILURE on failure (errno EMSGSIZE if too large).
+ */
+static int ipc_seqlock_send(ipc_handle_t *handle, const void *data, size_t size) {
+    ipc_seqlock_t *chan = (ipc_seqlock_t *)handle;
+
+    if (!chan->shm) {
+        errno = EINVAL;
+        return IPC_FAILURE;
+    }
+    if (size > chan->capacity) {
+        errno = EMSGSIZE;
+        return IPC_FAILURE;
+    }
+    struct ipc_seqlock_shm *shm = chan->shm;
+    // Checksum outside the write section so readers are not held up
+    uint32_t crc = chan->checksum ? ipc_crc32c(0, data, size) : 0;
+
+    uint64_t seq = ipc_seqcount_write_begin(&shm->seq);
+    shm->len = size;
+    shm->crc = crc;
+    shm->flags = chan->checksum ? IPC_SEQLOCK_CRC : 0;
+    memcpy(shm->data, data, size);
+    ipc_seqcount_write_end(&shm->seq, seq);
+
+    // Wake-ups cost a syscall only while a reader is blocked
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load_explicit(&shm->waiters, memory_order_relaxed)) {
+        atomic_fetch_add_explicit(&shm->signal, 1, memory_order_release);
+        ipc_futex_wake(&shm->signal, INT_MAX);
+    }
+    if (chan->doorbell.efd >= 0) {
+        ipc_doorbell_ring(&chan->doorbell);
+    }
+    return IPC_SUCCESS;
+}
+
+/**
+ * @brief Copy a consistent snapshot of the current value without blocking.
+ *
+ * @param handle Pointer to the IPC seqlock handle.
+ * @param buffer Destination buffer.
+ * @param size Capacity of buffer.
+ * @param version If not NULL, receives the version of the value (1 for the first value published).
+ * @return Length of the value on success, IPC_FAILURE on failure (errno
+ *         EAGAIN if nothing was published yet, EMSGSIZE if buffer is too small,
+ *         EBADMSG when checksums are on and the value is corrupt, EBUSY if no
+ *         consistent copy could be taken, e.g. because a writer died mid-write).
+ */
+int ipc_seqlock_read(ipc_handle_t *handle, void *buffer, size_t size, uint64_t *version) {
+    ipc_seqlock_t *chan = (ipc_seqlock_t *)handle;
+
+    if (!chan || !chan->shm || (!buffer && size)) {
+        errno = EINVAL;
+        return IPC_FAILURE;
+    }
+    struct ipc_seqlock_shm *shm = chan->shm;
+
+    for (int tries = 0; tries < IPC_SEQCOUNT_READ_RETRIES; tries++) {
+        uint64_t before;
+        if (ipc_seqcount_read_begin(&shm->seq, &before) != IPC_SUCCESS) {
+            continue; // Write in progress
+        }
+        if (before == 0) {
+            errno = EAGAIN;
+            return IPC_FAILURE;
+        }
+        size_t len = shm->len;
+        uint32_t crc = shm->crc;
+        uint32_t flags = shm->flags;
+        size_t copy = len <= size && len <= chan->capacity ? len : 0;
+        memcpy(buffer, shm->data, copy);
+        if (ipc_seqcount_read_end(&shm->seq, before) != IPC_SUCCESS) {
+            continue; // Overwritten while copying
+        }
+        if (version) {
+            *version = before / 2;
+        }
+        if (len > size) {
+            errno = EMSGSIZE;
+            return IPC_FAILURE;
+        }
+        // Verify the private copy: the slot may be rewritten meanwhile
+        if ((flags & IPC_SEQLOCK_CRC) && chan->checksum && crc != ipc_crc32c(0, buffer, len)) {
+            errno = EBADMSG;
+            return IPC_FAILURE;
+        }
+        return (int)len;
+    }
+    errno = EBUSY;
+    return IPC_FAILURE;
+}
+
+/**
+ * @brief Get the version of the current value.
+ *
+ * @param handle Pointer to the IPC seqlock handle.
+ * @return Number of values published so far, or 0 if the handle is not initialized.
+ */
+uint64_t ipc_seqlock_version(ipc_handle_t *handle) {
+    ipc_seqlock_t *chan = (ipc_seqlock_t *)handle;
+
+    if (!chan || !chan->shm) {
+        return 0;
+    }
+    return atomic_load_explicit(&chan->shm->seq, memory_order_acquire) / 2;
+}
+
+/**
+ * @brief Block until a value newer than a given version is published.
+ *
+ * A call that finds no newer value arms the doorbell, so an event loop can
+ * call it with timeout_ms 0 and then wait for get_fd() to become readable.
+ *
+ * @param handle Pointer to the IPC seqlock handle.
+ * @param version Version already seen.
+ * @param timeout_ms Timeout in milliseconds, or -1 to wait forever.
+ * @return IPC_SUCCESS once a newer value exists, IPC_FAILURE on timeout
+ *         (errno ETIMEDOUT) or error.
+ */
+int ipc_seqlock_wait(ipc_handle_t *handle, uint64_t version, int timeout_ms) {
+    ipc_seqlock_t *chan = (ipc_seqlock_t *)handle;
+    struct timespec ts;
+
+    if (!chan || !chan->shm) {
+        errno = EINVAL;
+        return IPC_FAILURE;
+    }
+    struct ipc_seqlock_shm *shm = chan->shm;
+    const struct timespec *deadline = ipc_futex_deadline(&ts, timeout_ms);
+
+    for (;;) {
+        // A write in progress (odd counter) already means a newer value is coming
+        if ((atomic_load_explicit(&shm->seq, memory_order_acquire) + 1) / 2 > version) {
+            if (chan->doorbell.efd >= 0 && atomic_load_explicit(chan->doorbell.parked, memory_order_relaxed)) {
+                ipc_doorbell_unpark(&chan->doorbell);
+            }
+            return IPC_SUCCESS;
+        }
+        if (chan->doorbell.efd >= 0 && !atomic_load_explicit(chan->doorbell.parked, memory_order_relaxed)) {
+            // Arm the doorbell so a poller on get_fd() wakes for the next value
+            ipc_doorbell_park(&chan->doorbell);
+            continue;
+        }
+        if (timeout_ms == 0) {
+            errno = ETIMEDOUT;
+            return IPC_FAILURE;
+        }
+        atomic_fetch_add(&shm->waiters, 1);
+        unsigned int seen = atomic_load(&shm->signal);
+        int ret = IPC_SUCCESS;
+        if ((atomic_load(&shm->seq) + 1) / 2 <= version) {
+            ret = ipc_futex_wait(&shm->signal, seen, deadline);
+        }
+        atomic_fetch_sub(&shm->waiters, 1);
+        if (ret != IPC_SUCCESS && errno == ETIMEDOUT) {
+            return IPC_FAILURE;
+        }
+    }
+}
+
+/**
+ * @brief Wait for a value newer than the last one received and copy it.
+ *
+ * Values published in between are skipped.
+ *
+ * @param handle Pointer to the IPC seqlock handle.
+ * @param buffer Destination buffer.
+ * @param size Capacity of buffer.
+ * @return Length of the value on success, IPC_FAILURE on failure.
+ */
+static int ipc_seqlock_receive(ipc_handle_t *handle, void *buffer, size_t size) {
+    ipc_seqlock_t *chan = (ipc_seqlock_t *)handle;
+    uint64_t version = chan->last_version;
+
+    if (!chan->shm) {
+        errno = EINVAL;
+        return IPC_FAILURE;
+    }
+    if (ipc_seqlock_wait(handle, chan->last_version, -1) != IPC_SUCCESS) {
+        return IPC_FAILURE;
+    }
+    int len = ipc_seqlock_read(handle, buffer, size, &version);
+    chan->last_version = version;
+    return len;
+}
+
+/**
+ * @brief Get the doorbell eventfd of the handle.
+ *
+ * @return The eventfd, or IPC_FAILURE (errno ENOTSUP) if this process has none.
+ */
+static int ipc_seqlock_get_fd(ipc_handle_t *handle) {
+    ipc_seqlock_t *chan = (ipc_seqlock_t *)handle;
+
+    if (chan->doorbell.efd < 0) {
+        errno = ENOTSUP;
+        return IPC_FAILURE;
+    }
+    return chan->doorbell.efd;
+}
+
+/**
+ * @brief Unmap the segment and free the handle. The segment stays until ipc_seqlock_unlink().
+ */
+static int ipc_seqlock_destroy(ipc_handle_t *handle) {
+    ipc_seqlock_t *chan = (ipc_seqlock_t *)handle;
+
+    ipc_doorbell_close(&chan->doorbell);
+    if (chan->shm) {
+        munmap(chan->shm, chan->map_size);
+    }
+    free(chan->name);
+    free(chan);
+    return IPC_SUCCESS;
+}
+
+/**
+ * @brief Create a new IPC seqlock handle.
+ *
+ * @param name POSIX shared-memory name, e.g. "/quotes".
+ * @param capacity Largest value in bytes; used by the owner only.
+ * @param is_owner Non-zero to create (or reset) the segment in init(), zero
+ *        to attach to a segment created by another process.
+ * @return Pointer to the created IPC seqlock handle, or NULL on failure.
+ */
+ipc_handle_t *ipc_seqlock_create(const char *name, size_t capacity, int is_owner) {
+    if (!name || (is_owner && capacity == 0)) {
+        errno = EINVAL;
+        return NULL;
+    }
+
+    ipc_seqlock_t *chan = (ipc_seqlock_t *)calloc(1, sizeof(ipc_seqlock_t));
+    if (!chan) {
+        return NULL;
+    }
+    chan->name = strdup(name);
+    if (!chan->name) {
+        free(chan);
+        return NULL;
+    }
+    chan->capacity = capacity;
+    chan->is_owner = is_owner;
+    chan->doorbell.efd = -1;
+
+    // Assign function pointers
+    chan->base.init = (int (*)(void *))ipc_seqlock_init;
+    chan->base.send = (int (*)(void *, const void *, size_t))ipc_seqlock_send;
+    chan->base.receive = (int (*)(void *, void *, size_t))ipc_seqlock_receive;
+    chan->base.destroy = (int (*)(void *))ipc_seqlock_destroy;
+    chan->base.accept = NULL;
+    chan->base.get_fd = (int (*)(void *))ipc_seqlock_get_fd;
+
+    return (ipc_handle_t *)chan;
+}
+
+/**
+ * @brief Remove a named seqlock segment.
+ *
+ * @param name POSIX shared-memory name.
+ * @return IPC_SUCCESS on success, IPC_FAILURE on failure.
+ */
+int ipc_seqlock_unlink(const char *name) {
+    return shm_unlink(name) == 0 ? IPC_SUCCESS : IPC_FAILURE;
+}
+
+/**
+ * @brief Use an eventfd received from the segment owner as doorbell.
+ *
+ * See ipc_slab_attach_doorbell(); the descriptor is not closed by the handle.
+ *
+ * @param handle Pointer to an initialized IPC seqlock handle.
+ * @param efd eventfd descriptor.
+ * @return IPC_SUCCESS on success, IPC_FAILURE on failure.
+ */
+int ipc_seqlock_attach_doorbell(ipc_handle_t *handle, int efd) {
+    ipc_seqlock_t *chan = (ipc_seqlock_t *)handle;
+
+    if (!chan || !chan->shm) {
+        errno = EINVAL;
+        return IPC_FAILURE;
+    }
+    ipc_doorbell_close(&chan->doorbell);
+    return ipc_doorbell_attach(&chan->doorbell, efd, &chan->shm->parked);
+}
+
+/**
+ * @brief Enable or disable CRC32C checksums on a seqlock handle.
+ *
+ * With checksums on, values published through this handle carry the CRC32C
+ * of their payload, computed before the slot is locked, and values read
+ * through it that carry one are verified after they are copied out. Values
+ * published without a checksum are read as before.
+ *
+ * @param handle Pointer to the IPC seqlock handle.
+ * @param enable Non-zero to compute and verify checksums, zero to skip them.
+ * @return IPC_SUCCESS on success, IPC_FAILURE on failure.
+ */
+int ipc_seqlock_set_checksum(ipc_handle_t *handle, int enable) {
+    ipc_seqlock_t *chan = (ipc_seqlock_t *)handle;
+
+    if (!chan) {
+        errno = EINVAL;
+        return IPC_FAILURE;
+    }
+    chan->checksum = enable ? 1 : 0;
+    return IPC_SUCCESS;
+}
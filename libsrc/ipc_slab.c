@@ -0,0 +1,708 @@
+/**
+ * @file ipc_slab.c
+ * author Animesh0817 (mailtome.anni@gmail.com)
+ * @brief Implementation of the shared-memory slab heap and offset queue.
+ *
+ * Segment layout:
+ * @code
+ * +--------------------+-------------------------------+----------------------+
+ * | ipc_slab_shm       | queue cells (seq, offset, crc)| heap blocks ...      |
+ * +--------------------+-------------------------------+----------------------+
+ * @endcode
+ *
+ * Every block starts with an 8-byte header: its size class (with a flag while
+ * the block is free) and either the message length or, while free, the index
+ * of the next free block. Block indexes are byte offsets divided by
+ * IPC_SLAB_MIN_BLOCK. Each free list head packs a 32-bit index with a 32-bit
+ * tag bumped on every update, so a compare-and-swap cannot succeed on a head
+ * that was popped and pushed back in between (ABA).
+ *
+ * The queue is a bounded MPMC ring in which every cell carries a sequence
+ * number telling producers and consumers whose turn it is.
+ */
+
+#include "ipc_slab.h"
+#include "ipc_crc32c.h"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <stdatomic.h>
+#include <stdalign.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include <errno.h>
+
+#define IPC_SLAB_MAGIC 0x4950534cu /* "IPSL" */
+#define IPC_SLAB_VERSION 2u
+
+#define IPC_SLAB_FREE (1u << 31) /**< Block is on a free list. */
+#define IPC_SLAB_CELL_CRC 1u /**< Queue cell carries the CRC32C of the message. */
+
+/**
+ * A Structure that will hold the layout of the segment header:
+ * Geometry of the queue and the heap
+ * Bump pointer and free list heads of the heap
+ * Producer and consumer positions of the queue, on separate cache lines
+ * Words used to wake blocked receivers
+ */
+struct ipc_slab_shm {
+    uint32_t magic; /**< IPC_SLAB_MAGIC once the segment is initialized. */
+    uint32_t version; /**< Layout version. */
+    uint64_t map_size; /**< Total size of the segment. */
+    uint64_t queue_off; /**< Offset of the queue cells. */
+    uint64_t queue_depth; /**< Number of cells, a power of two. */
+    uint64_t heap_off; /**< Offset of the first block. */
+    alignas(64) atomic_uint_fast64_t bump; /**< Offset of the first never-allocated byte. */
+    atomic_uint_fast64_t free_head[IPC_SLAB_CLASSES]; /**< Tag << 32 | block index, per class. */
+    alignas(64) atomic_uint_fast64_t enq_pos; /**< Next queue position to fill. */
+    alignas(64) atomic_uint_fast64_t deq_pos; /**< Next queue position to drain. */
+    alignas(64) atomic_uint signal; /**< Futex word bumped when receivers must wake. */
+    atomic_uint waiters; /**< Receivers blocked on signal. */
+    atomic_uint parked; /**< Doorbell parked word. */
+};
+
+/**
+ * A Structure that will hold one queue cell.
+ */
+typedef struct {
+    atomic_uint_fast64_t seq; /**< Turn of the cell. */
+    uint64_t offset; /**< Payload offset of the queued block. */
+    uint32_t crc; /**< CRC32C of the message, if flags has IPC_SLAB_CELL_CRC. */
+    uint32_t flags; /**< IPC_SLAB_CELL_* flags. */
+} ipc_slab_cell_t;
+
+/**
+ * A Structure that will hold the header of a block.
+ */
+typedef struct {
+    atomic_uint cls; /**< Size class, with IPC_SLAB_FREE while free. */
+    atomic_uint word; /**< Message length, or next free block index while free. */
+} ipc_slab_block_t;
+
+static unsigned char *ipc_slab_base(ipc_slab_t *slab) {
+    return (unsigned char *)slab->shm;
+}
+
+static ipc_slab_cell_t *ipc_slab_cells(ipc_slab_t *slab) {
+    return (ipc_slab_cell_t *)(ipc_slab_base(slab) + slab->shm->queue_off);
+}
+
+static ipc_slab_block_t *ipc_slab_block(ipc_slab_t *slab, uint64_t index) {
+    return (ipc_slab_block_t *)(ipc_slab_base(slab) + index * IPC_SLAB_MIN_BLOCK);
+}
+
+/**
+ * @brief Find the block header of a payload offset.
+ *
+ * @return The block, or NULL if the offset cannot come from ipc_slab_alloc().
+ */
+static ipc_slab_block_t *ipc_slab_lookup(ipc_slab_t *slab, uint64_t offset) {
+    uint64_t start = offset - IPC_SLAB_BLOCK_HDR;
+
+    if (offset < slab->shm->heap_off + IPC_SLAB_BLOCK_HDR || offset >= slab->shm->map_size ||
+        (start - slab->shm->heap_off) % IPC_SLAB_MIN_BLOCK != 0) {
+        return NULL;
+    }
+    return ipc_slab_block(slab, start / IPC_SLAB_MIN_BLOCK);
+}
+
+/**
+ * @brief Pop a block from the free list of a class.
+ *
+ * @return The block index, or 0 if the list is empty.
+ */
+static uint64_t ipc_slab_pop(ipc_slab_t *slab, int cls) {
+    atomic_uint_fast64_t *head = &slab->shm->free_head[cls];
+    uint64_t old = atomic_load_explicit(head, memory_order_acquire);
+
+    for (;;) {
+        uint64_t index = old & 0xffffffffu;
+        if (index == 0) {
+            return 0;
+        }
+        // The block may be popped by someone else meanwhile; the tag makes the CAS fail then
+        uint32_t next = atomic_load_explicit(&ipc_slab_block(slab, index)->word, memory_order_relaxed);
+        uint64_t update = ((old >> 32) + 1) << 32 | next;
+        if (atomic_compare_exchange_weak_explicit(head, &old, update, memory_order_acquire,
+                                                  memory_order_acquire)) {
+            return index;
+        }
+    }
+}
+
+/**
+ * @brief Push a block onto the free list of its class.
+ */
+static void ipc_slab_push(ipc_slab_t *slab, uint64_t index, int cls) {
+    atomic_uint_fast64_t *head = &slab->shm->free_head[cls];
+    ipc_slab_block_t *block = ipc_slab_block(slab, index);
+    uint64_t old = atomic_load_explicit(head, memory_order_relaxed);
+
+    atomic_store_explicit(&block->cls, IPC_SLAB_FREE | (uint32_t)cls, memory_order_relaxed);
+    for (;;) {
+        atomic_store_explicit(&block->word, (uint32_t)(old & 0xffffffffu), memory_order_relaxed);
+        uint64_t update = ((old >> 32) + 1) << 32 | index;
+        if (atomic_compare_exchange_weak_explicit(head, &old, update, memory_order_release,
+                                                  memory_order_relaxed)) {
+            return;
+        }
+    }
+}
+
+/**
+ * @brief Carve a new block from the untouched end of the heap.
+ *
+ * @return The block index, or 0 if the heap is exhausted.
+ */
+static uint64_t ipc_slab_carve(ipc_slab_t *slab, size_t size) {
+    uint64_t pos = atomic_load_explicit(&slab->shm->bump, memory_order_relaxed);
+
+    do {
+        if (pos + size > slab->shm->map_size) {
+            return 0;
+        }
+    } while (!atomic_compare_exchange_weak_explicit(&slab->shm->bump, &pos, pos + size,
+                                                    memory_order_relaxed, memory_order_relaxed));
+    return pos / IPC_SLAB_MIN_BLOCK;
+}
+
+/**
+ * @brief Take an offset, and the checksum queued with it, from the queue.
+ *
+ * @return IPC_SUCCESS on success, IPC_FAILURE if the queue is empty.
+ */
+static int ipc_slab_dequeue(ipc_slab_t *slab, uint64_t *offset, uint32_t *crc, uint32_t *flags) {
+    ipc_slab_cell_t *cells = ipc_slab_cells(slab);
+    uint64_t mask = slab->shm->queue_depth - 1;
+    uint64_t pos = atomic_load_explicit(&slab->shm->deq_pos, memory_order_relaxed);
+
+    for (;;) {
+        ipc_slab_cell_t *cell = &cells[pos & mask];
+        uint64_t seq = atomic_load_explicit(&cell->seq, memory_order_acquire);
+        int64_t dif = (int64_t)(seq - (pos + 1));
+
+        if (dif == 0) {
+            if (atomic_compare_exchange_weak_explicit(&slab->shm->deq_pos, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                *offset = cell->offset;
+                *crc = cell->crc;
+                *flags = cell->flags;
+                atomic_store_explicit(&cell->seq, pos + mask + 1, memory_order_release);
+                return IPC_SUCCESS;
+            }
+        } else if (dif < 0) {
+            return IPC_FAILURE;
+        } else {
+            pos = atomic_load_explicit(&slab->shm->deq_pos, memory_order_relaxed);
+        }
+    }
+}
+
+/**
+ * @brief Dequeue without blocking and keep the doorbell armed while the queue is empty.
+ */
+static int ipc_slab_try_receive(ipc_slab_t *slab, uint64_t *offset, uint32_t *crc, uint32_t *flags) {
+    if (slab->doorbell.efd < 0) {
+        return ipc_slab_dequeue(slab, offset, crc, flags);
+    }
+    if (ipc_slab_dequeue(slab, offset, crc, flags) == IPC_SUCCESS) {
+        if (atomic_load_explicit(slab->doorbell.parked, memory_order_relaxed)) {
+            ipc_doorbell_unpark(&slab->doorbell);
+        }
+        return IPC_SUCCESS;
+    }
+    // Leave the doorbell armed so a poller on get_fd() wakes for the next message
+    ipc_doorbell_park(&slab->doorbell);
+    return ipc_slab_dequeue(slab, offset, crc, flags);
+}
+
+/**
+ * @brief Map and validate (or, for the owner, initialize) the segment.
+ *
+ * @param handle Pointer to the IPC slab handle.
+ * @return IPC_SUCCESS on success, IPC_FAILURE on failure.
+ */
+static int ipc_slab_init(ipc_handle_t *handle) {
+    ipc_slab_t *slab = (ipc_slab_t *)handle;
+    struct stat st;
+    int fd;
+
+    if (slab->is_owner) {
+        size_t depth = 1;
+        while (depth < slab->queue_depth) {
+            depth <<= 1;
+        }
+        size_t queue_off = (sizeof(struct ipc_slab_shm) + IPC_SLAB_MIN_BLOCK - 1) & ~(size_t)(IPC_SLAB_MIN_BLOCK - 1);
+        size_t heap_off = queue_off + depth * sizeof(ipc_slab_cell_t);
+        heap_off = (heap_off + IPC_SLAB_MIN_BLOCK - 1) & ~(size_t)(IPC_SLAB_MIN_BLOCK - 1);
+        size_t size = heap_off + ((slab->heap_size + IPC_SLAB_MIN_BLOCK - 1) & ~(size_t)(IPC_SLAB_MIN_BLOCK - 1));
+        if (size / IPC_SLAB_MIN_BLOCK > UINT32_MAX) {
+            errno = EINVAL;
+            return IPC_FAILURE;
+        }
+
+        fd = shm_open(slab->name, O_CREAT | O_RDWR | O_CLOEXEC, 0600);
+        if (fd == -1) {
+            return IPC_FAILURE;
+        }
+        if (ftruncate(fd, 0) == -1 || ftruncate(fd, (off_t)size) == -1) {
+            close(fd);
+            return IPC_FAILURE;
+        }
+        slab->map_size = size;
+        void *map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        if (map == MAP_FAILED) {
+            return IPC_FAILURE;
+        }
+        slab->shm = (struct ipc_slab_shm *)map;
+
+        struct ipc_slab_shm *shm = slab->shm;
+        shm->version = IPC_SLAB_VERSION;
+        shm->map_size = size;
+        shm->queue_off = queue_off;
+        shm->queue_depth = depth;
+        shm->heap_off = heap_off;
+        atomic_init(&shm->bump, heap_off);
+        ipc_slab_cell_t *cells = ipc_slab_cells(slab);
+        for (size_t i = 0; i < depth; i++) {
+            atomic_init(&cells[i].seq, i);
+        }
+        atomic_thread_fence(memory_order_release);
+        shm->magic = IPC_SLAB_MAGIC;
+
+        if (ipc_doorbell_open(&slab->doorbell, &shm->parked) != IPC_SUCCESS) {
+            munmap(map, size);
+            slab->shm = NULL;
+            return IPC_FAILURE;
+        }
+        return IPC_SUCCESS;
+    }
+
+    fd = shm_open(slab->name, O_RDWR | O_CLOEXEC, 0);
+    if (fd == -1) {
+        return IPC_FAILURE;
+    }
+    if (fstat(fd, &st) == -1 || (size_t)st.st_size < sizeof(struct ipc_slab_shm)) {
+        close(fd);
+        errno = EPROTO;
+        return IPC_FAILURE;
+    }
+    slab->map_size = (size_t)st.st_size;
+    void *map = mmap(NULL, slab->map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        return IPC_FAILURE;
+    }
+    slab->shm = (struct ipc_slab_shm *)map;
+    if (slab->shm->magic != IPC_SLAB_MAGIC || slab->shm->version != IPC_SLAB_VERSION ||
+        slab->shm->map_size != slab->map_size) {
+        munmap(map, slab->map_size);
+        slab->shm = NULL;
+        errno = EPROTO;
+        return IPC_FAILURE;
+    }
+    atomic_thread_fence(memory_order_acquire);
+    slab->heap_size = slab->map_size - slab->shm->heap_off;
+    slab->queue_depth = slab->shm->queue_depth;
+    slab->doorbell.parked = &slab->shm->parked;
+    return IPC_SUCCESS;
+}
+
+/**
+ * @brief Allocate a block from the shared heap.
+ *
+ * @param handle Pointer to the IPC slab handle.
+ * @param len Number of bytes needed.
+ * @param offset Receives the offset of the block, to pass to ipc_slab_send_offset() or ipc_slab_free().
+ * @return Pointer to the block in this process, or NULL on failure (errno
+ *         EMSGSIZE if len exceeds the largest block, ENOMEM if the heap is full).
+ */
+void *ipc_slab_alloc(ipc_handle_t *handle, size_t len, uint64_t *offset) {
+    ipc_slab_t *slab = (ipc_slab_t *)handle;
+    int cls = 0;
+
+    if (!slab || !slab->shm || !offset) {
+        errno = EINVAL;
+        return NULL;
+    }
+    if (len > IPC_SLAB_MAX_BLOCK - IPC_SLAB_BLOCK_HDR) {
+        errno = EMSGSIZE;
+        return NULL;
+    }
+    while (((size_t)IPC_SLAB_MIN_BLOCK << cls) < len + IPC_SLAB_BLOCK_HDR) {
+        cls++;
+    }
+
+    uint64_t index = ipc_slab_pop(slab, cls);
+    if (index == 0) {
+        index = ipc_slab_carve(slab, (size_t)IPC_SLAB_MIN_BLOCK << cls);
+        if (index == 0) {
+            errno = ENOMEM;
+            return NULL;
+        }
+    }
+    ipc_slab_block_t *block = ipc_slab_block(slab, index);
+    atomic_store_explicit(&block->cls, (uint32_t)cls, memory_order_relaxed);
+    atomic_store_explicit(&block->word, 0, memory_order_relaxed);
+
+    *offset = index * IPC_SLAB_MIN_BLOCK + IPC_SLAB_BLOCK_HDR;
+    return (unsigned char *)block + IPC_SLAB_BLOCK_HDR;
+}
+
+/**
+ * @brief Return a block to the shared heap.
+ *
+ * Any process attached to the segment may free a block, whoever allocated it.
+ *
+ * @param handle Pointer to the IPC slab handle.
+ * @param offset Offset returned by ipc_slab_alloc() or ipc_slab_receive_view().
+ * @return IPC_SUCCESS on success, IPC_FAILURE on failure (errno EINVAL for an
+ *         invalid offset or a block that is already free).
+ */
+int ipc_slab_free(ipc_handle_t *handle, uint64_t offset) {
+    ipc_slab_t *slab = (ipc_slab_t *)handle;
+    ipc_slab_block_t *block = slab && slab->shm ? ipc_slab_lookup(slab, offset) : NULL;
+
+    if (!block) {
+        errno = EINVAL;
+        return IPC_FAILURE;
+    }
+    uint32_t cls = atomic_load_explicit(&block->cls, memory_order_relaxed);
+    if (cls & IPC_SLAB_FREE || cls >= IPC_SLAB_CLASSES) {
+        errno = EINVAL;
+        return IPC_FAILURE;
+    }
+    ipc_slab_push(slab, (offset - IPC_SLAB_BLOCK_HDR) / IPC_SLAB_MIN_BLOCK, (int)cls);
+    return IPC_SUCCESS;
+}
+
+/**
+ * @brief Translate an offset into a pointer in this process.
+ *
+ * @param handle Pointer to the IPC slab handle.
+ * @param offset Block offset.
+ * @return Pointer to the block, or NULL if the offset is invalid.
+ */
+void *ipc_slab_ptr(ipc_handle_t *handle, uint64_t offset) {
+    ipc_slab_t *slab = (ipc_slab_t *)handle;
+
+    if (!slab || !slab->shm || !ipc_slab_lookup(slab, offset)) {
+        errno = EINVAL;
+        return NULL;
+    }
+    return ipc_slab_base(slab) + offset;
+}
+
+/**
+ * @brief Queue an allocated block for the receiver.
+ *
+ * Ownership of the block passes to the receiver, which frees it.
+ *
+ * @param handle Pointer to the IPC slab handle.
+ * @param offset Offset returned by ipc_slab_alloc().
+ * @param len Length of the message in the block.
+ * @return IPC_SUCCESS on success, IPC_FAILURE on failure (errno EAGAIN if the queue is full).
+ */
+int ipc_slab_send_offset(ipc_handle_t *handle, uint64_t offset, size_t len) {
+    ipc_slab_t *slab = (ipc_slab_t *)handle;
+    ipc_slab_block_t *block = slab && slab->shm ? ipc_slab_lookup(slab, offset) : NULL;
+
+    if (!block) {
+        errno = EINVAL;
+        return IPC_FAILURE;
+    }
+    uint32_t cls = atomic_load_explicit(&block->cls, memory_order_relaxed);
+    if (cls >= IPC_SLAB_CLASSES || len > ((size_t)IPC_SLAB_MIN_BLOCK << cls) - IPC_SLAB_BLOCK_HDR) {
+        errno = EINVAL;
+        return IPC_FAILURE;
+    }
+    atomic_store_explicit(&block->word, (uint32_t)len, memory_order_relaxed);
+    uint32_t crc = slab->checksum ? ipc_crc32c(0, ipc_slab_base(slab) + offset, len) : 0;
+
+    ipc_slab_cell_t *cells = ipc_slab_cells(slab);
+    uint64_t mask = slab->shm->queue_depth - 1;
+    uint64_t pos = atomic_load_explicit(&slab->shm->enq_pos, memory_order_relaxed);
+    ipc_slab_cell_t *cell;
+
+    for (;;) {
+        cell = &cells[pos & mask];
+        uint64_t seq = atomic_load_explicit(&cell->seq, memory_order_acquire);
+        int64_t dif = (int64_t)(seq - pos);
+
+        if (dif == 0) {
+            if (atomic_compare_exchange_weak_explicit(&slab->shm->enq_pos, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                break;
+            }
+        } else if (dif < 0) {
+            errno = EAGAIN;
+            return IPC_FAILURE;
+        } else {
+            pos = atomic_load_explicit(&slab->shm->enq_pos, memory_order_relaxed);
+        }
+    }
+    cell->offset = offset;
+    cell->crc = crc;
+    cell->flags = slab->checksum ? IPC_SLAB_CELL_CRC : 0;
+    atomic_store_explicit(&cell->seq, pos + 1, memory_order_release);
+
+    // Wake-ups cost a syscall only while a receiver is blocked
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load_explicit(&slab->shm->waiters, memory_order_relaxed)) {
+        atomic_fetch_add_explicit(&slab->shm->signal, 1, memory_order_release);
+        ipc_futex_wake(&slab->shm->signal, 1);
+    }
+    if (slab->doorbell.efd >= 0) {
+        ipc_doorbell_ring(&slab->doorbell);
+    }
+    return IPC_SUCCESS;
+}
+
+/**
+ * @brief Take the next message from the queue, in place.
+ *
+ * The caller owns the block afterwards and must release it with ipc_slab_free().
+ *
+ * @param handle Pointer to the IPC slab handle.
+ * @param offset Receives the offset of the block.
+ * @param data Receives a pointer to the message.
+ * @param len Receives the message length.
+ * @param timeout_ms 0 to return at once, -1 to wait forever, or a timeout in milliseconds.
+ * @return IPC_SUCCESS on success, IPC_FAILURE on failure (errno EAGAIN when
+ *         the queue is empty and timeout_ms is 0, ETIMEDOUT on timeout,
+ *         EBADMSG when checksums are on and the message is corrupt; its
+ *         block is then freed).
+ */
+int ipc_slab_receive_view(ipc_handle_t *handle, uint64_t *offset, const void **data, size_t *len, int timeout_ms) {
+    ipc_slab_t *slab = (ipc_slab_t *)handle;
+    struct timespec ts;
+    uint64_t off;
+    uint32_t crc, flags;
+
+    if (!slab || !slab->shm || !offset || !data || !len) {
+        errno = EINVAL;
+        return IPC_FAILURE;
+    }
+    const struct timespec *deadline = ipc_futex_deadline(&ts, timeout_ms);
+
+    while (ipc_slab_try_receive(slab, &off, &crc, &flags) != IPC_SUCCESS) {
+        if (timeout_ms == 0) {
+            errno = EAGAIN;
+            return IPC_FAILURE;
+        }
+        atomic_fetch_add(&slab->shm->waiters, 1);
+        unsigned int seen = atomic_load(&slab->shm->signal);
+        int ready = ipc_slab_try_receive(slab, &off, &crc, &flags) == IPC_SUCCESS;
+        int ret = IPC_SUCCESS;
+        if (!ready) {
+            ret = ipc_futex_wait(&slab->shm->signal, seen, deadline);
+        }
+        atomic_fetch_sub(&slab->shm->waiters, 1);
+        if (ready) {
+            break;
+        }
+        if (ret != IPC_SUCCESS && errno == ETIMEDOUT) {
+            return IPC_FAILURE;
+        }
+    }
+
+    ipc_slab_block_t *block = ipc_slab_lookup(slab, off);
+    if (!block) {
+        errno = EPROTO;
+        return IPC_FAILURE;
+    }
+    size_t size = atomic_load_explicit(&block->word, memory_order_relaxed);
+    if ((flags & IPC_SLAB_CELL_CRC) && slab->checksum && crc != ipc_crc32c(0, ipc_slab_base(slab) + off, size)) {
+        ipc_slab_free(handle, off);
+        errno = EBADMSG;
+        return IPC_FAILURE;
+    }
+    *offset = off;
+    *data = ipc_slab_base(slab) + off;
+    *len = size;
+    return IPC_SUCCESS;
+}
+
+/**
+ * @brief Copy a message into a new block and queue it.
+ *
+ * @param handle Pointer to the IPC slab handle.
+ * @param data Message.
+ * @param size Message length.
+ * @return IPC_SUCCESS on success, IPC_FAILURE on failure.
+ */
+static int ipc_slab_send(ipc_handle_t *handle, const void *data, size_t size) {
+    uint64_t off;
+    void *block = ipc_slab_alloc(handle, size, &off);
+
+    if (!block) {
+        return IPC_FAILURE;
+    }
+    memcpy(block, data, size);
+    if (ipc_slab_send_offset(handle, off, size) != IPC_SUCCESS) {
+        int err = errno;
+        ipc_slab_free(handle, off);
+        errno = err;
+        return IPC_FAILURE;
+    }
+    return IPC_SUCCESS;
+}
+
+/**
+ * @brief Wait for a message, copy it out and free its block.
+ *
+ * @param handle Pointer to the IPC slab handle.
+ * @param buffer Destination buffer.
+ * @param size Capacity of buffer.
+ * @return Length of the message on success, IPC_FAILURE on failure (errno
+ *         EMSGSIZE if it did not fit; the message is dropped).
+ */
+static int ipc_slab_receive(ipc_handle_t *handle, void *buffer, size_t size) {
+    const void *data;
+    uint64_t off;
+    size_t len;
+
+    if (ipc_slab_receive_view(handle, &off, &data, &len, -1) != IPC_SUCCESS) {
+        return IPC_FAILURE;
+    }
+    if (len > size) {
+        ipc_slab_free(handle, off);
+        errno = EMSGSIZE;
+        return IPC_FAILURE;
+    }
+    memcpy(buffer, data, len);
+    ipc_slab_free(handle, off);
+    return (int)len;
+}
+
+/**
+ * @brief Get the doorbell eventfd of the handle.
+ *
+ * @return The eventfd, or IPC_FAILURE (errno ENOTSUP) if this process has none.
+ */
+static int ipc_slab_get_fd(ipc_handle_t *handle) {
+    ipc_slab_t *slab = (ipc_slab_t *)handle;
+
+    if (slab->doorbell.efd < 0) {
+        errno = ENOTSUP;
+        return IPC_FAILURE;
+    }
+    return slab->doorbell.efd;
+}
+
+/**
+ * @brief Unmap the segment and free the handle. The segment stays until ipc_slab_unlink().
+ */
+static int ipc_slab_destroy(ipc_handle_t *handle) {
+    ipc_slab_t *slab = (ipc_slab_t *)handle;
+
+    ipc_doorbell_close(&slab->doorbell);
+    if (slab->shm) {
+        munmap(slab->shm, slab->map_size);
+    }
+    free(slab->name);
+    free(slab);
+    return IPC_SUCCESS;
+}
+
+/**
+ * @brief Create a new IPC slab handle.
+ *
+ * @param name POSIX shared-memory name, e.g. "/my_service_slab".
+ * @param heap_size Bytes of heap; used by the owner only.
+ * @param queue_depth Number of messages that can be queued, rounded up to a
+ *        power of two; used by the owner only.
+ * @param is_owner Non-zero to create (or reset) the segment in init(), zero
+ *        to attach to a segment created by another process.
+ * @return Pointer to the created IPC slab handle, or NULL on failure.
+ */
+ipc_handle_t *ipc_slab_create(const char *name, size_t heap_size, size_t queue_depth, int is_owner) {
+    if (!name || (is_owner && (heap_size == 0 || queue_depth == 0))) {
+        errno = EINVAL;
+        return NULL;
+    }
+
+    ipc_slab_t *slab = (ipc_slab_t *)calloc(1, sizeof(ipc_slab_t));
+    if (!slab) {
+        return NULL;
+    }
+    slab->name = strdup(name);
+    if (!slab->name) {
+        free(slab);
+        return NULL;
+    }
+    slab->heap_size = heap_size;
+    slab->queue_depth = queue_depth;
+    slab->is_owner = is_owner;
+    slab->doorbell.efd = -1;
+
+    // Assign function pointers
+    slab->base.init = (int (*)(void *))ipc_slab_init;
+    slab->base.send = (int (*)(void *, const void *, size_t))ipc_slab_send;
+    slab->base.receive = (int (*)(void *, void *, size_t))ipc_slab_receive;
+    slab->base.destroy = (int (*)(void *))ipc_slab_destroy;
+    slab->base.accept = NULL;
+    slab->base.get_fd = (int (*)(void *))ipc_slab_get_fd;
+
+    return (ipc_handle_t *)slab;
+}
+
+/**
+ * @brief Remove a named slab segment.
+ *
+ * @param name POSIX shared-memory name.
+ * @return IPC_SUCCESS on success, IPC_FAILURE on failure.
+ */
+int ipc_slab_unlink(const char *name) {
+    return shm_unlink(name) == 0 ? IPC_SUCCESS : IPC_FAILURE;
+}
+
+/**
+ * @brief Use an eventfd received from the segment owner as doorbell.
+ *
+ * The descriptor usually comes from the owner's ipc_handle_get_fd(), either
+ * inherited through fork() or passed with SCM_RIGHTS. It is not closed by
+ * the handle.
+ *
+ * @param handle Pointer to an initialized IPC slab handle.
+ * @param efd eventfd descriptor.
+ * @return IPC_SUCCESS on success, IPC_FAILURE on failure.
+ */
+int ipc_slab_attach_doorbell(ipc_handle_t *handle, int efd) {
+    ipc_slab_t *slab = (ipc_slab_t *)handle;
+
+    if (!slab || !slab->shm) {
+        errno = EINVAL;
+        return IPC_FAILURE;
+    }
+    ipc_doorbell_close(&slab->doorbell);
+    return ipc_doorbell_attach(&slab->doorbell, efd, &slab->shm->parked);
+}
+
+/**
+ * @brief Enable or disable CRC32C checksums on a slab handle.
+ *
+ * With checksums on, messages queued through this handle carry the CRC32C
+ * of their payload, computed when they are queued, and messages received
+ * through it that carry one are verified. This catches a sender that keeps
+ * writing to a block after handing it over, or stray writes into the
+ * segment. Messages queued without a checksum are received as before.
+ *
+ * @param handle Pointer to the IPC slab handle.
+ * @param enable Non-zero to compute and verify checksums, zero to skip them.
+ * @return IPC_SUCCESS on success, IPC_FAILURE on failure.
+ */
+int ipc_slab_set_checksum(ipc_handle_t *handle, int enable) {
+    ipc_slab_t *slab = (ipc_slab_t *)handle;
+
+    if (!slab) {
+        errno = EINVAL;
+        return IPC_FAILURE;
+    }
+    slab->checksum = enable ? 1 : 0;
+    return IPC_SUCCESS;
+}
@@ -4,8 +4,87 @@
  * @brief Implementation of IPC using sockets.
  */
 
+#define _GNU_SOURCE /* splice(), pthread_setaffinity_np() */
 
 #include "ipc_socket.h"
+#include "ipc_frame.h"
+#include "ipc_crc32c.h"
+#include "ipc_trace.h"
+#include <sys/uio.h>
+#include <sys/stat.h>
+#include <sys/sendfile.h>
+#include <fcntl.h>
+#include <time.h>
+#include <poll.h>
+#include <limits.h>
+#include <pthread.h>
+#include <sched.h>
+#include <linux/net_tstamp.h>
+#include <linux/errqueue.h>
+
+#ifndef SO_PREFER_BUSY_POLL
+#define SO_PREFER_BUSY_POLL 69
+#endif
+
+/**
+ * @def IPC_SOCKET_TRACE_PENDING
+ * @brief Number of sent messages that can wait for their kernel TX timestamps.
+ */
+#define IPC_SOCKET_TRACE_PENDING 256
+
+/**
+ * A Structure that will hold the tracing state of a socket:
+ * Trace segment the records are written to
+ * Byte counter matching SOF_TIMESTAMPING_OPT_ID keys to sent messages
+ * FIFO of sent messages waiting for their TX timestamps
+ * Kernel timestamp of the data read by the last recvmsg()
+ */
+struct ipc_socket_trace {
+    ipc_trace_t *ring; /**< Trace segment. */
+    uint64_t tx_bytes; /**< Bytes sent since timestamping was enabled. */
+    uint64_t rx_kernel_ns; /**< Software RX timestamp of the last read. */
+    uint64_t keys[IPC_SOCKET_TRACE_PENDING]; /**< OPT_ID key (offset of last byte) per pending message. */
+    ipc_trace_record_t pending[IPC_SOCKET_TRACE_PENDING]; /**< Records waiting for TX timestamps. */
+    size_t head; /**< Number of messages ever added to the FIFO. */
+    size_t tail; /**< Number of messages ever removed from the FIFO. */
+};
+
+/**
+ * A Structure that will hold the write buffer of a socket:
+ * Bytes waiting to be sent and the buffer capacity
+ * Flush delay and the deadline of the oldest buffered byte
+ */
+struct ipc_socket_wbuf {
+    size_t cap; /**< Capacity of data. */
+    size_t len; /**< Bytes waiting in data. */
+    uint64_t delay_ns; /**< Flush delay after the first buffered byte, 0 for none. */
+    uint64_t deadline_ns; /**< CLOCK_MONOTONIC time by which data must be flushed. */
+    unsigned char data[]; /**< Buffered bytes. */
+};
+
+/**
+ * A Structure that will hold the read-ahead buffer of a socket:
+ * Buffer capacity and the window of received but unconsumed bytes
+ */
+struct ipc_socket_rbuf {
+    size_t cap; /**< Capacity of data. */
+    size_t head; /**< Offset of the first unconsumed byte. */
+    size_t tail; /**< Offset one past the last received byte. */
+    unsigned char data[]; /**< Received bytes. */
+};
+
+/**
+ * @brief Close the descriptor of a socket whose init() failed.
+ *
+ * The descriptor is marked closed so that destroy() does not close it again,
+ * possibly after the number was reused.
+ */
+static void ipc_socket_close_failed(ipc_socket_t *sock) {
+    int err = errno;
+    close(sock->sockfd);
+    sock->sockfd = -1;
+    errno = err;
+}
 
 /**
  * @brief Initialize the IPC socket.
@@ -19,24 +98,582 @@ static int ipc_socket_init(ipc_handle_t *handle) {
     if (sock->is_server) {
         // Server: Bind and listen
         if (bind(sock->sockfd, (struct sockaddr *)&sock->addr, sizeof(sock->addr)) == -1) {
-            close(sock->sockfd);
+            ipc_socket_close_failed(sock);
             return IPC_FAILURE;
         }
         if (listen(sock->sockfd, 5) == -1) {
-            close(sock->sockfd);
+            ipc_socket_close_failed(sock);
             return IPC_FAILURE;
         }
     } else {
         // Client: Connect
         if (connect(sock->sockfd, (struct sockaddr *)&sock->addr, sizeof(sock->addr)) == -1) {
-            close(sock->sockfd);
+            ipc_socket_close_failed(sock);
+            return IPC_FAILURE;
+        }
+    }
+
+    return IPC_SUCCESS;
+}
+
+/**
+ * @brief Write the oldest pending TX record to the trace and drop it from the FIFO.
+ *
+ * @param trace Tracing state of the socket.
+ */
+static void ipc_socket_trace_pop(struct ipc_socket_trace *trace) {
+    ipc_trace_record(trace->ring, &trace->pending[trace->tail % IPC_SOCKET_TRACE_PENDING]);
+    trace->tail++;
+}
+
+/**
+ * @brief Remember a sent message until its kernel TX timestamps arrive.
+ *
+ * @param sock Pointer to the IPC socket.
+ * @param user_ns Time the message was handed to libipc.
+ * @param len Message length reported in the trace.
+ * @param wire Bytes written to the socket for the message, including framing.
+ */
+static void ipc_socket_trace_tx(ipc_socket_t *sock, uint64_t user_ns, size_t len, size_t wire) {
+    struct ipc_socket_trace *trace = sock->trace;
+
+    if (wire == 0) {
+        return;
+    }
+    if (trace->head - trace->tail == IPC_SOCKET_TRACE_PENDING) {
+        // Stamps for the oldest message are overdue; publish what we have
+        ipc_socket_trace_pop(trace);
+    }
+    trace->tx_bytes += wire;
+
+    size_t slot = trace->head % IPC_SOCKET_TRACE_PENDING;
+    memset(&trace->pending[slot], 0, sizeof(trace->pending[slot]));
+    trace->pending[slot].kind = IPC_TRACE_KIND_TX;
+    trace->pending[slot].len = (uint32_t)len;
+    trace->pending[slot].user_ns = user_ns;
+    trace->keys[slot] = trace->tx_bytes - 1;
+    trace->head++;
+}
+
+/**
+ * @brief Attach one kernel TX timestamp to the pending message it belongs to.
+ *
+ * @param trace Tracing state of the socket.
+ * @param type SCM_TSTAMP_SCHED, SCM_TSTAMP_SND or SCM_TSTAMP_ACK.
+ * @param key OPT_ID key of the stamped message.
+ * @param ns Timestamp in nanoseconds.
+ */
+static void ipc_socket_trace_stamp(struct ipc_socket_trace *trace, uint32_t type, uint32_t key, uint64_t ns) {
+    for (size_t i = trace->tail; i != trace->head; i++) {
+        size_t slot = i % IPC_SOCKET_TRACE_PENDING;
+        // Keys are 32-bit byte offsets that wrap around. The kernel stamps the
+        // last byte of each write, so messages coalesced into one write that
+        // have no stamp yet share it.
+        if ((int32_t)(key - (uint32_t)trace->keys[slot]) < 0) {
+            break;
+        }
+        ipc_trace_record_t *rec = &trace->pending[slot];
+        if (type == SCM_TSTAMP_SCHED && !rec->sched_ns) {
+            rec->sched_ns = ns;
+        } else if (type == SCM_TSTAMP_SND && !rec->kernel_ns) {
+            rec->kernel_ns = ns;
+        } else if (type == SCM_TSTAMP_ACK && !rec->ack_ns) {
+            rec->ack_ns = ns;
+        }
+    }
+
+    // The ACK stamp is the last one a message gets
+    while (trace->tail != trace->head && trace->pending[trace->tail % IPC_SOCKET_TRACE_PENDING].ack_ns) {
+        ipc_socket_trace_pop(trace);
+    }
+}
+
+/**
+ * @brief Collect TX timestamps queued on the socket error queue.
+ *
+ * @param sock Pointer to the IPC socket.
+ */
+static void ipc_socket_trace_drain(ipc_socket_t *sock) {
+    char ctrl[512];
+
+    for (;;) {
+        struct msghdr msg = {0};
+        uint64_t ns = 0;
+        struct sock_extended_err *serr = NULL;
+
+        msg.msg_control = ctrl;
+        msg.msg_controllen = sizeof(ctrl);
+        if (recvmsg(sock->sockfd, &msg, MSG_ERRQUEUE | MSG_DONTWAIT) == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        for (struct cmsghdr *cm = CMSG_FIRSTHDR(&msg); cm; cm = CMSG_NXTHDR(&msg, cm)) {
+            if (cm->cmsg_level == SOL_SOCKET && cm->cmsg_type == SCM_TIMESTAMPING) {
+                struct scm_timestamping tss;
+                memcpy(&tss, CMSG_DATA(cm), sizeof(tss));
+                ns = (uint64_t)tss.ts[0].tv_sec * 1000000000ull + (uint64_t)tss.ts[0].tv_nsec;
+            } else if ((cm->cmsg_level == SOL_IP && cm->cmsg_type == IP_RECVERR) ||
+                       (cm->cmsg_level == SOL_IPV6 && cm->cmsg_type == IPV6_RECVERR)) {
+                serr = (struct sock_extended_err *)CMSG_DATA(cm);
+            }
+        }
+        if (serr && serr->ee_origin == SO_EE_ORIGIN_TIMESTAMPING && ns) {
+            ipc_socket_trace_stamp(sock->trace, serr->ee_info, serr->ee_data, ns);
+        }
+    }
+}
+
+/**
+ * @brief Write the record of a received message to the trace.
+ *
+ * @param sock Pointer to the IPC socket.
+ * @param len Message length.
+ */
+static void ipc_socket_trace_rx(ipc_socket_t *sock, size_t len) {
+    ipc_trace_record_t rec = {0};
+
+    rec.kind = IPC_TRACE_KIND_RX;
+    rec.len = (uint32_t)len;
+    rec.user_ns = ipc_trace_now();
+    rec.kernel_ns = sock->trace->rx_kernel_ns;
+    // Messages parsed from one read-ahead buffer fill share its timestamp
+    if (!sock->rbuf) {
+        sock->trace->rx_kernel_ns = 0;
+    }
+    ipc_trace_record(sock->trace->ring, &rec);
+}
+
+/**
+ * @brief Wait until the socket is ready, for sockets in busy-poll mode.
+ *
+ * Only busy polling makes the socket non-blocking. On a blocking socket
+ * EAGAIN means SO_SNDTIMEO or SO_RCVTIMEO expired, so the call fails at once
+ * and leaves errno as it was, letting the timeout reach the caller.
+ *
+ * @param sock Pointer to the IPC socket.
+ * @param events POLLIN or POLLOUT.
+ * @return IPC_SUCCESS on success, IPC_FAILURE on failure.
+ */
+static int ipc_socket_wait_ready(ipc_socket_t *sock, short events) {
+    struct pollfd pfd = { .fd = sock->sockfd, .events = events };
+
+    if (!sock->spin_us) {
+        return IPC_FAILURE;
+    }
+
+    while (poll(&pfd, 1, -1) == -1) {
+        if (errno != EINTR) {
+            return IPC_FAILURE;
+        }
+    }
+    return IPC_SUCCESS;
+}
+
+/**
+ * @brief Current CLOCK_MONOTONIC time in nanoseconds.
+ */
+static uint64_t ipc_socket_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief Make one receive call on the socket.
+ *
+ * When tracing, the kernel RX timestamp of the data is kept for the trace.
+ *
+ * @param sock Pointer to the IPC socket.
+ * @param buf Destination buffer.
+ * @param len Length of the buffer.
+ * @return Number of bytes received, 0 at end of stream, or -1 on failure.
+ */
+static ssize_t ipc_socket_recv_once(ipc_socket_t *sock, void *buf, size_t len) {
+    if (!sock->trace) {
+        return recv(sock->sockfd, buf, len, 0);
+    }
+
+    char ctrl[CMSG_SPACE(sizeof(struct scm_timestamping))];
+    struct iovec iov = { .iov_base = buf, .iov_len = len };
+    struct msghdr msg = {0};
+
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = ctrl;
+    msg.msg_controllen = sizeof(ctrl);
+    ssize_t got = recvmsg(sock->sockfd, &msg, 0);
+    if (got > 0) {
+        for (struct cmsghdr *cm = CMSG_FIRSTHDR(&msg); cm; cm = CMSG_NXTHDR(&msg, cm)) {
+            if (cm->cmsg_level == SOL_SOCKET && cm->cmsg_type == SCM_TIMESTAMPING) {
+                struct scm_timestamping tss;
+                memcpy(&tss, CMSG_DATA(cm), sizeof(tss));
+                if (tss.ts[0].tv_sec || tss.ts[0].tv_nsec) {
+                    sock->trace->rx_kernel_ns = (uint64_t)tss.ts[0].tv_sec * 1000000000ull + (uint64_t)tss.ts[0].tv_nsec;
+                }
+            }
+        }
+    }
+    return got;
+}
+
+/**
+ * @brief Receive available bytes from the socket.
+ *
+ * In busy-poll mode the non-blocking socket is polled in a loop for up to
+ * the spin budget, then the call blocks in poll() until data arrives.
+ *
+ * @param sock Pointer to the IPC socket.
+ * @param buf Destination buffer.
+ * @param len Length of the buffer.
+ * @return Number of bytes received, 0 at end of stream, or -1 on failure.
+ */
+static ssize_t ipc_socket_recv_some(ipc_socket_t *sock, void *buf, size_t len) {
+    uint64_t deadline = 0;
+
+    for (;;) {
+        ssize_t got = ipc_socket_recv_once(sock, buf, len);
+        if (got != -1 || !sock->spin_us || (errno != EAGAIN && errno != EWOULDBLOCK)) {
+            return got;
+        }
+        uint64_t now = ipc_socket_now_ns();
+        if (!deadline) {
+            deadline = now + (uint64_t)sock->spin_us * 1000;
+        } else if (now >= deadline) {
+            if (ipc_socket_wait_ready(sock, POLLIN) != IPC_SUCCESS) {
+                return -1;
+            }
+            deadline = 0;
+        }
+    }
+}
+
+/**
+ * @brief Write a scatter list to the socket, resuming after partial writes.
+ *
+ * @param sock Pointer to the IPC socket.
+ * @param iov Scatter list; modified in place as data is written.
+ * @param iovcnt Number of entries in iov.
+ * @param flags Extra sendmsg() flags, e.g. MSG_MORE.
+ * @return IPC_SUCCESS on success, IPC_FAILURE on failure.
+ */
+static int ipc_socket_writev_all(ipc_socket_t *sock, struct iovec *iov, int iovcnt, int flags) {
+    struct msghdr msg = {0};
+
+    msg.msg_iov = iov;
+    msg.msg_iovlen = iovcnt;
+    while (msg.msg_iovlen > 0) {
+        ssize_t sent = sendmsg(sock->sockfd, &msg, MSG_NOSIGNAL | flags);
+        if (sent == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if ((errno == EAGAIN || errno == EWOULDBLOCK) && ipc_socket_wait_ready(sock, POLLOUT) == IPC_SUCCESS) {
+                continue;
+            }
+            return IPC_FAILURE;
+        }
+        while (msg.msg_iovlen > 0 && (size_t)sent >= msg.msg_iov->iov_len) {
+            sent -= msg.msg_iov->iov_len;
+            msg.msg_iov++;
+            msg.msg_iovlen--;
+        }
+        if (msg.msg_iovlen > 0) {
+            msg.msg_iov->iov_base = (char *)msg.msg_iov->iov_base + sent;
+            msg.msg_iov->iov_len -= sent;
+        }
+    }
+    return IPC_SUCCESS;
+}
+
+/**
+ * @brief Make at least need bytes available in the read-ahead buffer.
+ *
+ * Each read asks the kernel for as much as the buffer can hold, so a burst
+ * of small messages is picked up with a single system call. Unconsumed
+ * bytes are moved to the front of the buffer when the tail runs out of room.
+ *
+ * @param sock Pointer to the IPC socket (with a read-ahead buffer).
+ * @param need Number of bytes required, at most the buffer capacity.
+ * @return IPC_SUCCESS on success, IPC_FAILURE on error or end of stream.
+ */
+static int ipc_socket_rbuf_fill(ipc_socket_t *sock, size_t need) {
+    struct ipc_socket_rbuf *rb = sock->rbuf;
+
+    if (rb->head == rb->tail) {
+        rb->head = rb->tail = 0;
+    } else if (rb->cap - rb->head < need) {
+        memmove(rb->data, rb->data + rb->head, rb->tail - rb->head);
+        rb->tail -= rb->head;
+        rb->head = 0;
+    }
+    while (rb->tail - rb->head < need) {
+        ssize_t got = ipc_socket_recv_some(sock, rb->data + rb->tail, rb->cap - rb->tail);
+        if (got == -1 && errno == EINTR) {
+            continue;
+        }
+        if (got <= 0) {
+            return IPC_FAILURE;
+        }
+        rb->tail += got;
+    }
+    return IPC_SUCCESS;
+}
+
+/**
+ * @brief Read exactly len bytes from the socket.
+ *
+ * Buffered read-ahead bytes are used first. Remainders smaller than the
+ * read-ahead buffer are read through it; larger ones go straight to buf.
+ *
+ * @param sock Pointer to the IPC socket.
+ * @param buf Destination buffer, or NULL to discard the bytes.
+ * @param len Number of bytes to read.
+ * @return IPC_SUCCESS on success, IPC_FAILURE on error or end of stream.
+ */
+static int ipc_socket_read_full(ipc_socket_t *sock, void *buf, size_t len) {
+    struct ipc_socket_rbuf *rb = sock->rbuf;
+    char scratch[256];
+    size_t done = 0;
+
+    while (done < len) {
+        if (rb && (rb->head != rb->tail || len - done < rb->cap)) {
+            if (rb->head == rb->tail && ipc_socket_rbuf_fill(sock, 1) != IPC_SUCCESS) {
+                return IPC_FAILURE;
+            }
+            size_t n = rb->tail - rb->head < len - done ? rb->tail - rb->head : len - done;
+            if (buf) {
+                memcpy((char *)buf + done, rb->data + rb->head, n);
+            }
+            rb->head += n;
+            done += n;
+            continue;
+        }
+        void *dst = buf ? (char *)buf + done : scratch;
+        size_t want = buf ? len - done : (len - done < sizeof(scratch) ? len - done : sizeof(scratch));
+        ssize_t got = ipc_socket_recv_some(sock, dst, want);
+        if (got == -1 && errno == EINTR) {
+            continue;
+        }
+        if (got <= 0) {
             return IPC_FAILURE;
         }
+        done += got;
+    }
+    return IPC_SUCCESS;
+}
+
+/**
+ * @brief Send everything in the write buffer.
+ *
+ * @param sock Pointer to the IPC socket.
+ * @return IPC_SUCCESS on success, IPC_FAILURE on failure.
+ */
+static int ipc_socket_wbuf_flush(ipc_socket_t *sock) {
+    struct ipc_socket_wbuf *wb = sock->wbuf;
+
+    if (!wb || wb->len == 0) {
+        return IPC_SUCCESS;
+    }
+    struct iovec iov = { .iov_base = wb->data, .iov_len = wb->len };
+    wb->len = 0;
+    if (ipc_socket_writev_all(sock, &iov, 1, 0) != IPC_SUCCESS) {
+        return IPC_FAILURE;
+    }
+    if (sock->trace) {
+        ipc_socket_trace_drain(sock);
+    }
+    return IPC_SUCCESS;
+}
+
+/**
+ * @brief Encode the frame header of a message and, if checksums are on, its trailer.
+ *
+ * @param sock Pointer to the IPC socket.
+ * @param msg Pointer to the message.
+ * @param len Length of the message.
+ * @param hdr_buf Receives the IPC_FRAME_HDR_SIZE header bytes.
+ * @param crc_buf Receives the IPC_CRC32C_SIZE trailer bytes.
+ * @return Size of the trailer: IPC_CRC32C_SIZE, or 0 without checksums.
+ */
+static size_t ipc_socket_frame_encode(ipc_socket_t *sock, const void *msg, size_t len,
+                                      unsigned char *hdr_buf, unsigned char *crc_buf) {
+    ipc_frame_hdr_t hdr = { .length = (uint32_t)len, .flags = 0 };
+
+    if (sock->checksum) {
+        hdr.flags |= IPC_FRAME_FLAG_CRC32C;
+        ipc_frame_crc_encode(crc_buf, ipc_crc32c(0, msg, len));
+    }
+    ipc_frame_hdr_encode(hdr_buf, &hdr);
+    return sock->checksum ? IPC_CRC32C_SIZE : 0;
+}
+
+/**
+ * @brief Read the trailer of a frame and check it against the payload.
+ *
+ * @param sock Pointer to the IPC socket.
+ * @param hdr Decoded header of the frame.
+ * @param payload The received payload.
+ * @param trailer The trailer bytes, or NULL to read them from the socket.
+ * @return IPC_SUCCESS on success, IPC_FAILURE on failure (errno EBADMSG if
+ *         the checksum does not match).
+ */
+static int ipc_socket_frame_verify(ipc_socket_t *sock, const ipc_frame_hdr_t *hdr, const void *payload,
+                                   const unsigned char *trailer) {
+    unsigned char crc_buf[IPC_CRC32C_SIZE];
+
+    if (!(hdr->flags & IPC_FRAME_FLAG_CRC32C)) {
+        return IPC_SUCCESS;
+    }
+    if (!trailer) {
+        if (ipc_socket_read_full(sock, crc_buf, sizeof(crc_buf)) != IPC_SUCCESS) {
+            return IPC_FAILURE;
+        }
+        trailer = crc_buf;
+    }
+    if (sock->checksum && ipc_frame_crc_decode(trailer) != ipc_crc32c(0, payload, hdr->length)) {
+        errno = EBADMSG;
+        return IPC_FAILURE;
+    }
+    return IPC_SUCCESS;
+}
+
+/**
+ * @brief Append a message (and its frame header) to the write buffer.
+ *
+ * The buffer is flushed when it fills up or its deadline has passed. A
+ * message that does not fit goes out together with the buffered bytes in a
+ * single system call.
+ *
+ * @param sock Pointer to the IPC socket.
+ * @param msg Pointer to the message.
+ * @param len Length of the message.
+ * @return IPC_SUCCESS on success, IPC_FAILURE on failure.
+ */
+static int ipc_socket_wbuf_append(ipc_socket_t *sock, const void *msg, size_t len) {
+    struct ipc_socket_wbuf *wb = sock->wbuf;
+    unsigned char hdr_buf[IPC_FRAME_HDR_SIZE];
+    unsigned char crc_buf[IPC_CRC32C_SIZE];
+    size_t hdr_len = 0;
+    size_t crc_len = 0;
+
+    if (sock->framed) {
+        crc_len = ipc_socket_frame_encode(sock, msg, len, hdr_buf, crc_buf);
+        hdr_len = sizeof(hdr_buf);
+    }
+
+    if (hdr_len + len + crc_len <= wb->cap - wb->len) {
+        uint64_t now = wb->delay_ns ? ipc_socket_now_ns() : 0;
+        if (wb->len == 0) {
+            wb->deadline_ns = now + wb->delay_ns;
+        }
+        memcpy(wb->data + wb->len, hdr_buf, hdr_len);
+        if (len) {
+            memcpy(wb->data + wb->len + hdr_len, msg, len);
+        }
+        memcpy(wb->data + wb->len + hdr_len + len, crc_buf, crc_len);
+        wb->len += hdr_len + len + crc_len;
+        if (wb->len == wb->cap || (wb->delay_ns && now >= wb->deadline_ns)) {
+            return ipc_socket_wbuf_flush(sock);
+        }
+        return IPC_SUCCESS;
     }
 
+    struct iovec iov[4];
+    int iovcnt = 0;
+    if (wb->len) {
+        iov[iovcnt].iov_base = wb->data;
+        iov[iovcnt++].iov_len = wb->len;
+    }
+    if (hdr_len) {
+        iov[iovcnt].iov_base = hdr_buf;
+        iov[iovcnt++].iov_len = hdr_len;
+    }
+    if (len) {
+        iov[iovcnt].iov_base = (void *)msg;
+        iov[iovcnt++].iov_len = len;
+    }
+    if (crc_len) {
+        iov[iovcnt].iov_base = crc_buf;
+        iov[iovcnt++].iov_len = crc_len;
+    }
+    wb->len = 0;
+    if (iovcnt && ipc_socket_writev_all(sock, iov, iovcnt, 0) != IPC_SUCCESS) {
+        return IPC_FAILURE;
+    }
+    if (sock->trace) {
+        ipc_socket_trace_drain(sock);
+    }
     return IPC_SUCCESS;
 }
 
+/**
+ * @brief Send one length-prefixed message through the IPC socket.
+ *
+ * @param sock Pointer to the IPC socket.
+ * @param msg Pointer to the message to send.
+ * @param len Length of the message.
+ * @return IPC_SUCCESS on success, IPC_FAILURE on failure.
+ */
+static int ipc_socket_send_framed(ipc_socket_t *sock, const void *msg, size_t len) {
+    unsigned char hdr_buf[IPC_FRAME_HDR_SIZE];
+    unsigned char crc_buf[IPC_CRC32C_SIZE];
+    struct iovec iov[3];
+    int iovcnt = 1;
+
+    if (len > IPC_FRAME_MAX_PAYLOAD) {
+        errno = EMSGSIZE;
+        return IPC_FAILURE;
+    }
+    size_t crc_len = ipc_socket_frame_encode(sock, msg, len, hdr_buf, crc_buf);
+    iov[0].iov_base = hdr_buf;
+    iov[0].iov_len = sizeof(hdr_buf);
+    if (len) {
+        iov[iovcnt].iov_base = (void *)msg;
+        iov[iovcnt++].iov_len = len;
+    }
+    if (crc_len) {
+        iov[iovcnt].iov_base = crc_buf;
+        iov[iovcnt++].iov_len = crc_len;
+    }
+    return ipc_socket_writev_all(sock, iov, iovcnt, 0);
+}
+
+/**
+ * @brief Receive one length-prefixed message from the IPC socket.
+ *
+ * A message larger than the buffer is consumed and dropped so the stream stays
+ * in sync, and the call fails with errno EMSGSIZE. A message whose checksum
+ * does not match is consumed too, and the call fails with errno EBADMSG.
+ *
+ * @param sock Pointer to the IPC socket.
+ * @param buf Buffer to store the received message.
+ * @param len Length of the buffer.
+ * @return Length of the message on success, IPC_FAILURE on failure.
+ */
+static int ipc_socket_receive_framed(ipc_socket_t *sock, void *buf, size_t len) {
+    unsigned char hdr_buf[IPC_FRAME_HDR_SIZE];
+    ipc_frame_hdr_t hdr;
+
+    if (ipc_socket_read_full(sock, hdr_buf, sizeof(hdr_buf)) != IPC_SUCCESS ||
+        ipc_frame_hdr_decode(hdr_buf, &hdr) != IPC_SUCCESS) {
+        return IPC_FAILURE;
+    }
+    size_t crc_len = (hdr.flags & IPC_FRAME_FLAG_CRC32C) ? IPC_CRC32C_SIZE : 0;
+    if (hdr.length > len) {
+        if (ipc_socket_read_full(sock, NULL, hdr.length + crc_len) == IPC_SUCCESS) {
+            errno = EMSGSIZE;
+        }
+        return IPC_FAILURE;
+    }
+    if (ipc_socket_read_full(sock, buf, hdr.length) != IPC_SUCCESS ||
+        ipc_socket_frame_verify(sock, &hdr, buf, NULL) != IPC_SUCCESS) {
+        return IPC_FAILURE;
+    }
+    return (int)hdr.length;
+}
+
 /**
  * @brief Send a message through the IPC socket.
  *
@@ -47,8 +684,39 @@ static int ipc_socket_init(ipc_handle_t *handle) {
  */
 static int ipc_socket_send(ipc_handle_t *handle, const void *msg, size_t len) {
     ipc_socket_t *sock = (ipc_socket_t *)handle;
-    if (send(sock->sockfd, msg, len, 0) == -1) {
-        return IPC_FAILURE;
+    uint64_t user_ns = sock->trace ? ipc_trace_now() : 0;
+    size_t wire;
+
+    if (sock->wbuf) {
+        if (sock->framed && len > IPC_FRAME_MAX_PAYLOAD) {
+            errno = EMSGSIZE;
+            return IPC_FAILURE;
+        }
+        wire = (sock->framed ? IPC_FRAME_HDR_SIZE + (sock->checksum ? IPC_CRC32C_SIZE : 0) : 0) + len;
+        // Record before appending: a flush may collect the stamps right away
+        if (sock->trace) {
+            ipc_socket_trace_tx(sock, user_ns, len, wire);
+        }
+        return ipc_socket_wbuf_append(sock, msg, len);
+    }
+
+    if (sock->framed) {
+        if (ipc_socket_send_framed(sock, msg, len) != IPC_SUCCESS) {
+            return IPC_FAILURE;
+        }
+        wire = IPC_FRAME_HDR_SIZE + (sock->checksum ? IPC_CRC32C_SIZE : 0) + len;
+    } else {
+        // Resumes short writes and waits out EAGAIN on a busy-polled socket
+        struct iovec iov = { .iov_base = (void *)msg, .iov_len = len };
+        if (ipc_socket_writev_all(sock, &iov, 1, 0) != IPC_SUCCESS) {
+            return IPC_FAILURE;
+        }
+        wire = len;
+    }
+
+    if (sock->trace) {
+        ipc_socket_trace_tx(sock, user_ns, len, wire);
+        ipc_socket_trace_drain(sock);
     }
     return IPC_SUCCESS;
 }
@@ -59,14 +727,37 @@ static int ipc_socket_send(ipc_handle_t *handle, const void *msg, size_t len) {
  * @param handle Pointer to the IPC socket handle.
  * @param buf Buffer to store the received message.
  * @param len Length of the buffer.
- * @return IPC_SUCCESS on success, IPC_FAILURE on failure.
+ * @return IPC_SUCCESS on success, IPC_FAILURE on failure. In framed mode the
+ *         length of the received message is returned on success.
  */
 static int ipc_socket_receive(ipc_handle_t *handle, void *buf, size_t len) {
     ipc_socket_t *sock = (ipc_socket_t *)handle;
-    ssize_t bytes_received = recv(sock->sockfd, buf, len, 0);
+    // The peer may be waiting for what we buffered before it answers
+    if (ipc_socket_wbuf_flush(sock) != IPC_SUCCESS) {
+        return IPC_FAILURE;
+    }
+    if (sock->framed) {
+        int ret = ipc_socket_receive_framed(sock, buf, len);
+        if (sock->trace && ret >= 0) {
+            ipc_socket_trace_rx(sock, (size_t)ret);
+        }
+        return ret;
+    }
+    ssize_t bytes_received;
+    if (sock->rbuf && sock->rbuf->head != sock->rbuf->tail) {
+        struct ipc_socket_rbuf *rb = sock->rbuf;
+        bytes_received = rb->tail - rb->head < len ? (ssize_t)(rb->tail - rb->head) : (ssize_t)len;
+        memcpy(buf, rb->data + rb->head, bytes_received);
+        rb->head += bytes_received;
+    } else {
+        bytes_received = ipc_socket_recv_some(sock, buf, len);
+    }
     if (bytes_received == -1 || bytes_received == 0) {
         return IPC_FAILURE;
     }
+    if (sock->trace) {
+        ipc_socket_trace_rx(sock, (size_t)bytes_received);
+    }
     return IPC_SUCCESS;
 }
 
@@ -78,20 +769,35 @@ static int ipc_socket_receive(ipc_handle_t *handle, void *buf, size_t len) {
  */
 static int ipc_socket_destroy(ipc_handle_t *handle) {
     ipc_socket_t *sock = (ipc_socket_t *)handle;
-    if (close(sock->sockfd) == -1) {
+    ipc_socket_wbuf_flush(sock);
+    free(sock->wbuf);
+    free(sock->rbuf);
+    ipc_socket_disable_tracing(handle);
+    if (sock->sockfd != -1 && close(sock->sockfd) == -1) {
         return IPC_FAILURE;
     }
     free(sock);
     return IPC_SUCCESS;
 }
 
+/**
+ * @brief Get the pollable descriptor of the IPC socket.
+ *
+ * @param handle Pointer to the IPC socket handle.
+ * @return The socket file descriptor.
+ */
+static int ipc_socket_get_fd(ipc_handle_t *handle) {
+    ipc_socket_t *sock = (ipc_socket_t *)handle;
+    return sock->sockfd;
+}
+
 /**
  * @brief Accept a connection on a server socket.
  *
  * @return A new IPC socket handle for the accepted client connection, or NULL on failure.
  */
 static ipc_handle_t *ipc_socket_accept(ipc_socket_t *server_sock) {
-    ipc_socket_t *client_sock = (ipc_socket_t *)malloc(sizeof(ipc_socket_t));
+    ipc_socket_t *client_sock = (ipc_socket_t *)calloc(1, sizeof(ipc_socket_t));
     if (!client_sock) {
         return NULL;
     }
@@ -104,10 +810,24 @@ static ipc_handle_t *ipc_socket_accept(ipc_socket_t *server_sock) {
     }
 
     client_sock->is_server = 0;
+    client_sock->framed = server_sock->framed;
+    client_sock->checksum = server_sock->checksum;
+    if ((server_sock->wbuf &&
+         ipc_socket_set_write_buffer((ipc_handle_t *)client_sock, server_sock->wbuf->cap,
+                                     (unsigned int)(server_sock->wbuf->delay_ns / 1000)) != IPC_SUCCESS) ||
+        (server_sock->rbuf &&
+         ipc_socket_set_read_ahead((ipc_handle_t *)client_sock, server_sock->rbuf->cap) != IPC_SUCCESS)) {
+        close(client_sock->sockfd);
+        free(client_sock->wbuf);
+        free(client_sock);
+        return NULL;
+    }
     client_sock->base.init = (int (*)(void *))ipc_socket_init;
     client_sock->base.send = (int (*)(void *, const void *, size_t))ipc_socket_send;
     client_sock->base.receive = (int (*)(void *, void *, size_t))ipc_socket_receive;
     client_sock->base.destroy = (int (*)(void *))ipc_socket_destroy;
+    client_sock->base.accept = NULL;
+    client_sock->base.get_fd = (int (*)(void *))ipc_socket_get_fd;
 
     return (ipc_handle_t *)client_sock;
 }
@@ -121,7 +841,7 @@ static ipc_handle_t *ipc_socket_accept(ipc_socket_t *server_sock) {
  * @return Pointer to the created IPC socket handle.
  */
 ipc_handle_t *ipc_socket_create(const char *address, int port, int is_server) {
-    ipc_socket_t *sock = (ipc_socket_t *)malloc(sizeof(ipc_socket_t));
+    ipc_socket_t *sock = (ipc_socket_t *)calloc(1, sizeof(ipc_socket_t));
     if (!sock) {
         return NULL;
     }
@@ -149,7 +869,560 @@ ipc_handle_t *ipc_socket_create(const char *address, int port, int is_server) {
     sock->base.receive = (int (*)(void *, void *, size_t))ipc_socket_receive;
     sock->base.destroy = (int (*)(void *))ipc_socket_destroy;
     sock->base.accept = is_server ? (ipc_handle_t *(*)(ipc_handle_t *))ipc_socket_accept : NULL;
+    sock->base.get_fd = (int (*)(void *))ipc_socket_get_fd;
 
 
     return (ipc_handle_t *)sock;
 }
+
+/**
+ * @brief Enable or disable length-prefixed framing on an IPC socket.
+ *
+ * In framed mode every `send` transmits one message and every `receive`
+ * returns exactly one message and its length, which is what message-oriented
+ * layers such as RPC require. Both peers must use the same mode. Connections
+ * accepted on a framed server socket are framed as well.
+ *
+ * @param handle Pointer to the IPC socket handle.
+ * @param enable Non-zero to enable framing, zero to disable it.
+ * @return IPC_SUCCESS on success, IPC_FAILURE on failure.
+ */
+int ipc_socket_set_framing(ipc_handle_t *handle, int enable) {
+    ipc_socket_t *sock = (ipc_socket_t *)handle;
+    if (!sock) {
+        errno = EINVAL;
+        return IPC_FAILURE;
+    }
+    sock->framed = enable ? 1 : 0;
+    return IPC_SUCCESS;
+}
+
+/**
+ * @brief Enable or disable CRC32C checksums on a framed IPC socket.
+ *
+ * With checksums on, every framed message is sent with the CRC32C of its
+ * payload (see ipc_frame.h) and every received message that carries one is
+ * verified: a mismatch drops the message and fails the receive with errno
+ * EBADMSG. With checksums off nothing is computed or verified, but messages
+ * from a peer that sends checksums are still received. The setting only
+ * applies to framed sockets; accepted connections inherit it. Messages sent
+ * with ipc_send_file() carry no checksum, since their payload never passes
+ * through user space.
+ *
+ * @param handle Pointer to the IPC socket handle.
+ * @param enable Non-zero to compute and verify checksums, zero to skip them.
+ * @return IPC_SUCCESS on success, IPC_FAILURE on failure.
+ */
+int ipc_socket_set_checksum(ipc_handle_t *handle, int enable) {
+    ipc_socket_t *sock = (ipc_socket_t *)handle;
+    if (!sock) {
+        errno = EINVAL;
+        return IPC_FAILURE;
+    }
+    sock->checksum = enable ? 1 : 0;
+    return IPC_SUCCESS;
+}
+
+/**
+ * @brief Move file data to the socket with splice(), for descriptors sendfile() rejects.
+ *
+ * Pipes are spliced straight into the socket; other descriptors go through an
+ * intermediate pipe. Either way the data never enters user space.
+ *
+ * @param sock Pointer to the IPC socket.
+ * @param fd Source file descriptor.
+ * @param offset Pointer to the file offset, advanced as data is sent; ignored for pipes.
+ * @param len Number of bytes to send.
+ * @return Number of bytes sent, or -1 on failure.
+ */
+static ssize_t ipc_socket_splice_file(ipc_socket_t *sock, int fd, off_t *offset, size_t len) {
+    struct stat st;
+    int pipefd[2];
+    size_t done = 0;
+
+    if (fstat(fd, &st) == -1) {
+        return -1;
+    }
+    if (S_ISFIFO(st.st_mode)) {
+        while (done < len) {
+            ssize_t n = splice(fd, NULL, sock->sockfd, NULL, len - done, SPLICE_F_MOVE | SPLICE_F_MORE);
+            if (n == -1 && (errno == EINTR ||
+                            (errno == EAGAIN && ipc_socket_wait_ready(sock, POLLOUT) == IPC_SUCCESS))) {
+                continue;
+            }
+            if (n <= 0) {
+                break;
+            }
+            done += n;
+        }
+        return done ? (ssize_t)done : -1;
+    }
+
+    if (pipe2(pipefd, O_CLOEXEC) == -1) {
+        return -1;
+    }
+    while (done < len) {
+        ssize_t in = splice(fd, offset, pipefd[1], NULL, len - done, SPLICE_F_MOVE | SPLICE_F_MORE);
+        if (in == -1 && errno == EINTR) {
+            continue;
+        }
+        if (in <= 0) {
+            break;
+        }
+        while (in > 0) {
+            ssize_t out = splice(pipefd[0], NULL, sock->sockfd, NULL, in, SPLICE_F_MOVE | SPLICE_F_MORE);
+            if (out == -1 && (errno == EINTR ||
+                              (errno == EAGAIN && ipc_socket_wait_ready(sock, POLLOUT) == IPC_SUCCESS))) {
+                continue;
+            }
+            if (out <= 0) {
+                close(pipefd[0]);
+                close(pipefd[1]);
+                return -1;
+            }
+            in -= out;
+            done += out;
+        }
+    }
+    close(pipefd[0]);
+    close(pipefd[1]);
+    return done ? (ssize_t)done : -1;
+}
+
+/**
+ * @brief Send a range of a file through an IPC socket without copying it through user space.
+ *
+ * Uses sendfile(), falling back to splice() for descriptors that sendfile()
+ * does not support (e.g. pipes). On a framed socket the range is sent as a
+ * single message that the peer receives with one `receive` call.
+ *
+ * If the file ends before len bytes were sent, the call fails with errno EIO.
+ * On a framed socket the stream is then out of sync and the connection should
+ * be closed.
+ *
+ * @param handle Pointer to the IPC socket handle.
+ * @param fd File descriptor to read from. Its file offset is not changed.
+ * @param offset Offset in the file of the first byte to send.
+ * @param len Number of bytes to send.
+ * @return IPC_SUCCESS on success, IPC_FAILURE on failure.
+ */
+int ipc_send_file(ipc_handle_t *handle, int fd, off_t offset, size_t len) {
+    ipc_socket_t *sock = (ipc_socket_t *)handle;
+    size_t done = 0;
+
+    if (!handle || handle->destroy != (int (*)(void *))ipc_socket_destroy || fd < 0) {
+        errno = EINVAL;
+        return IPC_FAILURE;
+    }
+    uint64_t user_ns = sock->trace ? ipc_trace_now() : 0;
+
+    if (ipc_socket_wbuf_flush(sock) != IPC_SUCCESS) {
+        return IPC_FAILURE;
+    }
+    if (sock->framed) {
+        unsigned char hdr_buf[IPC_FRAME_HDR_SIZE];
+        ipc_frame_hdr_t hdr = { .length = (uint32_t)len, .flags = 0 };
+        struct iovec iov = { .iov_base = hdr_buf, .iov_len = sizeof(hdr_buf) };
+
+        if (len > IPC_FRAME_MAX_PAYLOAD) {
+            errno = EMSGSIZE;
+            return IPC_FAILURE;
+        }
+        ipc_frame_hdr_encode(hdr_buf, &hdr);
+        if (ipc_socket_writev_all(sock, &iov, 1, len ? MSG_MORE : 0) != IPC_SUCCESS) {
+            return IPC_FAILURE;
+        }
+    }
+
+    while (done < len) {
+        ssize_t sent = sendfile(sock->sockfd, fd, &offset, len - done);
+        if (sent == -1 && (errno == EINTR ||
+                           (errno == EAGAIN && ipc_socket_wait_ready(sock, POLLOUT) == IPC_SUCCESS))) {
+            continue;
+        }
+        if (sent == -1 && (errno == EINVAL || errno == ENOSYS || errno == ESPIPE)) {
+            sent = ipc_socket_splice_file(sock, fd, &offset, len - done);
+        }
+        if (sent == -1) {
+            return IPC_FAILURE;
+        }
+        if (sent == 0) {
+            errno = EIO;
+            return IPC_FAILURE;
+        }
+        done += sent;
+    }
+
+    if (sock->trace) {
+        ipc_socket_trace_tx(sock, user_ns, len, len + (sock->framed ? IPC_FRAME_HDR_SIZE : 0));
+        ipc_socket_trace_drain(sock);
+    }
+    return IPC_SUCCESS;
+}
+
+/**
+ * @brief Enable per-message latency tracing on a connected IPC socket.
+ *
+ * Turns on SO_TIMESTAMPING software timestamps: when a sent message enters
+ * the packet scheduler, when it is handed to the device and when the peer
+ * acknowledges it, plus when received data arrives in the kernel. Together
+ * with user-space timestamps taken when a message is handed to libipc and
+ * when it is returned to the caller, they are written to a shared-memory
+ * trace (see ipc_trace.h) that another process can read with ipc_trace_open().
+ *
+ * The socket must be connected: call this after init() on a client, or on a
+ * handle returned by accept(). Each traced handle needs its own trace name.
+ *
+ * @param handle Pointer to the IPC socket handle.
+ * @param trace_name POSIX shared-memory name of the trace, e.g. "/svc_conn1".
+ * @param capacity Number of records kept in the trace ring.
+ * @return IPC_SUCCESS on success, IPC_FAILURE on failure.
+ */
+int ipc_socket_enable_tracing(ipc_handle_t *handle, const char *trace_name, size_t capacity) {
+    ipc_socket_t *sock = (ipc_socket_t *)handle;
+    int flags = SOF_TIMESTAMPING_SOFTWARE | SOF_TIMESTAMPING_RX_SOFTWARE |
+                SOF_TIMESTAMPING_TX_SCHED | SOF_TIMESTAMPING_TX_SOFTWARE | SOF_TIMESTAMPING_TX_ACK |
+                SOF_TIMESTAMPING_OPT_ID | SOF_TIMESTAMPING_OPT_TSONLY;
+
+    if (!sock || !trace_name || sock->trace) {
+        errno = EINVAL;
+        return IPC_FAILURE;
+    }
+
+    struct ipc_socket_trace *trace = (struct ipc_socket_trace *)calloc(1, sizeof(*trace));
+    if (!trace) {
+        return IPC_FAILURE;
+    }
+    trace->ring = ipc_trace_create(trace_name, capacity);
+    if (!trace->ring) {
+        free(trace);
+        return IPC_FAILURE;
+    }
+    if (setsockopt(sock->sockfd, SOL_SOCKET, SO_TIMESTAMPING, &flags, sizeof(flags)) == -1) {
+        ipc_trace_close(trace->ring);
+        free(trace);
+        return IPC_FAILURE;
+    }
+
+    sock->trace = trace;
+    return IPC_SUCCESS;
+}
+
+/**
+ * @brief Collect kernel TX timestamps that arrived since the last send.
+ *
+ * Sends collect them as a side effect; an application that stops sending can
+ * call this to complete the records of its last messages. The socket
+ * descriptor reports POLLERR while timestamps are queued.
+ *
+ * @param handle Pointer to the IPC socket handle.
+ * @return IPC_SUCCESS on success, IPC_FAILURE if tracing is not enabled.
+ */
+int ipc_socket_trace_poll(ipc_handle_t *handle) {
+    ipc_socket_t *sock = (ipc_socket_t *)handle;
+
+    if (!sock || !sock->trace) {
+        errno = EINVAL;
+        return IPC_FAILURE;
+    }
+    ipc_socket_trace_drain(sock);
+    return IPC_SUCCESS;
+}
+
+/**
+ * @brief Disable tracing on an IPC socket.
+ *
+ * Messages still waiting for TX timestamps are written with the stamps seen
+ * so far. The trace segment is unmapped but not removed, so readers can
+ * still open it; remove it with ipc_trace_unlink().
+ *
+ * @param handle Pointer to the IPC socket handle.
+ * @return IPC_SUCCESS on success, IPC_FAILURE on failure.
+ */
+int ipc_socket_disable_tracing(ipc_handle_t *handle) {
+    ipc_socket_t *sock = (ipc_socket_t *)handle;
+    int off = 0;
+
+    if (!sock) {
+        errno = EINVAL;
+        return IPC_FAILURE;
+    }
+    if (!sock->trace) {
+        return IPC_SUCCESS;
+    }
+
+    ipc_socket_trace_drain(sock);
+    while (sock->trace->tail != sock->trace->head) {
+        ipc_socket_trace_pop(sock->trace);
+    }
+    setsockopt(sock->sockfd, SOL_SOCKET, SO_TIMESTAMPING, &off, sizeof(off));
+    ipc_trace_close(sock->trace->ring);
+    free(sock->trace);
+    sock->trace = NULL;
+    return IPC_SUCCESS;
+}
+
+/**
+ * @brief Enable, resize or disable user-space write coalescing on an IPC socket.
+ *
+ * While enabled, `send` appends messages (with their frame headers) to a
+ * per-handle buffer instead of issuing one system call per message. The
+ * buffer is written in a single system call when:
+ * - it is full, or a message does not fit (buffer and message go together);
+ * - ipc_socket_flush() is called;
+ * - a send or ipc_socket_flush_due() finds the oldest buffered byte older
+ *   than flush_us;
+ * - before `receive` and ipc_send_file(), so request/response exchanges
+ *   never stall on buffered data.
+ *
+ * Unlike Nagle's algorithm the policy does not depend on ACK timing: nothing
+ * is held back once the application flushes. Connections accepted on a
+ * buffered server socket get the same settings.
+ *
+ * @param handle Pointer to the IPC socket handle.
+ * @param capacity Buffer size in bytes, or 0 to flush and disable buffering.
+ * @param flush_us Maximum time a message may wait in the buffer, in
+ *        microseconds, checked on each send; 0 to flush only when full or asked.
+ * @return IPC_SUCCESS on success, IPC_FAILURE on failure.
+ */
+int ipc_socket_set_write_buffer(ipc_handle_t *handle, size_t capacity, unsigned int flush_us) {
+    ipc_socket_t *sock = (ipc_socket_t *)handle;
+
+    if (!sock) {
+        errno = EINVAL;
+        return IPC_FAILURE;
+    }
+    if (ipc_socket_wbuf_flush(sock) != IPC_SUCCESS) {
+        return IPC_FAILURE;
+    }
+    free(sock->wbuf);
+    sock->wbuf = NULL;
+    if (capacity == 0) {
+        return IPC_SUCCESS;
+    }
+
+    sock->wbuf = (struct ipc_socket_wbuf *)calloc(1, sizeof(struct ipc_socket_wbuf) + capacity);
+    if (!sock->wbuf) {
+        return IPC_FAILURE;
+    }
+    sock->wbuf->cap = capacity;
+    sock->wbuf->delay_ns = (uint64_t)flush_us * 1000;
+    return IPC_SUCCESS;
+}
+
+/**
+ * @brief Send everything buffered by the write buffer now.
+ *
+ * @param handle Pointer to the IPC socket handle.
+ * @return IPC_SUCCESS on success, IPC_FAILURE on failure.
+ */
+int ipc_socket_flush(ipc_handle_t *handle) {
+    ipc_socket_t *sock = (ipc_socket_t *)handle;
+
+    if (!sock) {
+        errno = EINVAL;
+        return IPC_FAILURE;
+    }
+    return ipc_socket_wbuf_flush(sock);
+}
+
+/**
+ * @brief Flush the write buffer if its deadline has passed.
+ *
+ * Meant for event loops: call it on every iteration and use next_us as the
+ * upper bound of the poll timeout, so buffered messages never wait longer
+ * than the configured flush delay even if no further send happens.
+ *
+ * @param handle Pointer to the IPC socket handle.
+ * @param next_us If not NULL, receives the microseconds until the buffer is
+ *        due, or -1 if nothing is waiting on a deadline.
+ * @return IPC_SUCCESS on success, IPC_FAILURE on failure.
+ */
+int ipc_socket_flush_due(ipc_handle_t *handle, int *next_us) {
+    ipc_socket_t *sock = (ipc_socket_t *)handle;
+
+    if (!sock) {
+        errno = EINVAL;
+        return IPC_FAILURE;
+    }
+    if (next_us) {
+        *next_us = -1;
+    }
+    struct ipc_socket_wbuf *wb = sock->wbuf;
+    if (!wb || wb->len == 0 || wb->delay_ns == 0) {
+        return IPC_SUCCESS;
+    }
+    uint64_t now = ipc_socket_now_ns();
+    if (now >= wb->deadline_ns) {
+        return ipc_socket_wbuf_flush(sock);
+    }
+    if (next_us) {
+        *next_us = (int)((wb->deadline_ns - now + 999) / 1000);
+    }
+    return IPC_SUCCESS;
+}
+
+/**
+ * @brief Enable, resize or disable the read-ahead buffer of an IPC socket.
+ *
+ * With read-ahead, every read asks the kernel for as much data as the buffer
+ * holds, and `receive` and ipc_socket_receive_view() serve messages from the
+ * buffer until it runs dry. Connections accepted on a server socket with
+ * read-ahead get a buffer of the same size.
+ *
+ * @param handle Pointer to the IPC socket handle.
+ * @param capacity Buffer size in bytes, or 0 to disable read-ahead. It must
+ *        hold a frame header and checksum (EINVAL otherwise) and the bytes
+ *        already buffered (EBUSY otherwise).
+ * @return IPC_SUCCESS on success, IPC_FAILURE on failure.
+ */
+int ipc_socket_set_read_ahead(ipc_handle_t *handle, size_t capacity) {
+    ipc_socket_t *sock = (ipc_socket_t *)handle;
+
+    if (!sock || (capacity != 0 && capacity < IPC_FRAME_HDR_SIZE + IPC_CRC32C_SIZE)) {
+        errno = EINVAL;
+        return IPC_FAILURE;
+    }
+    struct ipc_socket_rbuf *old = sock->rbuf;
+    size_t buffered = old ? old->tail - old->head : 0;
+    if (buffered > capacity) {
+        errno = EBUSY;
+        return IPC_FAILURE;
+    }
+    if (capacity == 0) {
+        free(old);
+        sock->rbuf = NULL;
+        return IPC_SUCCESS;
+    }
+
+    struct ipc_socket_rbuf *rb = (struct ipc_socket_rbuf *)malloc(sizeof(struct ipc_socket_rbuf) + capacity);
+    if (!rb) {
+        return IPC_FAILURE;
+    }
+    rb->cap = capacity;
+    rb->head = 0;
+    rb->tail = buffered;
+    if (buffered) {
+        memcpy(rb->data, old->data + old->head, buffered);
+    }
+    free(old);
+    sock->rbuf = rb;
+    return IPC_SUCCESS;
+}
+
+/**
+ * @brief Receive the next message as a view into the read-ahead buffer.
+ *
+ * No copy is made: data points into the socket's read-ahead buffer and stays
+ * valid until the next receive on the handle. In framed mode the view is one
+ * whole message; a message larger than the buffer is discarded and the call
+ * fails with EMSGSIZE, one with a bad checksum with EBADMSG. Without framing
+ * the view covers all buffered bytes.
+ *
+ * @param handle Pointer to the IPC socket handle (see ipc_socket_set_read_ahead).
+ * @param data Receives a pointer to the message.
+ * @param len Receives the length of the message.
+ * @return IPC_SUCCESS on success, IPC_FAILURE on failure.
+ */
+int ipc_socket_receive_view(ipc_handle_t *handle, const void **data, size_t *len) {
+    ipc_socket_t *sock = (ipc_socket_t *)handle;
+
+    if (!sock || !sock->rbuf || !data || !len) {
+        errno = EINVAL;
+        return IPC_FAILURE;
+    }
+    if (ipc_socket_wbuf_flush(sock) != IPC_SUCCESS) {
+        return IPC_FAILURE;
+    }
+
+    struct ipc_socket_rbuf *rb = sock->rbuf;
+    if (!sock->framed) {
+        if (ipc_socket_rbuf_fill(sock, 1) != IPC_SUCCESS) {
+            return IPC_FAILURE;
+        }
+        *data = rb->data + rb->head;
+        *len = rb->tail - rb->head;
+        rb->head = rb->tail;
+    } else {
+        ipc_frame_hdr_t hdr;
+        if (ipc_socket_rbuf_fill(sock, IPC_FRAME_HDR_SIZE) != IPC_SUCCESS ||
+            ipc_frame_hdr_decode(rb->data + rb->head, &hdr) != IPC_SUCCESS) {
+            return IPC_FAILURE;
+        }
+        size_t crc_len = (hdr.flags & IPC_FRAME_FLAG_CRC32C) ? IPC_CRC32C_SIZE : 0;
+        if (hdr.length > rb->cap - IPC_FRAME_HDR_SIZE - crc_len) {
+            rb->head += IPC_FRAME_HDR_SIZE;
+            if (ipc_socket_read_full(sock, NULL, hdr.length + crc_len) == IPC_SUCCESS) {
+                errno = EMSGSIZE;
+            }
+            return IPC_FAILURE;
+        }
+        if (ipc_socket_rbuf_fill(sock, IPC_FRAME_HDR_SIZE + hdr.length + crc_len) != IPC_SUCCESS) {
+            return IPC_FAILURE;
+        }
+        const unsigned char *payload = rb->data + rb->head + IPC_FRAME_HDR_SIZE;
+        rb->head += IPC_FRAME_HDR_SIZE + hdr.length + crc_len;
+        if (ipc_socket_frame_verify(sock, &hdr, payload, payload + hdr.length) != IPC_SUCCESS) {
+            return IPC_FAILURE;
+        }
+        *data = payload;
+        *len = hdr.length;
+    }
+    if (sock->trace) {
+        ipc_socket_trace_rx(sock, *len);
+    }
+    return IPC_SUCCESS;
+}
+
+/**
+ * @brief Switch a connected IPC socket into (or out of) busy-poll mode.
+ *
+ * Busy-poll mode takes the scheduler wakeup off the receive path: the socket
+ * is made non-blocking and `receive` spins on recv() for up to spin_us
+ * microseconds before it falls back to blocking in poll(). The kernel is
+ * asked to busy-poll the device queue as well (SO_BUSY_POLL and
+ * SO_PREFER_BUSY_POLL); raising these above the system defaults needs
+ * CAP_NET_ADMIN, and without it the call silently keeps the user-space spin.
+ * Sends wait in poll() whenever the socket buffer is full, so their blocking
+ * behaviour is unchanged.
+ *
+ * If cpu is not negative, the calling thread is pinned to that CPU, so call
+ * this from the thread that will receive on the handle. Pinning is left in
+ * place when busy polling is turned off.
+ *
+ * @param handle Pointer to a connected IPC socket handle (not a listener).
+ * @param cpu CPU to pin the calling thread to (below CPU_SETSIZE), or -1 to
+ *        leave affinity alone.
+ * @param spin_us Spin budget in microseconds, or 0 to turn busy polling off.
+ * @return IPC_SUCCESS on success, IPC_FAILURE on failure.
+ */
+int ipc_socket_set_busy_poll(ipc_handle_t *handle, int cpu, unsigned int spin_us) {
+    ipc_socket_t *sock = (ipc_socket_t *)handle;
+
+    if (!sock || sock->is_server || spin_us > INT_MAX || cpu >= CPU_SETSIZE) {
+        errno = EINVAL;
+        return IPC_FAILURE;
+    }
+    if (spin_us && cpu >= 0) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        int err = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+        if (err) {
+            errno = err;
+            return IPC_FAILURE;
+        }
+    }
+
+    int flags = fcntl(sock->sockfd, F_GETFL);
+    if (flags == -1 ||
+        fcntl(sock->sockfd, F_SETFL, spin_us ? flags | O_NONBLOCK : flags & ~O_NONBLOCK) == -1) {
+        return IPC_FAILURE;
+    }
+    int busy = (int)spin_us;
+    int prefer = spin_us ? 1 : 0;
+    setsockopt(sock->sockfd, SOL_SOCKET, SO_BUSY_POLL, &busy, sizeof(busy));
+    setsockopt(sock->sockfd, SOL_SOCKET, SO_PREFER_BUSY_POLL, &prefer, sizeof(prefer));
+    sock->spin_us = spin_us;
+    return IPC_SUCCESS;
+}
@@ -0,0 +1,327 @@
+/**
+ * @file ipc_trace.c
+ * author Animesh0817 (mailtome.anni@gmail.com)
+ * @brief Implementation of the shared-memory latency trace.
+ */
+
+#include "ipc_trace.h"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+
+#define IPC_TRACE_MAGIC 0x49504354u /* "IPCT" */
+#define IPC_TRACE_VERSION 1u
+
+/**
+ * A Structure that will hold the layout of the shared segment:
+ * Header identifying the segment and its ring capacity
+ * Write position of the ring
+ * One histogram per latency stage
+ * Ring of records
+ */
+typedef struct {
+    uint32_t magic; /**< IPC_TRACE_MAGIC once the segment is initialized. */
+    uint32_t version; /**< Layout version. */
+    uint64_t capacity; /**< Number of records in the ring, a power of two. */
+    atomic_uint_fast64_t head; /**< Number of records ever written. */
+    ipc_trace_hist_t hist[IPC_TRACE_METRICS]; /**< Latency histograms. */
+    ipc_trace_record_t records[]; /**< Ring of records. */
+} ipc_trace_shm_t;
+
+struct ipc_trace {
+    ipc_trace_shm_t *shm; /**< Mapped segment. */
+    size_t map_size; /**< Size of the mapping. */
+};
+
+/**
+ * @brief Map a trace segment.
+ *
+ * @return The trace, or NULL on failure.
+ */
+static ipc_trace_t *ipc_trace_map(int fd, size_t size, int prot) {
+    ipc_trace_t *trace = (ipc_trace_t *)calloc(1, sizeof(ipc_trace_t));
+    if (!trace) {
+        return NULL;
+    }
+    trace->shm = (ipc_trace_shm_t *)mmap(NULL, size, prot, MAP_SHARED, fd, 0);
+    if (trace->shm == MAP_FAILED) {
+        free(trace);
+        return NULL;
+    }
+    trace->map_size = size;
+    return trace;
+}
+
+/**
+ * @brief Create (or reset) a named trace segment for writing.
+ *
+ * @param name POSIX shared-memory name, e.g. "/my_service_trace".
+ * @param capacity Number of records kept in the ring; rounded up to a power of two.
+ * @return The trace, or NULL on failure.
+ */
+ipc_trace_t *ipc_trace_create(const char *name, size_t capacity) {
+    size_t slots = 1;
+
+    if (!name || capacity == 0) {
+        errno = EINVAL;
+        return NULL;
+    }
+    while (slots < capacity) {
+        slots <<= 1;
+    }
+    size_t size = sizeof(ipc_trace_shm_t) + slots * sizeof(ipc_trace_record_t);
+
+    int fd = shm_open(name, O_CREAT | O_RDWR | O_CLOEXEC, 0644);
+    if (fd == -1) {
+        return NULL;
+    }
+    if (ftruncate(fd, 0) == -1 || ftruncate(fd, (off_t)size) == -1) {
+        close(fd);
+        return NULL;
+    }
+    ipc_trace_t *trace = ipc_trace_map(fd, size, PROT_READ | PROT_WRITE);
+    close(fd);
+    if (!trace) {
+        return NULL;
+    }
+
+    trace->shm->version = IPC_TRACE_VERSION;
+    trace->shm->capacity = slots;
+    atomic_init(&trace->shm->head, 0);
+    atomic_thread_fence(memory_order_release);
+    trace->shm->magic = IPC_TRACE_MAGIC;
+    return trace;
+}
+
+/**
+ * @brief Open an existing trace segment for reading.
+ *
+ * @param name POSIX shared-memory name used by the writer.
+ * @return The trace, or NULL on failure (errno EPROTO if the segment is not a trace).
+ */
+ipc_trace_t *ipc_trace_open(const char *name) {
+    struct stat st;
+
+    int fd = shm_open(name, O_RDONLY | O_CLOEXEC, 0);
+    if (fd == -1) {
+        return NULL;
+    }
+    if (fstat(fd, &st) == -1 || (size_t)st.st_size < sizeof(ipc_trace_shm_t)) {
+        close(fd);
+        errno = EPROTO;
+        return NULL;
+    }
+    ipc_trace_t *trace = ipc_trace_map(fd, (size_t)st.st_size, PROT_READ);
+    close(fd);
+    if (!trace) {
+        return NULL;
+    }
+
+    const ipc_trace_shm_t *shm = trace->shm;
+    if (shm->magic != IPC_TRACE_MAGIC || shm->version != IPC_TRACE_VERSION ||
+        sizeof(ipc_trace_shm_t) + shm->capacity * sizeof(ipc_trace_record_t) > trace->map_size) {
+        ipc_trace_close(trace);
+        errno = EPROTO;
+        return NULL;
+    }
+    return trace;
+}
+
+/**
+ * @brief Unmap a trace. The segment itself stays until ipc_trace_unlink().
+ *
+ * @param trace Trace to close.
+ */
+void ipc_trace_close(ipc_trace_t *trace) {
+    if (trace) {
+        munmap(trace->shm, trace->map_size);
+        free(trace);
+    }
+}
+
+/**
+ * @brief Remove a named trace segment.
+ *
+ * @param name POSIX shared-memory name.
+ * @return IPC_SUCCESS on success, IPC_FAILURE on failure.
+ */
+int ipc_trace_unlink(const char *name) {
+    return shm_unlink(name) == 0 ? IPC_SUCCESS : IPC_FAILURE;
+}
+
+/**
+ * @brief Current time on the clock used by kernel software timestamps.
+ *
+ * @return CLOCK_REALTIME in nanoseconds.
+ */
+uint64_t ipc_trace_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief Add one sample to a histogram.
+ */
+static void ipc_trace_hist_add(ipc_trace_hist_t *hist, uint64_t from_ns, uint64_t to_ns) {
+    if (!from_ns || !to_ns || to_ns < from_ns) {
+        return;
+    }
+    uint64_t delta = to_ns - from_ns;
+    int bucket = delta ? 64 - __builtin_clzll(delta) : 0;
+    if (bucket >= IPC_TRACE_BUCKETS) {
+        bucket = IPC_TRACE_BUCKETS - 1;
+    }
+    atomic_fetch_add_explicit(&hist->buckets[bucket], 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&hist->count, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&hist->sum_ns, delta, memory_order_relaxed);
+}
+
+/**
+ * @brief Append a record to the ring and update the histograms.
+ *
+ * There must be a single writer per trace.
+ *
+ * @param trace Trace opened with ipc_trace_create().
+ * @param rec Record to append; its seq field is ignored.
+ * @return IPC_SUCCESS on success, IPC_FAILURE on failure.
+ */
+int ipc_trace_record(ipc_trace_t *trace, const ipc_trace_record_t *rec) {
+    if (!trace || !rec) {
+        errno = EINVAL;
+        return IPC_FAILURE;
+    }
+    ipc_trace_shm_t *shm = trace->shm;
+
+    if (rec->kind == IPC_TRACE_KIND_TX) {
+        ipc_trace_hist_add(&shm->hist[IPC_TRACE_TX_STACK], rec->user_ns, rec->sched_ns);
+        ipc_trace_hist_add(&shm->hist[IPC_TRACE_TX_KERNEL], rec->sched_ns, rec->kernel_ns);
+        ipc_trace_hist_add(&shm->hist[IPC_TRACE_TX_PEER], rec->kernel_ns, rec->ack_ns);
+    } else {
+        ipc_trace_hist_add(&shm->hist[IPC_TRACE_RX_QUEUE], rec->kernel_ns, rec->user_ns);
+    }
+
+    uint64_t pos = atomic_load_explicit(&shm->head, memory_order_relaxed);
+    ipc_trace_record_t *slot = &shm->records[pos & (shm->capacity - 1)];
+    _Atomic uint64_t *seq = (_Atomic uint64_t *)&slot->seq;
+
+    // Seqlock style publication: readers discard a slot whose seq changes
+    atomic_store_explicit(seq, 0, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    slot->kind = rec->kind;
+    slot->len = rec->len;
+    slot->user_ns = rec->user_ns;
+    slot->sched_ns = rec->sched_ns;
+    slot->kernel_ns = rec->kernel_ns;
+    slot->ack_ns = rec->ack_ns;
+    atomic_store_explicit(seq, pos + 1, memory_order_release);
+    atomic_store_explicit(&shm->head, pos + 1, memory_order_release);
+    return IPC_SUCCESS;
+}
+
+/**
+ * @brief Copy records from the ring, starting at a cursor.
+ *
+ * If the writer has lapped the cursor, reading resumes at the oldest record
+ * still in the ring.
+ *
+ * @param trace Trace.
+ * @param cursor In: position of the next record to read (start with 0).
+ *        Out: position after the last record returned.
+ * @param out Destination array.
+ * @param max Capacity of out.
+ * @return Number of records copied.
+ */
+size_t ipc_trace_read(ipc_trace_t *trace, uint64_t *cursor, ipc_trace_record_t *out, size_t max) {
+    ipc_trace_shm_t *shm = trace->shm;
+    uint64_t head = atomic_load_explicit(&shm->head, memory_order_acquire);
+    uint64_t pos = *cursor;
+    size_t n = 0;
+
+    if (head - pos > shm->capacity) {
+        pos = head - shm->capacity;
+    }
+    while (pos < head && n < max) {
+        const ipc_trace_record_t *slot = &shm->records[pos & (shm->capacity - 1)];
+        _Atomic uint64_t *seq = (_Atomic uint64_t *)&slot->seq;
+
+        uint64_t before = atomic_load_explicit(seq, memory_order_acquire);
+        out[n] = *slot;
+        atomic_thread_fence(memory_order_acquire);
+        uint64_t after = atomic_load_explicit(seq, memory_order_relaxed);
+        if (before == pos + 1 && after == before) {
+            out[n].seq = before;
+            n++;
+        }
+        pos++;
+    }
+    *cursor = pos;
+    return n;
+}
+
+/**
+ * @brief Snapshot a latency histogram.
+ *
+ * @param trace Trace.
+ * @param metric ipc_trace_metric_t.
+ * @param buckets If not NULL, receives the per-bucket counts.
+ * @param count If not NULL, receives the number of samples.
+ * @param sum_ns If not NULL, receives the sum of all samples.
+ * @return IPC_SUCCESS on success, IPC_FAILURE on failure.
+ */
+int ipc_trace_histogram(ipc_trace_t *trace, int metric, uint64_t buckets[IPC_TRACE_BUCKETS],
+                        uint64_t *count, uint64_t *sum_ns) {
+    if (!trace || metric < 0 || metric >= IPC_TRACE_METRICS) {
+        errno = EINVAL;
+        return IPC_FAILURE;
+    }
+    ipc_trace_hist_t *hist = &trace->shm->hist[metric];
+
+    if (buckets) {
+        for (int i = 0; i < IPC_TRACE_BUCKETS; i++) {
+            buckets[i] = atomic_load_explicit(&hist->buckets[i], memory_order_relaxed);
+        }
+    }
+    if (count) {
+        *count = atomic_load_explicit(&hist->count, memory_order_relaxed);
+    }
+    if (sum_ns) {
+        *sum_ns = atomic_load_explicit(&hist->sum_ns, memory_order_relaxed);
+    }
+    return IPC_SUCCESS;
+}
+
+/**
+ * @brief Estimate a latency percentile from a histogram.
+ *
+ * @param trace Trace.
+ * @param metric ipc_trace_metric_t.
+ * @param pct Percentile as a fraction, e.g. 0.99.
+ * @return Upper bound in nanoseconds of the bucket holding the percentile,
+ *         or 0 if the histogram is empty.
+ */
+uint64_t ipc_trace_percentile(ipc_trace_t *trace, int metric, double pct) {
+    uint64_t buckets[IPC_TRACE_BUCKETS];
+    uint64_t count = 0;
+    uint64_t seen = 0;
+
+    if (ipc_trace_histogram(trace, metric, buckets, &count, NULL) != IPC_SUCCESS || count == 0) {
+        return 0;
+    }
+    uint64_t target = (uint64_t)(pct * (double)count);
+    if (target >= count) {
+        target = count - 1;
+    }
+    for (int i = 0; i < IPC_TRACE_BUCKETS; i++) {
+        seen += buckets[i];
+        if (seen > target) {
+            return i >= 63 ? UINT64_MAX : (1ull << i);
+        }
+    }
+    return UINT64_MAX;
+}
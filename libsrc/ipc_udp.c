@@ -0,0 +1,549 @@
+/**
+ * @file ipc_udp.c
+ * author Animesh0817 (mailtome.anni@gmail.com)
+ * @brief Implementation of IPC using batched UDP datagrams.
+ */
+
+#define _GNU_SOURCE /* sendmmsg(), recvmmsg() */
+
+#include "ipc_udp.h"
+#include <netinet/udp.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+
+#ifndef SOL_UDP
+#define SOL_UDP 17
+#endif
+#ifndef UDP_SEGMENT
+#define UDP_SEGMENT 103
+#endif
+#ifndef UDP_GRO
+#define UDP_GRO 104
+#endif
+
+/**
+ * @def IPC_UDP_GRO_SLOT
+ * @brief Receive slot size when GRO may coalesce several datagrams into one buffer.
+ */
+#define IPC_UDP_GRO_SLOT 65536
+
+/**
+ * A Structure that will hold the following:
+ * Receive slots, slot bytes each
+ * recvmmsg() descriptors with one iovec, source address and control buffer per slot
+ */
+struct ipc_udp_rx {
+    size_t slot; /**< Size of one receive slot. */
+    struct mmsghdr msgs[IPC_UDP_MAX_BATCH]; /**< recvmmsg() descriptors. */
+    struct iovec iov[IPC_UDP_MAX_BATCH]; /**< One iovec per receive slot. */
+    struct sockaddr_in from[IPC_UDP_MAX_BATCH]; /**< Sender of each received slot. */
+    char ctrl[IPC_UDP_MAX_BATCH][CMSG_SPACE(sizeof(int))]; /**< UDP_GRO segment size. */
+    unsigned char buf[]; /**< Receive slots. */
+};
+
+/**
+ * @brief (Re)allocate the receive slots for the current batch and offload settings.
+ *
+ * @param udp Pointer to the IPC UDP socket.
+ * @return IPC_SUCCESS on success, IPC_FAILURE on failure.
+ */
+static int ipc_udp_alloc_rx(ipc_udp_t *udp) {
+    size_t slot = udp->gro ? IPC_UDP_GRO_SLOT : udp->max_msg;
+    struct ipc_udp_rx *rx = (struct ipc_udp_rx *)malloc(sizeof(*rx) + slot * udp->batch);
+    if (!rx) {
+        return IPC_FAILURE;
+    }
+    free(udp->rx);
+    udp->rx = rx;
+    rx->slot = slot;
+    udp->rx_count = 0;
+    udp->rx_next = 0;
+    udp->rx_off = 0;
+    return IPC_SUCCESS;
+}
+
+/**
+ * @brief Initialize the IPC UDP socket.
+ *
+ * @param handle Pointer to the IPC UDP handle.
+ * @return IPC_SUCCESS on success, IPC_FAILURE on failure.
+ */
+static int ipc_udp_init(ipc_handle_t *handle) {
+    ipc_udp_t *udp = (ipc_udp_t *)handle;
+
+    if (udp->is_server) {
+        // Server: Bind
+        if (bind(udp->sockfd, (struct sockaddr *)&udp->addr, sizeof(udp->addr)) == -1) {
+            return IPC_FAILURE;
+        }
+    } else {
+        // Client: Fix the peer so plain send() can be used
+        if (connect(udp->sockfd, (struct sockaddr *)&udp->addr, sizeof(udp->addr)) == -1) {
+            return IPC_FAILURE;
+        }
+    }
+    return IPC_SUCCESS;
+}
+
+/**
+ * @brief Send the queued datagrams as one UDP_SEGMENT buffer.
+ *
+ * @param udp Pointer to the IPC UDP socket.
+ * @return IPC_SUCCESS on success, IPC_FAILURE on failure.
+ */
+static int ipc_udp_flush_gso(ipc_udp_t *udp) {
+    char ctrl[CMSG_SPACE(sizeof(uint16_t))] = {0};
+    struct iovec iov = { .iov_base = udp->tx_buf, .iov_len = udp->tx_used };
+    struct msghdr msg = {0};
+    uint16_t gso_size = (uint16_t)udp->tx_len[0];
+
+    if (udp->is_server) {
+        msg.msg_name = &udp->tx_to[0];
+        msg.msg_namelen = sizeof(udp->tx_to[0]);
+    }
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = ctrl;
+    msg.msg_controllen = sizeof(ctrl);
+
+    struct cmsghdr *cm = CMSG_FIRSTHDR(&msg);
+    cm->cmsg_level = SOL_UDP;
+    cm->cmsg_type = UDP_SEGMENT;
+    cm->cmsg_len = CMSG_LEN(sizeof(gso_size));
+    memcpy(CMSG_DATA(cm), &gso_size, sizeof(gso_size));
+
+    ssize_t sent;
+    do {
+        sent = sendmsg(udp->sockfd, &msg, 0);
+    } while (sent == -1 && errno == EINTR);
+
+    return sent == -1 ? IPC_FAILURE : IPC_SUCCESS;
+}
+
+/**
+ * @brief Send the queued datagrams with sendmmsg().
+ *
+ * @param udp Pointer to the IPC UDP socket.
+ * @return IPC_SUCCESS on success, IPC_FAILURE on failure.
+ */
+static int ipc_udp_flush_mmsg(ipc_udp_t *udp) {
+    struct mmsghdr msgs[IPC_UDP_MAX_BATCH];
+    struct iovec iov[IPC_UDP_MAX_BATCH];
+    size_t off = 0;
+    size_t done = 0;
+
+    memset(msgs, 0, sizeof(msgs[0]) * udp->tx_count);
+    for (size_t i = 0; i < udp->tx_count; i++) {
+        iov[i].iov_base = udp->tx_buf + off;
+        iov[i].iov_len = udp->tx_len[i];
+        msgs[i].msg_hdr.msg_iov = &iov[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+        if (udp->is_server) {
+            msgs[i].msg_hdr.msg_name = &udp->tx_to[i];
+            msgs[i].msg_hdr.msg_namelen = sizeof(udp->tx_to[i]);
+        }
+        off += udp->tx_len[i];
+    }
+
+    while (done < udp->tx_count) {
+        int sent = sendmmsg(udp->sockfd, msgs + done, udp->tx_count - done, 0);
+        if (sent == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return IPC_FAILURE;
+        }
+        done += sent;
+    }
+    return IPC_SUCCESS;
+}
+
+/**
+ * @brief Check whether the queued datagrams can be sent as one GSO buffer.
+ *
+ * All datagrams must have the same size except the last, which may be shorter,
+ * and a server's replies must all go to the same client.
+ */
+static int ipc_udp_gso_eligible(const ipc_udp_t *udp) {
+    if (!udp->gso || udp->tx_count < 2 || udp->tx_len[0] == 0) {
+        return 0;
+    }
+    for (size_t i = 1; i < udp->tx_count; i++) {
+        if (udp->tx_len[i] > udp->tx_len[0] ||
+            (i < udp->tx_count - 1 && udp->tx_len[i] != udp->tx_len[0])) {
+            return 0;
+        }
+        if (udp->is_server && (udp->tx_to[i].sin_addr.s_addr != udp->tx_to[0].sin_addr.s_addr ||
+                               udp->tx_to[i].sin_port != udp->tx_to[0].sin_port)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/**
+ * @brief Send all queued datagrams.
+ *
+ * The queue is emptied even on failure: like any UDP loss, datagrams that
+ * could not be sent are dropped.
+ *
+ * @param handle Pointer to the IPC UDP handle.
+ * @return IPC_SUCCESS on success, IPC_FAILURE on failure.
+ */
+int ipc_udp_flush(ipc_handle_t *handle) {
+    ipc_udp_t *udp = (ipc_udp_t *)handle;
+    int ret;
+
+    if (!udp) {
+        errno = EINVAL;
+        return IPC_FAILURE;
+    }
+    if (udp->tx_count == 0) {
+        return IPC_SUCCESS;
+    }
+
+    if (ipc_udp_gso_eligible(udp)) {
+        ret = ipc_udp_flush_gso(udp);
+        if (ret != IPC_SUCCESS && (errno == EIO || errno == EINVAL || errno == ENOPROTOOPT)) {
+            // Device or path without segmentation offload
+            udp->gso = 0;
+            ret = ipc_udp_flush_mmsg(udp);
+        }
+    } else {
+        ret = ipc_udp_flush_mmsg(udp);
+    }
+
+    udp->tx_used = 0;
+    udp->tx_count = 0;
+    return ret;
+}
+
+/**
+ * @brief Send a datagram through the IPC UDP socket.
+ *
+ * With batching enabled the datagram is queued and sent when the batch is
+ * full or on ipc_udp_flush(). A server sends to the sender of the last
+ * datagram it received before this call, even if the datagram is flushed
+ * after later receives.
+ *
+ * @param handle Pointer to the IPC UDP handle.
+ * @param msg Pointer to the message to send.
+ * @param len Length of the message.
+ * @return IPC_SUCCESS on success, IPC_FAILURE on failure.
+ */
+static int ipc_udp_send(ipc_handle_t *handle, const void *msg, size_t len) {
+    ipc_udp_t *udp = (ipc_udp_t *)handle;
+
+    if (len > IPC_UDP_MAX_DATAGRAM) {
+        errno = EMSGSIZE;
+        return IPC_FAILURE;
+    }
+    if (udp->is_server && udp->peer.sin_family != AF_INET) {
+        errno = EDESTADDRREQ;
+        return IPC_FAILURE;
+    }
+
+    if (udp->batch <= 1 && udp->tx_count == 0) {
+        ssize_t sent;
+        do {
+            sent = udp->is_server
+                ? sendto(udp->sockfd, msg, len, 0, (struct sockaddr *)&udp->peer, sizeof(udp->peer))
+                : send(udp->sockfd, msg, len, 0);
+        } while (sent == -1 && errno == EINTR);
+        return sent == -1 ? IPC_FAILURE : IPC_SUCCESS;
+    }
+
+    if (udp->tx_used + len > IPC_UDP_MAX_DATAGRAM && ipc_udp_flush(handle) != IPC_SUCCESS) {
+        return IPC_FAILURE;
+    }
+    memcpy(udp->tx_buf + udp->tx_used, msg, len);
+    udp->tx_to[udp->tx_count] = udp->peer;
+    udp->tx_len[udp->tx_count++] = len;
+    udp->tx_used += len;
+
+    if (udp->tx_count >= udp->batch) {
+        return ipc_udp_flush(handle);
+    }
+    return IPC_SUCCESS;
+}
+
+/**
+ * @brief Refill the receive batch with one recvmmsg() call.
+ *
+ * Blocks until at least one datagram is available, then takes whatever else
+ * the kernel has queued, up to the batch size.
+ *
+ * @param udp Pointer to the IPC UDP socket.
+ * @return IPC_SUCCESS on success, IPC_FAILURE on failure.
+ */
+static int ipc_udp_fill(ipc_udp_t *udp) {
+    int n;
+
+    struct ipc_udp_rx *rx = udp->rx;
+
+    for (size_t i = 0; i < udp->batch; i++) {
+        rx->iov[i].iov_base = rx->buf + i * rx->slot;
+        rx->iov[i].iov_len = rx->slot;
+        memset(&rx->msgs[i], 0, sizeof(rx->msgs[i]));
+        rx->msgs[i].msg_hdr.msg_iov = &rx->iov[i];
+        rx->msgs[i].msg_hdr.msg_iovlen = 1;
+        rx->msgs[i].msg_hdr.msg_name = &rx->from[i];
+        rx->msgs[i].msg_hdr.msg_namelen = sizeof(rx->from[i]);
+        if (udp->gro) {
+            rx->msgs[i].msg_hdr.msg_control = rx->ctrl[i];
+            rx->msgs[i].msg_hdr.msg_controllen = sizeof(rx->ctrl[i]);
+        }
+    }
+
+    do {
+        n = recvmmsg(udp->sockfd, rx->msgs, udp->batch, MSG_WAITFORONE, NULL);
+    } while (n == -1 && errno == EINTR);
+    if (n <= 0) {
+        return IPC_FAILURE;
+    }
+
+    udp->rx_count = n;
+    udp->rx_next = 0;
+    udp->rx_off = 0;
+    return IPC_SUCCESS;
+}
+
+/**
+ * @brief Get the GRO segment size of a received slot.
+ *
+ * @return The segment size, or 0 if the slot holds a single datagram.
+ */
+static size_t ipc_udp_gro_size(ipc_udp_t *udp, size_t slot) {
+    struct msghdr *msg = &udp->rx->msgs[slot].msg_hdr;
+
+    if (!udp->gro) {
+        return 0;
+    }
+    for (struct cmsghdr *cm = CMSG_FIRSTHDR(msg); cm; cm = CMSG_NXTHDR(msg, cm)) {
+        if (cm->cmsg_level == SOL_UDP && cm->cmsg_type == UDP_GRO) {
+            int size;
+            memcpy(&size, CMSG_DATA(cm), sizeof(size));
+            return size > 0 ? (size_t)size : 0;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Receive a datagram from the IPC UDP socket.
+ *
+ * Datagrams left over from the last recvmmsg() call are returned without a
+ * syscall. A datagram larger than the buffer is dropped and the call fails
+ * with errno EMSGSIZE.
+ *
+ * @param handle Pointer to the IPC UDP handle.
+ * @param buf Buffer to store the received datagram.
+ * @param len Length of the buffer.
+ * @return Length of the datagram on success, IPC_FAILURE on failure.
+ */
+static int ipc_udp_receive(ipc_handle_t *handle, void *buf, size_t len) {
+    ipc_udp_t *udp = (ipc_udp_t *)handle;
+
+    if (udp->rx_next >= udp->rx_count && ipc_udp_fill(udp) != IPC_SUCCESS) {
+        return IPC_FAILURE;
+    }
+
+    size_t slot = udp->rx_next;
+    size_t total = udp->rx->msgs[slot].msg_len;
+    size_t seg = ipc_udp_gro_size(udp, slot);
+    int truncated = (udp->rx->msgs[slot].msg_hdr.msg_flags & MSG_TRUNC) != 0;
+
+    if (seg == 0 || seg > total - udp->rx_off) {
+        seg = total - udp->rx_off;
+    }
+    const unsigned char *data = udp->rx->buf + slot * udp->rx->slot + udp->rx_off;
+
+    udp->rx_off += seg;
+    if (udp->rx_off >= total) {
+        udp->rx_next++;
+        udp->rx_off = 0;
+    }
+    if (udp->is_server) {
+        udp->peer = udp->rx->from[slot];
+    }
+
+    if (truncated || seg > len) {
+        errno = EMSGSIZE;
+        return IPC_FAILURE;
+    }
+    memcpy(buf, data, seg);
+    return (int)seg;
+}
+
+/**
+ * @brief Get the pollable descriptor of the IPC UDP socket.
+ *
+ * @param handle Pointer to the IPC UDP handle.
+ * @return The socket file descriptor.
+ */
+static int ipc_udp_get_fd(ipc_handle_t *handle) {
+    ipc_udp_t *udp = (ipc_udp_t *)handle;
+    return udp->sockfd;
+}
+
+/**
+ * @brief Destroy the IPC UDP socket, flushing queued datagrams first.
+ *
+ * @param handle Pointer to the IPC UDP handle.
+ * @return IPC_SUCCESS on success, IPC_FAILURE on failure.
+ */
+static int ipc_udp_destroy(ipc_handle_t *handle) {
+    ipc_udp_t *udp = (ipc_udp_t *)handle;
+    int ret = IPC_SUCCESS;
+
+    ipc_udp_flush(handle);
+    if (close(udp->sockfd) == -1) {
+        ret = IPC_FAILURE;
+    }
+    free(udp->tx_buf);
+    free(udp->rx);
+    free(udp);
+    return ret;
+}
+
+/**
+ * @brief Create a new IPC UDP handle.
+ *
+ * @param address IP address to bind (server) or send to (client).
+ * @param port Port of the socket.
+ * @param is_server Flag to indicate if this is a server or client socket.
+ * @return Pointer to the created IPC UDP handle, or NULL on failure.
+ */
+ipc_handle_t *ipc_udp_create(const char *address, int port, int is_server) {
+    ipc_udp_t *udp = (ipc_udp_t *)calloc(1, sizeof(ipc_udp_t));
+    if (!udp) {
+        return NULL;
+    }
+
+    udp->sockfd = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    if (udp->sockfd == -1) {
+        free(udp);
+        return NULL;
+    }
+
+    udp->addr.sin_family = AF_INET;
+    udp->addr.sin_port = htons(port);
+    if (inet_pton(AF_INET, address, &udp->addr.sin_addr) <= 0) {
+        close(udp->sockfd);
+        free(udp);
+        return NULL;
+    }
+
+    udp->is_server = is_server;
+    udp->batch = 1;
+    udp->max_msg = IPC_UDP_MAX_DATAGRAM;
+    udp->tx_buf = (unsigned char *)malloc(IPC_UDP_MAX_DATAGRAM);
+    if (!udp->tx_buf || ipc_udp_alloc_rx(udp) != IPC_SUCCESS) {
+        free(udp->tx_buf);
+        close(udp->sockfd);
+        free(udp);
+        return NULL;
+    }
+
+    // Assign function pointers
+    udp->base.init = (int (*)(void *))ipc_udp_init;
+    udp->base.send = (int (*)(void *, const void *, size_t))ipc_udp_send;
+    udp->base.receive = (int (*)(void *, void *, size_t))ipc_udp_receive;
+    udp->base.destroy = (int (*)(void *))ipc_udp_destroy;
+    udp->base.accept = NULL;
+    udp->base.get_fd = (int (*)(void *))ipc_udp_get_fd;
+
+    return (ipc_handle_t *)udp;
+}
+
+/**
+ * @brief Configure send and receive batching.
+ *
+ * @param handle Pointer to the IPC UDP handle.
+ * @param batch Datagrams per sendmmsg()/recvmmsg() call, 1 to IPC_UDP_MAX_BATCH.
+ * @param max_msg Largest datagram expected on receive; larger ones are dropped.
+ * @return IPC_SUCCESS on success, IPC_FAILURE on failure (errno EBUSY while
+ *         received datagrams are still buffered).
+ */
+int ipc_udp_set_batch(ipc_handle_t *handle, size_t batch, size_t max_msg) {
+    ipc_udp_t *udp = (ipc_udp_t *)handle;
+
+    if (!udp || batch == 0 || batch > IPC_UDP_MAX_BATCH || max_msg == 0 || max_msg > IPC_UDP_MAX_DATAGRAM) {
+        errno = EINVAL;
+        return IPC_FAILURE;
+    }
+    if (udp->rx_next < udp->rx_count) {
+        errno = EBUSY;
+        return IPC_FAILURE;
+    }
+    if (ipc_udp_flush(handle) != IPC_SUCCESS) {
+        return IPC_FAILURE;
+    }
+
+    size_t old_batch = udp->batch;
+    size_t old_max = udp->max_msg;
+    udp->batch = batch;
+    udp->max_msg = max_msg;
+    if (ipc_udp_alloc_rx(udp) != IPC_SUCCESS) {
+        udp->batch = old_batch;
+        udp->max_msg = old_max;
+        return IPC_FAILURE;
+    }
+    return IPC_SUCCESS;
+}
+
+/**
+ * @brief Enable or disable UDP segmentation and receive offloads.
+ *
+ * @param handle Pointer to the IPC UDP handle.
+ * @param gso Non-zero to send equally sized batches as one UDP_SEGMENT buffer.
+ * @param gro Non-zero to let the kernel coalesce received datagrams (UDP_GRO).
+ * @return IPC_SUCCESS on success, IPC_FAILURE if the kernel lacks support
+ *         (errno ENOPROTOOPT) or received datagrams are still buffered (EBUSY).
+ */
+int ipc_udp_set_offload(ipc_handle_t *handle, int gso, int gro) {
+    ipc_udp_t *udp = (ipc_udp_t *)handle;
+    int zero = 0;
+    int on = gro ? 1 : 0;
+
+    if (!udp) {
+        errno = EINVAL;
+        return IPC_FAILURE;
+    }
+    if (udp->rx_next < udp->rx_count) {
+        errno = EBUSY;
+        return IPC_FAILURE;
+    }
+    // Probe for UDP_SEGMENT support; a zero size leaves segmentation per-call
+    if (gso && setsockopt(udp->sockfd, SOL_UDP, UDP_SEGMENT, &zero, sizeof(zero)) == -1) {
+        return IPC_FAILURE;
+    }
+    if ((gro || udp->gro) && setsockopt(udp->sockfd, SOL_UDP, UDP_GRO, &on, sizeof(on)) == -1) {
+        return IPC_FAILURE;
+    }
+
+    udp->gso = gso ? 1 : 0;
+    if (udp->gro != on) {
+        udp->gro = on;
+        return ipc_udp_alloc_rx(udp);
+    }
+    return IPC_SUCCESS;
+}
+
+/**
+ * @brief Get the number of received datagrams buffered in the handle.
+ *
+ * The socket descriptor does not become readable for datagrams that were
+ * already taken by recvmmsg(), so event loops should keep calling `receive`
+ * while this is non-zero. A GRO buffer counts as one entry.
+ *
+ * @param handle Pointer to the IPC UDP handle.
+ * @return Number of buffered receive slots not yet handed out.
+ */
+size_t ipc_udp_pending(ipc_handle_t *handle) {
+    ipc_udp_t *udp = (ipc_udp_t *)handle;
+    return udp ? udp->rx_count - udp->rx_next : 0;
+}
@@ -0,0 +1,74 @@
+/**
+ * @file ipc_test_pipe.h
+ * @brief In-memory message pipe shared by the tests of layers built on an ipc_handle_t.
+ *
+ * Define PIPE_SLOTS (messages queued per direction) and PIPE_MSG (largest
+ * message) before including this header to size the pipe for a test.
+ */
+
+#ifndef IPC_TEST_PIPE_H
+#define IPC_TEST_PIPE_H
+
+#include <stddef.h>
+#include <string.h>
+#include <errno.h>
+#include "ipc.h"
+
+#ifndef PIPE_SLOTS
+#define PIPE_SLOTS 16
+#endif
+
+#ifndef PIPE_MSG
+#define PIPE_MSG 256
+#endif
+
+/* Message-oriented loopback handle: send() queues into the peer's inbox. */
+typedef struct pipe_end {
+    ipc_handle_t base;
+    struct pipe_end *peer;
+    unsigned char msgs[PIPE_SLOTS][PIPE_MSG];
+    size_t lens[PIPE_SLOTS];
+    size_t head, tail;
+} pipe_end_t;
+
+static int pipe_send(void *ctx, const void *data, size_t size) {
+    pipe_end_t *peer = ((pipe_end_t *)ctx)->peer;
+    if (size > PIPE_MSG || peer->tail - peer->head == PIPE_SLOTS) {
+        errno = ENOBUFS;
+        return IPC_FAILURE;
+    }
+    memcpy(peer->msgs[peer->tail % PIPE_SLOTS], data, size);
+    peer->lens[peer->tail % PIPE_SLOTS] = size;
+    peer->tail++;
+    return IPC_SUCCESS;
+}
+
+static int pipe_receive(void *ctx, void *buffer, size_t size) {
+    pipe_end_t *end = (pipe_end_t *)ctx;
+    if (end->head == end->tail) {
+        errno = EAGAIN;
+        return IPC_FAILURE;
+    }
+    size_t len = end->lens[end->head % PIPE_SLOTS];
+    if (len > size) {
+        errno = EMSGSIZE;
+        return IPC_FAILURE;
+    }
+    memcpy(buffer, end->msgs[end->head % PIPE_SLOTS], len);
+    end->head++;
+    return (int)len;
+}
+
+/* Connect two ends to each other. */
+static void pipe_pair(pipe_end_t *a, pipe_end_t *b) {
+    memset(a, 0, sizeof(*a));
+    memset(b, 0, sizeof(*b));
+    a->base.send = pipe_send;
+    a->base.receive = pipe_receive;
+    b->base.send = pipe_send;
+    b->base.receive = pipe_receive;
+    a->peer = b;
+    b->peer = a;
+}
+
+#endif // IPC_TEST_PIPE_H
@@ -0,0 +1,106 @@
+/**
+ * @file test_ipc_crc32c.c
+ * @brief Unit tests for ipc_crc32c.c using CMockA.
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ipc_crc32c.h"
+
+/* Test the checksum against published CRC32C check values */
+static void test_ipc_crc32c_known_values(void **state) {
+    (void) state; // Unused variable
+
+    unsigned char zeros[32] = {0};
+    unsigned char ones[32];
+    memset(ones, 0xff, sizeof(ones));
+
+    assert_int_equal(ipc_crc32c(0, "", 0), 0);
+    assert_int_equal(ipc_crc32c(0, "123456789", 9), 0xe3069283);
+    assert_int_equal(ipc_crc32c(0, zeros, sizeof(zeros)), 0x8a9136aa);
+    assert_int_equal(ipc_crc32c(0, ones, sizeof(ones)), 0x62a8ab43);
+    assert_non_null(ipc_crc32c_backend());
+}
+
+/* Test that the environment can force the portable backend */
+static void test_ipc_crc32c_forced_backend(void **state) {
+    (void) state; // Unused variable
+
+    const char *force = getenv("IPC_CRC32C_BACKEND");
+    if (!force) {
+        skip(); // Registered a second time with the variable set
+    }
+    assert_string_equal(ipc_crc32c_backend(), force);
+}
+
+/* Test that chained and unaligned computations match a single pass */
+static void test_ipc_crc32c_chaining(void **state) {
+    (void) state; // Unused variable
+
+    unsigned char buf[1031];
+    for (size_t i = 0; i < sizeof(buf); i++) {
+        buf[i] = (unsigned char)(i * 131 + 7);
+    }
+    uint32_t whole = ipc_crc32c(0, buf, sizeof(buf));
+
+    for (size_t split = 0; split < 24; split++) {
+        uint32_t crc = ipc_crc32c(0, buf, split);
+        crc = ipc_crc32c(crc, buf + split, sizeof(buf) - split);
+        assert_int_equal(crc, whole);
+    }
+    buf[500] ^= 1;
+    assert_int_not_equal(ipc_crc32c(0, buf, sizeof(buf)), whole);
+}
+
+/* Bit-at-a-time CRC32C used as the reference for the accelerated paths */
+static uint32_t reference_crc32c(const unsigned char *p, size_t len) {
+    uint32_t crc = 0xffffffffu;
+
+    for (size_t i = 0; i < len; i++) {
+        crc ^= p[i];
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ (0x82f63b78u & (0u - (crc & 1)));
+        }
+    }
+    return ~crc;
+}
+
+/* Test buffers long enough for the three-stream path, at every misalignment */
+static void test_ipc_crc32c_long(void **state) {
+    (void) state; // Unused variable
+
+    // Three 8192-byte streams plus a tail that is not a multiple of 8
+    size_t len = 3 * 8192 * 2 + 1000 + 13;
+    unsigned char *buf = (unsigned char *)malloc(len + 8);
+    assert_non_null(buf);
+    for (size_t i = 0; i < len + 8; i++) {
+        buf[i] = (unsigned char)(i * 167 + (i >> 8));
+    }
+
+    for (size_t align = 0; align < 8; align++) {
+        const unsigned char *p = buf + align;
+        assert_int_equal(ipc_crc32c(0, p, len), reference_crc32c(p, len));
+        assert_int_equal(ipc_crc32c(0, p, 3 * 8192 + 5), reference_crc32c(p, 3 * 8192 + 5));
+        // A split inside the first stream must chain to the same value
+        uint32_t crc = ipc_crc32c(0, p, 4099);
+        assert_int_equal(ipc_crc32c(crc, p + 4099, len - 4099), reference_crc32c(p, len));
+    }
+    free(buf);
+}
+
+/* Main function for running the tests */
+int main(void) {
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(test_ipc_crc32c_known_values),
+        cmocka_unit_test(test_ipc_crc32c_forced_backend),
+        cmocka_unit_test(test_ipc_crc32c_chaining),
+        cmocka_unit_test(test_ipc_crc32c_long),
+    };
+
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
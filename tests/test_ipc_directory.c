@@ -0,0 +1,179 @@
+/**
+ * @file test_ipc_directory.c
+ * @brief Unit tests for ipc_directory.c using CMockA.
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "ipc_directory.h"
+#include "ipc_seqlock.h"
+
+static char dir_name[64];
+static char chan_name[64];
+
+static ipc_directory_entry_t make_entry(uint32_t transport, const char *address, int port) {
+    ipc_directory_entry_t entry;
+    memset(&entry, 0, sizeof(entry));
+    entry.transport = transport;
+    entry.port = port;
+    snprintf(entry.address, sizeof(entry.address), "%s", address);
+    return entry;
+}
+
+/* Test registering, updating and unregistering a channel */
+static void test_ipc_directory_register_lookup(void **state) {
+    (void) state; // Unused variable
+
+    ipc_directory_t *dir = ipc_directory_open(dir_name, 16);
+    ipc_directory_t *other = ipc_directory_open(dir_name, 0);
+    assert_non_null(dir);
+    assert_non_null(other);
+    ipc_directory_entry_t entry = make_entry(IPC_DIRECTORY_SOCKET, "127.0.0.1", 8080);
+    ipc_directory_entry_t found;
+
+    assert_int_equal(ipc_directory_lookup(other, "pricing", &found), IPC_FAILURE);
+    assert_int_equal(errno, ENOENT);
+
+    entry.flags = IPC_DIRECTORY_FRAMED;
+    assert_int_equal(ipc_directory_register(dir, "pricing", &entry), IPC_SUCCESS);
+    assert_int_equal(ipc_directory_lookup(other, "pricing", &found), IPC_SUCCESS);
+    assert_int_equal(found.transport, IPC_DIRECTORY_SOCKET);
+    assert_int_equal(found.flags, IPC_DIRECTORY_FRAMED);
+    assert_int_equal(found.port, 8080);
+    assert_int_equal(found.pid, getpid());
+    assert_string_equal(found.address, "127.0.0.1");
+
+    // Registering again updates the entry in place
+    entry.port = 8081;
+    assert_int_equal(ipc_directory_register(dir, "pricing", &entry), IPC_SUCCESS);
+    assert_int_equal(ipc_directory_lookup(other, "pricing", &found), IPC_SUCCESS);
+    assert_int_equal(found.port, 8081);
+
+    assert_int_equal(ipc_directory_unregister(dir, "pricing"), IPC_SUCCESS);
+    assert_int_equal(ipc_directory_lookup(other, "pricing", &found), IPC_FAILURE);
+    assert_int_equal(errno, ENOENT);
+    assert_int_equal(ipc_directory_unregister(dir, "pricing"), IPC_FAILURE);
+    assert_int_equal(errno, ENOENT);
+
+    // Invalid names and entries
+    char long_name[IPC_DIRECTORY_NAME_MAX + 1];
+    memset(long_name, 'x', sizeof(long_name) - 1);
+    long_name[sizeof(long_name) - 1] = '\0';
+    assert_int_equal(ipc_directory_register(dir, long_name, &entry), IPC_FAILURE);
+    assert_int_equal(errno, EINVAL);
+    assert_int_equal(ipc_directory_register(dir, "", &entry), IPC_FAILURE);
+    entry.transport = 0;
+    assert_int_equal(ipc_directory_register(dir, "bad", &entry), IPC_FAILURE);
+    assert_int_equal(errno, EINVAL);
+
+    ipc_directory_close(other);
+    ipc_directory_close(dir);
+}
+
+/* Test that colliding names fill the table and every one stays reachable */
+static void test_ipc_directory_full(void **state) {
+    (void) state; // Unused variable
+
+    ipc_directory_t *dir = ipc_directory_open(dir_name, 0);
+    assert_non_null(dir);
+    ipc_directory_entry_t entry = make_entry(IPC_DIRECTORY_SLAB, "/slab", 0);
+    ipc_directory_entry_t found;
+    char name[32];
+
+    // The table was created with 16 slots and "pricing" holds one of them
+    for (int i = 0; i < 15; i++) {
+        snprintf(name, sizeof(name), "chan-%d", i);
+        entry.port = i;
+        assert_int_equal(ipc_directory_register(dir, name, &entry), IPC_SUCCESS);
+    }
+    assert_int_equal(ipc_directory_register(dir, "one-too-many", &entry), IPC_FAILURE);
+    assert_int_equal(errno, ENOSPC);
+    for (int i = 0; i < 15; i++) {
+        snprintf(name, sizeof(name), "chan-%d", i);
+        assert_int_equal(ipc_directory_lookup(dir, name, &found), IPC_SUCCESS);
+        assert_int_equal(found.port, i);
+    }
+    assert_int_equal(ipc_directory_lookup(dir, "one-too-many", &found), IPC_FAILURE);
+    assert_int_equal(errno, ENOENT);
+
+    // An unregistered name keeps its slot and can come back
+    assert_int_equal(ipc_directory_unregister(dir, "chan-3"), IPC_SUCCESS);
+    assert_int_equal(ipc_directory_register(dir, "chan-3", &entry), IPC_SUCCESS);
+
+    ipc_directory_close(dir);
+}
+
+static void *register_later(void *arg) {
+    ipc_directory_t *dir = ipc_directory_open(dir_name, 0);
+    ipc_directory_entry_t entry = make_entry(IPC_DIRECTORY_SEQLOCK, chan_name, 0);
+    (void) arg;
+
+    // Create the channel before publishing it, as a server would
+    ipc_handle_t *chan = ipc_seqlock_create(chan_name, 64, 1);
+    usleep(50000);
+    chan->init(chan);
+    chan->send(chan, "ready", 5);
+    ipc_directory_register(dir, "late", &entry);
+    ipc_directory_close(dir);
+    return chan;
+}
+
+/* Test that a client waits for a channel and attaches to it */
+static void test_ipc_directory_wait_attach(void **state) {
+    (void) state; // Unused variable
+
+    ipc_directory_entry_t found;
+    pthread_t thread;
+    void *server;
+    char buf[64];
+
+    // Start over with a default-sized table; the full one is not needed
+    assert_int_equal(ipc_directory_unlink(dir_name), IPC_SUCCESS);
+    ipc_directory_t *dir = ipc_directory_open(dir_name, 0);
+    assert_non_null(dir);
+    assert_int_equal(ipc_directory_wait(dir, "late", &found, 20), IPC_FAILURE);
+    assert_int_equal(errno, ETIMEDOUT);
+
+    assert_int_equal(pthread_create(&thread, NULL, register_later, NULL), 0);
+    ipc_handle_t *chan = ipc_directory_attach(dir, "late", 5000);
+    assert_non_null(chan);
+    assert_int_equal(chan->receive(chan, buf, sizeof(buf)), 5);
+    assert_memory_equal(buf, "ready", 5);
+    chan->destroy(chan);
+
+    pthread_join(thread, &server);
+    ((ipc_handle_t *)server)->destroy((ipc_handle_t *)server);
+    ipc_seqlock_unlink(chan_name);
+
+    // A socket entry with nothing listening fails to attach
+    ipc_directory_entry_t entry = make_entry(IPC_DIRECTORY_SOCKET, "127.0.0.1", 1);
+    assert_int_equal(ipc_directory_register(dir, "down", &entry), IPC_SUCCESS);
+    assert_null(ipc_directory_attach(dir, "down", 0));
+    assert_int_equal(errno, ECONNREFUSED);
+
+    ipc_directory_close(dir);
+}
+
+/* Main function for running the tests */
+int main(void) {
+    snprintf(dir_name, sizeof(dir_name), "/test_ipc_directory_%d", (int)getpid());
+    snprintf(chan_name, sizeof(chan_name), "/test_ipc_directory_chan_%d", (int)getpid());
+
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(test_ipc_directory_register_lookup),
+        cmocka_unit_test(test_ipc_directory_full),
+        cmocka_unit_test(test_ipc_directory_wait_attach),
+    };
+
+    int ret = cmocka_run_group_tests(tests, NULL, NULL);
+    ipc_directory_unlink(dir_name);
+    return ret;
+}
@@ -0,0 +1,214 @@
+/**
+ * @file test_ipc_doorbell.c
+ * @brief Unit tests for ipc_doorbell.c and ipc_handle_get_fd() using CMockA.
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include "ipc_doorbell.h"
+#include "ipc_socket.h"
+#include "ipc_udp.h"
+
+static int readable(int fd, int timeout_ms) {
+    struct pollfd pfd = { .fd = fd, .events = POLLIN };
+
+    return poll(&pfd, 1, timeout_ms) == 1 && (pfd.revents & POLLIN);
+}
+
+static int local_port(ipc_handle_t *handle) {
+    struct sockaddr_in addr;
+    socklen_t addr_len = sizeof(addr);
+
+    assert_int_equal(getsockname(ipc_handle_get_fd(handle), (struct sockaddr *)&addr, &addr_len), 0);
+    return ntohs(addr.sin_port);
+}
+
+static void *ring_later(void *arg) {
+    usleep(20000);
+    ipc_doorbell_ring((ipc_doorbell_t *)arg);
+    return NULL;
+}
+
+/* Test that a ring only reaches a parked consumer, and only once */
+static void test_ipc_doorbell_park_ring(void **state) {
+    (void) state; // Unused variable
+    ipc_doorbell_t db;
+
+    assert_int_equal(ipc_doorbell_open(&db, NULL), IPC_SUCCESS);
+    int fd = ipc_doorbell_fd(&db);
+    assert_true(fd >= 0);
+
+    // Nobody is parked: the ring is free and wakes nothing
+    assert_int_equal(ipc_doorbell_ring(&db), IPC_SUCCESS);
+    assert_false(readable(fd, 0));
+
+    // Parked: the ring makes the fd readable, and further rings fold into it
+    ipc_doorbell_park(&db);
+    assert_false(readable(fd, 0));
+    assert_int_equal(ipc_doorbell_ring(&db), IPC_SUCCESS);
+    assert_true(readable(fd, 0));
+    assert_int_equal(ipc_doorbell_ring(&db), IPC_SUCCESS);
+    assert_int_equal(ipc_doorbell_wait(&db, 0), IPC_SUCCESS);
+
+    // Unparking consumes the wake-up, and later rings are free again
+    ipc_doorbell_unpark(&db);
+    assert_false(readable(fd, 0));
+    assert_int_equal(ipc_doorbell_ring(&db), IPC_SUCCESS);
+    assert_false(readable(fd, 0));
+    assert_int_equal(ipc_doorbell_wait(&db, 10), IPC_FAILURE);
+    assert_int_equal(errno, ETIMEDOUT);
+
+    ipc_doorbell_close(&db);
+    assert_int_equal(ipc_doorbell_fd(&db), -1);
+}
+
+/* Test that a doorbell attached to a shared eventfd and parked word wakes its peer */
+static void test_ipc_doorbell_attach(void **state) {
+    (void) state; // Unused variable
+    ipc_doorbell_t consumer, producer;
+    atomic_uint parked;
+    pthread_t thread;
+
+    atomic_init(&parked, 0);
+    assert_int_equal(ipc_doorbell_open(&consumer, &parked), IPC_SUCCESS);
+    assert_int_equal(ipc_doorbell_attach(&producer, -1, &parked), IPC_FAILURE);
+    assert_int_equal(errno, EINVAL);
+    assert_int_equal(ipc_doorbell_attach(&producer, ipc_doorbell_fd(&consumer), &parked), IPC_SUCCESS);
+
+    // The producer sees the consumer's park through the shared word
+    ipc_doorbell_park(&consumer);
+    assert_int_equal(pthread_create(&thread, NULL, ring_later, &producer), 0);
+    assert_int_equal(ipc_doorbell_wait(&consumer, 5000), IPC_SUCCESS);
+    pthread_join(thread, NULL);
+    ipc_doorbell_unpark(&consumer);
+    assert_false(readable(ipc_doorbell_fd(&consumer), 0));
+
+    // Only the owner closes the eventfd
+    int fd = ipc_doorbell_fd(&consumer);
+    ipc_doorbell_close(&producer);
+    assert_true(fcntl(fd, F_GETFD) != -1);
+    ipc_doorbell_close(&consumer);
+    assert_int_equal(fcntl(fd, F_GETFD), -1);
+}
+
+/* Test the futex deadline and seqcount helpers shared by the shared-memory backends */
+static void test_ipc_doorbell_sync_helpers(void **state) {
+    (void) state; // Unused variable
+    struct timespec ts;
+    atomic_uint word;
+    atomic_uint_fast64_t seq;
+    uint64_t begun;
+
+    assert_null(ipc_futex_deadline(&ts, -1));
+    assert_ptr_equal(ipc_futex_deadline(&ts, 1500), &ts);
+    assert_true(ts.tv_nsec >= 0 && ts.tv_nsec < 1000000000L);
+
+    // A stale value returns at once, a current one sleeps until the deadline
+    atomic_init(&word, 1);
+    assert_int_equal(ipc_futex_wait(&word, 0, ipc_futex_deadline(&ts, 1000)), IPC_SUCCESS);
+    assert_int_equal(ipc_futex_wait(&word, 1, ipc_futex_deadline(&ts, 10)), IPC_FAILURE);
+    assert_int_equal(errno, ETIMEDOUT);
+
+    atomic_init(&seq, 0);
+    assert_int_equal(ipc_seqcount_read_begin(&seq, &begun), IPC_SUCCESS);
+    assert_int_equal(ipc_seqcount_read_end(&seq, begun), IPC_SUCCESS);
+
+    // A read overlapping a write must be retried
+    uint64_t written = ipc_seqcount_write_begin(&seq);
+    assert_int_equal(written, 0);
+    assert_int_equal(ipc_seqcount_read_begin(&seq, &begun), IPC_FAILURE);
+    assert_int_equal(ipc_seqcount_read_end(&seq, 0), IPC_FAILURE);
+    ipc_seqcount_write_end(&seq, written);
+    assert_int_equal(ipc_seqcount_read_begin(&seq, &begun), IPC_SUCCESS);
+    assert_int_equal(begun, 2);
+}
+
+/* Test ipc_handle_get_fd() on socket handles and handles without a descriptor */
+static void test_ipc_handle_get_fd_socket(void **state) {
+    (void) state; // Unused variable
+    ipc_handle_t none;
+    int type;
+    socklen_t type_len = sizeof(type);
+
+    assert_int_equal(ipc_handle_get_fd(NULL), IPC_FAILURE);
+    memset(&none, 0, sizeof(none));
+    assert_int_equal(ipc_handle_get_fd(&none), IPC_FAILURE);
+
+    ipc_handle_t *server = ipc_socket_create("127.0.0.1", 0, 1);
+    assert_non_null(server);
+    assert_int_equal(server->init(server), IPC_SUCCESS);
+    int fd = ipc_handle_get_fd(server);
+    assert_int_equal(fd, server->get_fd(server));
+    assert_int_equal(getsockopt(fd, SOL_SOCKET, SO_TYPE, &type, &type_len), 0);
+    assert_int_equal(type, SOCK_STREAM);
+
+    // The listening fd becomes readable with a pending connection
+    assert_false(readable(fd, 0));
+    ipc_handle_t *client = ipc_socket_create("127.0.0.1", local_port(server), 0);
+    assert_non_null(client);
+    assert_int_equal(client->init(client), IPC_SUCCESS);
+    assert_true(readable(fd, 5000));
+    ipc_handle_t *conn = server->accept(server);
+    assert_non_null(conn);
+
+    // The connection's fd becomes readable with pending data
+    assert_false(readable(ipc_handle_get_fd(conn), 0));
+    assert_int_equal(client->send(client, "ping", 4), IPC_SUCCESS);
+    assert_true(readable(ipc_handle_get_fd(conn), 5000));
+
+    conn->destroy(conn);
+    client->destroy(client);
+    server->destroy(server);
+}
+
+/* Test ipc_handle_get_fd() on UDP handles */
+static void test_ipc_handle_get_fd_udp(void **state) {
+    (void) state; // Unused variable
+    int type;
+    socklen_t type_len = sizeof(type);
+
+    ipc_handle_t *rx = ipc_udp_create("127.0.0.1", 0, 1);
+    assert_non_null(rx);
+    assert_int_equal(rx->init(rx), IPC_SUCCESS);
+    int fd = ipc_handle_get_fd(rx);
+    assert_int_equal(fd, rx->get_fd(rx));
+    assert_int_equal(getsockopt(fd, SOL_SOCKET, SO_TYPE, &type, &type_len), 0);
+    assert_int_equal(type, SOCK_DGRAM);
+
+    ipc_handle_t *tx = ipc_udp_create("127.0.0.1", local_port(rx), 0);
+    assert_non_null(tx);
+    assert_int_equal(tx->init(tx), IPC_SUCCESS);
+    assert_true(ipc_handle_get_fd(tx) >= 0);
+    assert_true(ipc_handle_get_fd(tx) != fd);
+
+    assert_false(readable(fd, 0));
+    assert_int_equal(tx->send(tx, "ping", 4), IPC_SUCCESS);
+    assert_true(readable(fd, 5000));
+
+    tx->destroy(tx);
+    rx->destroy(rx);
+}
+
+/* Main function for running the tests */
+int main(void) {
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(test_ipc_doorbell_park_ring),
+        cmocka_unit_test(test_ipc_doorbell_attach),
+        cmocka_unit_test(test_ipc_doorbell_sync_helpers),
+        cmocka_unit_test(test_ipc_handle_get_fd_socket),
+        cmocka_unit_test(test_ipc_handle_get_fd_udp),
+    };
+
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
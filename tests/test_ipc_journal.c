@@ -0,0 +1,363 @@
+/**
+ * @file test_ipc_journal.c
+ * @brief Unit tests for ipc_journal.c using CMockA.
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <poll.h>
+#include <pthread.h>
+#include "ipc_journal.h"
+
+static char journal_dir[64];
+
+static ipc_handle_t *open_journal(void) {
+    ipc_handle_t *log = ipc_journal_create(journal_dir, 4096);
+    assert_non_null(log);
+    assert_int_equal(log->init(log), IPC_SUCCESS);
+    return log;
+}
+
+static void remove_journal(void) {
+    char cmd[128];
+    snprintf(cmd, sizeof(cmd), "rm -rf %s", journal_dir);
+    assert_int_equal(system(cmd), 0);
+}
+
+/* Test that records are read back in order and reading stops at the tail */
+static void test_ipc_journal_append_receive(void **state) {
+    (void) state; // Unused variable
+
+    ipc_handle_t *log = open_journal();
+    char buf[64];
+
+    assert_int_equal(log->send(log, "alpha", 5), IPC_SUCCESS);
+    assert_int_equal(log->send(log, "bravo!", 6), IPC_SUCCESS);
+
+    assert_int_equal(log->receive(log, buf, sizeof(buf)), 5);
+    assert_memory_equal(buf, "alpha", 5);
+    assert_int_equal(log->receive(log, buf, sizeof(buf)), 6);
+    assert_memory_equal(buf, "bravo!", 6);
+    assert_int_equal(log->receive(log, buf, sizeof(buf)), IPC_FAILURE);
+    assert_int_equal(errno, EAGAIN);
+    assert_int_equal(ipc_journal_position(log), ipc_journal_tail(log));
+
+    log->destroy(log);
+    remove_journal();
+}
+
+/* Test that records survive reopening and crossing segment boundaries */
+static void test_ipc_journal_replay(void **state) {
+    (void) state; // Unused variable
+
+    ipc_handle_t *writer = open_journal();
+    char rec[1000];
+    uint64_t offsets[20];
+
+    for (int i = 0; i < 20; i++) {
+        memset(rec, 'a' + i, sizeof(rec));
+        assert_int_equal(ipc_journal_append(writer, rec, sizeof(rec), &offsets[i]), IPC_SUCCESS);
+    }
+    writer->destroy(writer);
+
+    // A new handle, as after a restart, resumes from a saved offset
+    ipc_handle_t *reader = open_journal();
+    const void *data;
+    size_t len;
+
+    assert_int_equal(ipc_journal_seek(reader, offsets[5]), IPC_SUCCESS);
+    for (int i = 5; i < 20; i++) {
+        assert_int_equal(ipc_journal_read_view(reader, &data, &len), IPC_SUCCESS);
+        assert_int_equal(len, sizeof(rec));
+        assert_int_equal(((const char *)data)[0], 'a' + i);
+        assert_int_equal(((const char *)data)[len - 1], 'a' + i);
+    }
+    assert_int_equal(ipc_journal_read_view(reader, &data, &len), IPC_FAILURE);
+
+    // Older segments can be dropped once consumed
+    assert_int_equal(ipc_journal_truncate(reader, offsets[10]), IPC_SUCCESS);
+    assert_int_equal(ipc_journal_seek(reader, offsets[0]), IPC_FAILURE);
+    assert_int_equal(errno, ERANGE);
+
+    reader->destroy(reader);
+    remove_journal();
+}
+
+/* Test that a record left half-written by a crashed writer is skipped */
+static void test_ipc_journal_recover(void **state) {
+    (void) state; // Unused variable
+
+    ipc_handle_t *log = open_journal();
+    const void *data;
+    size_t len;
+    uint64_t offset;
+
+    assert_int_equal(ipc_journal_append(log, "one", 3, &offset), IPC_SUCCESS);
+    assert_int_equal(ipc_journal_append(log, "two", 3, &offset), IPC_SUCCESS);
+    assert_int_equal(ipc_journal_append(log, "three", 5, NULL), IPC_SUCCESS);
+
+    // Simulate a writer that reserved "two" and died before publishing it
+    ipc_journal_t *jnl = (ipc_journal_t *)log;
+    ipc_journal_read_view(log, &data, &len);
+    uint32_t *word = (uint32_t *)((unsigned char *)data - IPC_JOURNAL_HDR_SIZE + 16);
+    *word = (1u << 29) | 3;
+    jnl->r_pos = 0;
+
+    assert_int_equal(ipc_journal_read_view(log, &data, &len), IPC_SUCCESS);
+    assert_int_equal(ipc_journal_read_view(log, &data, &len), IPC_FAILURE);
+    assert_int_equal(errno, EAGAIN);
+
+    assert_int_equal(ipc_journal_seek(log, offset), IPC_SUCCESS);
+    assert_int_equal(ipc_journal_recover(log), 1);
+    assert_int_equal(ipc_journal_read_view(log, &data, &len), IPC_SUCCESS);
+    assert_int_equal(len, 5);
+    assert_memory_equal(data, "three", 5);
+
+    assert_int_equal(ipc_journal_wait(log, 10), IPC_FAILURE);
+    assert_int_equal(errno, ETIMEDOUT);
+
+    log->destroy(log);
+    remove_journal();
+}
+
+/* Test that checksummed records detect corruption and plain records still read */
+static void test_ipc_journal_checksum(void **state) {
+    (void) state; // Unused variable
+
+    ipc_handle_t *log = open_journal();
+    const void *data;
+    size_t len;
+
+    assert_int_equal(ipc_journal_append(log, "plain", 5, NULL), IPC_SUCCESS);
+    assert_int_equal(ipc_journal_set_checksum(log, 1), IPC_SUCCESS);
+    assert_int_equal(ipc_journal_append(log, "sealed", 6, NULL), IPC_SUCCESS);
+    assert_int_equal(ipc_journal_append(log, "intact", 6, NULL), IPC_SUCCESS);
+
+    assert_int_equal(ipc_journal_read_view(log, &data, &len), IPC_SUCCESS);
+    assert_memory_equal(data, "plain", 5);
+    uint64_t sealed = ipc_journal_position(log);
+    assert_int_equal(ipc_journal_read_view(log, &data, &len), IPC_SUCCESS);
+    assert_memory_equal(data, "sealed", 6);
+
+    // Flip a payload bit as a torn or damaged segment would
+    ((unsigned char *)data)[2] ^= 0x10;
+    assert_int_equal(ipc_journal_seek(log, sealed), IPC_SUCCESS);
+    assert_int_equal(ipc_journal_read_view(log, &data, &len), IPC_FAILURE);
+    assert_int_equal(errno, EBADMSG);
+    assert_int_equal(ipc_journal_read_view(log, &data, &len), IPC_SUCCESS);
+    assert_memory_equal(data, "intact", 6);
+
+    // Without verification the damaged record is returned as is
+    assert_int_equal(ipc_journal_set_checksum(log, 0), IPC_SUCCESS);
+    assert_int_equal(ipc_journal_seek(log, sealed), IPC_SUCCESS);
+    assert_int_equal(ipc_journal_read_view(log, &data, &len), IPC_SUCCESS);
+    assert_int_equal(len, 6);
+
+    log->destroy(log);
+    remove_journal();
+}
+
+/* Test that a reader left behind by a truncation fails instead of stalling */
+static void test_ipc_journal_truncate_reader(void **state) {
+    (void) state; // Unused variable
+
+    ipc_handle_t *writer = open_journal();
+    ipc_handle_t *reader = open_journal();
+    char rec[1000], path[128];
+    uint64_t offsets[20];
+    const void *data;
+    size_t len;
+
+    for (int i = 0; i < 20; i++) {
+        memset(rec, 'a' + i, sizeof(rec));
+        assert_int_equal(ipc_journal_append(writer, rec, sizeof(rec), &offsets[i]), IPC_SUCCESS);
+    }
+    assert_int_equal(ipc_journal_read_view(reader, &data, &len), IPC_SUCCESS);
+    assert_int_equal(ipc_journal_seek(reader, 0), IPC_SUCCESS);
+
+    // The reader is still at 0 when the segments before offsets[10] go away
+    assert_int_equal(ipc_journal_truncate(writer, offsets[10]), IPC_SUCCESS);
+    assert_int_equal(ipc_journal_read_view(reader, &data, &len), IPC_FAILURE);
+    assert_int_equal(errno, ERANGE);
+    assert_int_equal(ipc_journal_wait(reader, -1), IPC_SUCCESS);
+    assert_int_equal(ipc_journal_recover(reader), IPC_FAILURE);
+    assert_int_equal(errno, ERANGE);
+    snprintf(path, sizeof(path), "%s/%016llx.seg", journal_dir, 0ULL);
+    assert_int_equal(access(path, F_OK), -1);
+
+    // Resuming at the head returns every retained record
+    assert_int_equal(ipc_journal_seek(reader, ipc_journal_head(reader)), IPC_SUCCESS);
+    int first = -1, count = 0;
+    while (ipc_journal_read_view(reader, &data, &len) == IPC_SUCCESS) {
+        if (first < 0) {
+            first = ((const char *)data)[0] - 'a';
+        }
+        assert_int_equal(((const char *)data)[0], 'a' + first + count);
+        count++;
+    }
+    assert_int_equal(errno, EAGAIN);
+    assert_true(first >= 0 && first <= 10);
+    assert_int_equal(first + count, 20);
+
+    reader->destroy(reader);
+    writer->destroy(writer);
+    remove_journal();
+}
+
+/* Test that the doorbell returned by get_fd wakes a poller when a record is appended */
+static void test_ipc_journal_doorbell(void **state) {
+    (void) state; // Unused variable
+
+    ipc_handle_t *reader = open_journal();
+    ipc_handle_t *writer = open_journal();
+    char buf[16];
+
+    int fd = ipc_handle_get_fd(reader);
+    assert_true(fd >= 0);
+    struct pollfd pfd = { .fd = fd, .events = POLLIN };
+    assert_int_equal(ipc_journal_attach_doorbell(writer, fd), IPC_SUCCESS);
+
+    // An empty read arms the doorbell; the append rings it
+    assert_int_equal(reader->receive(reader, buf, sizeof(buf)), IPC_FAILURE);
+    assert_int_equal(errno, EAGAIN);
+    assert_int_equal(poll(&pfd, 1, 0), 0);
+    assert_int_equal(writer->send(writer, "ding", 4), IPC_SUCCESS);
+    assert_int_equal(poll(&pfd, 1, 1000), 1);
+    assert_int_equal(reader->receive(reader, buf, sizeof(buf)), 4);
+    assert_memory_equal(buf, "ding", 4);
+
+    // Reading the record consumed the wake-up
+    assert_int_equal(poll(&pfd, 1, 0), 0);
+    assert_int_equal(reader->receive(reader, buf, sizeof(buf)), IPC_FAILURE);
+    assert_int_equal(poll(&pfd, 1, 0), 0);
+
+    writer->destroy(writer);
+    reader->destroy(reader);
+    remove_journal();
+}
+
+#define WRITERS 4
+#define RECORDS_PER_WRITER 2000
+
+typedef struct {
+    uint32_t writer; /**< Index of the writing thread. */
+    uint32_t seq; /**< Record number within the writer. */
+} tagged_t;
+
+typedef struct {
+    ipc_handle_t *log; /**< Handle owned by the writing thread. */
+    uint32_t index; /**< Index of the writing thread. */
+} writer_t;
+
+static void *append_tagged(void *arg) {
+    writer_t *w = (writer_t *)arg;
+    ipc_handle_t *log = w->log;
+    unsigned char rec[200];
+    tagged_t tag;
+
+    tag.writer = w->index;
+    for (tag.seq = 0; tag.seq < RECORDS_PER_WRITER; tag.seq++) {
+        // Varying sizes make reservations straddle segment ends
+        size_t len = sizeof(tag) + (tag.seq * 37 + tag.writer * 11) % (sizeof(rec) - sizeof(tag));
+        memcpy(rec, &tag, sizeof(tag));
+        memset(rec + sizeof(tag), (int)(tag.seq & 0xff), len - sizeof(tag));
+        if (log->send(log, rec, len) != IPC_SUCCESS) {
+            break;
+        }
+    }
+    return NULL;
+}
+
+/* Test concurrent appenders followed by a live reader across segment rolls */
+static void test_ipc_journal_concurrent(void **state) {
+    (void) state; // Unused variable
+
+    ipc_handle_t *reader = open_journal();
+    writer_t writers[WRITERS];
+    pthread_t threads[WRITERS];
+    uint32_t next[WRITERS] = {0};
+    const void *data;
+    size_t len;
+    int total = 0;
+
+    for (int i = 0; i < WRITERS; i++) {
+        writers[i].log = open_journal();
+        writers[i].index = (uint32_t)i;
+    }
+    for (int i = 0; i < WRITERS; i++) {
+        assert_int_equal(pthread_create(&threads[i], NULL, append_tagged, &writers[i]), 0);
+    }
+
+    // Every record arrives exactly once, in each writer's order
+    while (total < WRITERS * RECORDS_PER_WRITER) {
+        if (ipc_journal_read_view(reader, &data, &len) != IPC_SUCCESS) {
+            assert_int_equal(errno, EAGAIN);
+            assert_int_equal(ipc_journal_wait(reader, 5000), IPC_SUCCESS);
+            continue;
+        }
+        tagged_t tag;
+        assert_true(len >= sizeof(tag));
+        memcpy(&tag, data, sizeof(tag));
+        assert_true(tag.writer < WRITERS);
+        assert_int_equal(tag.seq, next[tag.writer]);
+        assert_int_equal(len, sizeof(tag) + (tag.seq * 37 + tag.writer * 11) % (200 - sizeof(tag)));
+        if (len > sizeof(tag)) {
+            assert_int_equal(((const unsigned char *)data)[len - 1], tag.seq & 0xff);
+        }
+        next[tag.writer]++;
+        total++;
+    }
+    for (int i = 0; i < WRITERS; i++) {
+        pthread_join(threads[i], NULL);
+        writers[i].log->destroy(writers[i].log);
+    }
+    assert_int_equal(ipc_journal_read_view(reader, &data, &len), IPC_FAILURE);
+    assert_int_equal(errno, EAGAIN);
+    assert_true(ipc_journal_tail(reader) > 4096 * 10);
+
+    reader->destroy(reader);
+    remove_journal();
+}
+
+/* Test argument validation */
+static void test_ipc_journal_invalid(void **state) {
+    (void) state; // Unused variable
+
+    assert_null(ipc_journal_create(NULL, 0));
+    assert_null(ipc_journal_create(journal_dir, 1000));
+
+    ipc_handle_t *log = open_journal();
+    static char big[4096];
+    assert_int_equal(log->send(log, big, sizeof(big)), IPC_FAILURE);
+    assert_int_equal(errno, EMSGSIZE);
+    assert_int_equal(ipc_journal_seek(log, 8), IPC_FAILURE);
+
+    log->destroy(log);
+    remove_journal();
+}
+
+/* Main function for running the tests */
+int main(void) {
+    snprintf(journal_dir, sizeof(journal_dir), "/tmp/test_ipc_journal_%d", (int)getpid());
+
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(test_ipc_journal_append_receive),
+        cmocka_unit_test(test_ipc_journal_replay),
+        cmocka_unit_test(test_ipc_journal_recover),
+        cmocka_unit_test(test_ipc_journal_checksum),
+        cmocka_unit_test(test_ipc_journal_truncate_reader),
+        cmocka_unit_test(test_ipc_journal_doorbell),
+        cmocka_unit_test(test_ipc_journal_concurrent),
+        cmocka_unit_test(test_ipc_journal_invalid),
+    };
+
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,159 @@
+/**
+ * @file test_ipc_mux.c
+ * @brief Unit tests for ipc_mux.c using CMockA over an in-memory message pipe.
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include "ipc.h"
+#include "ipc_mux.h"
+
+#define PIPE_SLOTS 64
+#define PIPE_MSG 64
+#define CHUNK 16
+#include "ipc_test_pipe.h"
+
+static pipe_end_t a, b;
+
+/* Test that a large message is chunked and reassembled, small ones pass through */
+static void test_ipc_mux_reassembly(void **state) {
+    (void) state; // Unused variable
+    pipe_pair(&a, &b);
+
+    ipc_mux_t *tx = ipc_mux_create(&a.base, CHUNK, 1024);
+    ipc_mux_t *rx = ipc_mux_create(&b.base, CHUNK, 1024);
+    unsigned char big[100];
+    const void *msg;
+    size_t len;
+    unsigned int lane;
+
+    for (size_t i = 0; i < sizeof(big); i++) {
+        big[i] = (unsigned char)i;
+    }
+    assert_int_equal(ipc_mux_open_lane(tx, 7, 0, 1), IPC_SUCCESS);
+    assert_int_equal(ipc_mux_send(tx, 7, big, sizeof(big)), IPC_SUCCESS);
+    assert_int_equal(b.tail, 7); // ceil(100 / 16) chunks
+    assert_int_equal(ipc_mux_send(tx, 7, "hi", 2), IPC_SUCCESS);
+    assert_int_equal(ipc_mux_send(tx, 7, NULL, 0), IPC_SUCCESS);
+
+    assert_int_equal(ipc_mux_receive(rx, &lane, &msg, &len), IPC_SUCCESS);
+    assert_int_equal(lane, 7);
+    assert_int_equal(len, sizeof(big));
+    assert_memory_equal(msg, big, sizeof(big));
+    assert_int_equal(ipc_mux_receive(rx, &lane, &msg, &len), IPC_SUCCESS);
+    assert_int_equal(len, 2);
+    assert_memory_equal(msg, "hi", 2);
+    assert_int_equal(ipc_mux_receive(rx, &lane, &msg, &len), IPC_SUCCESS);
+    assert_int_equal(len, 0);
+
+    ipc_mux_destroy(tx);
+    ipc_mux_destroy(rx);
+}
+
+/* Test that an urgent lane overtakes a bulk transfer queued before it */
+static void test_ipc_mux_priority(void **state) {
+    (void) state; // Unused variable
+    pipe_pair(&a, &b);
+
+    ipc_mux_t *tx = ipc_mux_create(&a.base, CHUNK, 1024);
+    ipc_mux_t *rx = ipc_mux_create(&b.base, CHUNK, 1024);
+    unsigned char bulk[200] = {0};
+    const void *msg;
+    size_t len;
+    unsigned int lane;
+
+    ipc_mux_open_lane(tx, 1, 3, 1);
+    ipc_mux_open_lane(tx, 2, 0, 1);
+    assert_int_equal(ipc_mux_queue(tx, 1, bulk, sizeof(bulk)), IPC_SUCCESS);
+    assert_int_equal(ipc_mux_queue(tx, 2, "stop", 4), IPC_SUCCESS);
+    assert_int_equal(ipc_mux_flush(tx), IPC_SUCCESS);
+
+    assert_int_equal(ipc_mux_receive(rx, &lane, &msg, &len), IPC_SUCCESS);
+    assert_int_equal(lane, 2);
+    assert_memory_equal(msg, "stop", 4);
+    assert_int_equal(ipc_mux_receive(rx, &lane, &msg, &len), IPC_SUCCESS);
+    assert_int_equal(lane, 1);
+    assert_int_equal(len, sizeof(bulk));
+
+    ipc_mux_destroy(tx);
+    ipc_mux_destroy(rx);
+}
+
+/* Test that lanes of one class share the wire in proportion to their weight */
+static void test_ipc_mux_weights(void **state) {
+    (void) state; // Unused variable
+    pipe_pair(&a, &b);
+
+    ipc_mux_t *tx = ipc_mux_create(&a.base, CHUNK, 1024);
+    unsigned char data[8 * CHUNK] = {0};
+    int count[2] = {0, 0};
+
+    ipc_mux_open_lane(tx, 3, 1, 1);
+    ipc_mux_open_lane(tx, 4, 1, 3);
+    ipc_mux_queue(tx, 3, data, sizeof(data));
+    ipc_mux_queue(tx, 4, data, sizeof(data));
+    assert_int_equal(ipc_mux_flush(tx), IPC_SUCCESS);
+    assert_int_equal(b.tail, 16);
+
+    for (int i = 0; i < 8; i++) {
+        count[b.msgs[i][0] - 3]++;
+    }
+    assert_int_equal(count[0], 2);
+    assert_int_equal(count[1], 6);
+
+    ipc_mux_destroy(tx);
+}
+
+/* Test error handling: oversized messages, closed lanes and transport failures */
+static void test_ipc_mux_errors(void **state) {
+    (void) state; // Unused variable
+    pipe_pair(&a, &b);
+
+    ipc_mux_t *tx = ipc_mux_create(&a.base, CHUNK, 1024);
+    ipc_mux_t *rx = ipc_mux_create(&b.base, CHUNK, 32);
+    unsigned char data[48] = {0};
+    const void *msg;
+    size_t len;
+    unsigned int lane;
+
+    assert_int_equal(ipc_mux_send(tx, 5, "x", 1), IPC_FAILURE);
+    assert_int_equal(errno, EINVAL);
+    assert_int_equal(ipc_mux_open_lane(tx, 5, IPC_MUX_PRIORITIES, 1), IPC_FAILURE);
+    assert_int_equal(ipc_mux_open_lane(tx, 5, 0, 0), IPC_FAILURE);
+
+    ipc_mux_open_lane(tx, 5, 0, 1);
+    ipc_mux_send(tx, 5, data, sizeof(data));
+    ipc_mux_send(tx, 5, "ok", 2);
+    assert_int_equal(ipc_mux_receive(rx, &lane, &msg, &len), IPC_FAILURE);
+    assert_int_equal(errno, EMSGSIZE);
+    assert_int_equal(ipc_mux_receive(rx, &lane, &msg, &len), IPC_SUCCESS);
+    assert_memory_equal(msg, "ok", 2);
+
+    // Fill the pipe: the failed send poisons the stream
+    unsigned char big[(PIPE_SLOTS + 1) * CHUNK] = {0};
+    assert_int_equal(ipc_mux_send(tx, 5, big, sizeof(big)), IPC_FAILURE);
+    assert_int_equal(errno, ENOBUFS);
+    assert_int_equal(ipc_mux_send(tx, 5, "x", 1), IPC_FAILURE);
+    assert_int_equal(errno, ENOBUFS);
+
+    ipc_mux_destroy(tx);
+    ipc_mux_destroy(rx);
+}
+
+/* Main function for running the tests */
+int main(void) {
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(test_ipc_mux_reassembly),
+        cmocka_unit_test(test_ipc_mux_priority),
+        cmocka_unit_test(test_ipc_mux_weights),
+        cmocka_unit_test(test_ipc_mux_errors),
+    };
+
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
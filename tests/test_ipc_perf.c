@@ -0,0 +1,83 @@
+/**
+ * @file test_ipc_perf.c
+ * @brief Unit tests for ipc_perf.c using CMockA.
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include "ipc_perf.h"
+
+/* Test counter names and argument checks */
+static void test_ipc_perf_names(void **state) {
+    (void) state; // Unused variable
+
+    ipc_perf_sample_t sample;
+
+    assert_string_equal(ipc_perf_counter_name(IPC_PERF_CACHE_MISSES), "cache-misses");
+    assert_string_equal(ipc_perf_counter_name(IPC_PERF_SYSCALLS), "syscalls");
+    assert_string_equal(ipc_perf_counter_name(IPC_PERF_COUNTERS), "unknown");
+    assert_int_equal(ipc_perf_available(NULL), 0);
+    assert_int_equal(ipc_perf_start(NULL), IPC_FAILURE);
+    assert_int_equal(errno, EINVAL);
+    assert_int_equal(ipc_perf_stop(NULL, &sample), IPC_FAILURE);
+    assert_int_equal(errno, EINVAL);
+    ipc_perf_close(NULL);
+}
+
+/* Test counting a workload with whatever counters the machine provides */
+static void test_ipc_perf_measure(void **state) {
+    (void) state; // Unused variable
+
+    ipc_perf_sample_t sample;
+    ipc_perf_t *perf = ipc_perf_open(0);
+    if (!perf) {
+        // No PMU and perf_event_paranoid forbids software events
+        assert_int_not_equal(errno, 0);
+        return;
+    }
+    uint32_t available = ipc_perf_available(perf);
+    assert_int_not_equal(available, 0);
+
+    assert_int_equal(ipc_perf_start(perf), IPC_SUCCESS);
+    for (int i = 0; i < 1000; i++) {
+        getppid();
+    }
+    usleep(1000);
+    assert_int_equal(ipc_perf_stop(perf, &sample), IPC_SUCCESS);
+
+    assert_true(sample.elapsed_ns >= 1000000);
+    assert_int_equal(sample.valid & ~available, 0);
+    if (sample.valid & (1u << IPC_PERF_SYSCALLS)) {
+        assert_true(sample.value[IPC_PERF_SYSCALLS] >= 1000);
+    }
+    if (sample.valid & (1u << IPC_PERF_INSTRUCTIONS)) {
+        assert_true(sample.value[IPC_PERF_INSTRUCTIONS] > 0);
+    }
+    if (sample.valid & (1u << IPC_PERF_CONTEXT_SWITCHES)) {
+        assert_true(sample.value[IPC_PERF_CONTEXT_SWITCHES] >= 1); // usleep blocks
+    }
+
+    // Counters start from zero again
+    assert_int_equal(ipc_perf_start(perf), IPC_SUCCESS);
+    assert_int_equal(ipc_perf_stop(perf, &sample), IPC_SUCCESS);
+    if (sample.valid & (1u << IPC_PERF_SYSCALLS)) {
+        assert_true(sample.value[IPC_PERF_SYSCALLS] < 1000);
+    }
+    ipc_perf_close(perf);
+}
+
+/* Main function for running the tests */
+int main(void) {
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(test_ipc_perf_names),
+        cmocka_unit_test(test_ipc_perf_measure),
+    };
+
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
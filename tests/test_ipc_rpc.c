@@ -0,0 +1,198 @@
+/**
+ * @file test_ipc_rpc.c
+ * @brief Unit tests for ipc_rpc.c using CMockA over an in-memory message pipe.
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ipc.h"
+#include "ipc_rpc.h"
+
+#define PIPE_SLOTS 16
+#define PIPE_MSG 256
+#include "ipc_test_pipe.h"
+
+static uint64_t deferred_id;
+
+/* Echo handler: answers immediately. */
+static int echo_handler(ipc_rpc_t *rpc, uint64_t id, const void *req, size_t len, void *user) {
+    (void)user;
+    return ipc_rpc_respond(rpc, id, IPC_RPC_OK, req, len);
+}
+
+/* Deferred handler: remembers the call and answers later. */
+static int deferred_handler(ipc_rpc_t *rpc, uint64_t id, const void *req, size_t len, void *user) {
+    (void)rpc; (void)req; (void)len; (void)user;
+    deferred_id = id;
+    return IPC_SUCCESS;
+}
+
+/* Failing handler. */
+static int failing_handler(ipc_rpc_t *rpc, uint64_t id, const void *req, size_t len, void *user) {
+    (void)rpc; (void)id; (void)req; (void)len; (void)user;
+    return IPC_FAILURE;
+}
+
+typedef struct {
+    int order[4];
+    int count;
+} completion_log_t;
+
+typedef struct {
+    completion_log_t *log;
+    int tag;
+    int status;
+    char data[32];
+} completion_t;
+
+static void on_complete(ipc_rpc_t *rpc, int status, const void *resp, size_t len, void *user) {
+    completion_t *c = (completion_t *)user;
+    (void)rpc;
+    c->status = status;
+    memcpy(c->data, resp, len < sizeof(c->data) ? len : sizeof(c->data));
+    c->log->order[c->log->count++] = c->tag;
+}
+
+/* Test pipelined calls completing out of order */
+static void test_ipc_rpc_out_of_order(void **state) {
+    (void) state; // Unused variable
+
+    pipe_end_t client_end, server_end;
+    pipe_pair(&client_end, &server_end);
+    ipc_rpc_t *client = ipc_rpc_create(&client_end.base, 64, 8);
+    ipc_rpc_t *server = ipc_rpc_create(&server_end.base, 64, 8);
+    assert_non_null(client);
+    assert_non_null(server);
+    assert_int_equal(ipc_rpc_register(server, 1, echo_handler, NULL), IPC_SUCCESS);
+    assert_int_equal(ipc_rpc_register(server, 2, deferred_handler, NULL), IPC_SUCCESS);
+
+    completion_log_t log = {0};
+    completion_t slow = { .log = &log, .tag = 1 };
+    completion_t fast = { .log = &log, .tag = 2 };
+    uint64_t slow_id, fast_id;
+
+    assert_int_equal(ipc_rpc_call_async(client, 2, "slow", 5, on_complete, &slow, &slow_id), IPC_SUCCESS);
+    assert_int_equal(ipc_rpc_call_async(client, 1, "fast", 5, on_complete, &fast, &fast_id), IPC_SUCCESS);
+    assert_int_not_equal(slow_id, fast_id);
+    assert_int_equal(ipc_rpc_pending(client), 2);
+
+    assert_int_equal(ipc_rpc_poll(server), IPC_SUCCESS); // deferred
+    assert_int_equal(ipc_rpc_poll(server), IPC_SUCCESS); // echoed at once
+    assert_int_equal(ipc_rpc_respond(server, deferred_id, IPC_RPC_OK, "done", 5), IPC_SUCCESS);
+
+    assert_int_equal(ipc_rpc_poll(client), IPC_SUCCESS);
+    assert_int_equal(ipc_rpc_poll(client), IPC_SUCCESS);
+    assert_int_equal(ipc_rpc_pending(client), 0);
+
+    assert_int_equal(log.count, 2);
+    assert_int_equal(log.order[0], 2);
+    assert_int_equal(log.order[1], 1);
+    assert_string_equal(fast.data, "fast");
+    assert_string_equal(slow.data, "done");
+
+    ipc_rpc_destroy(client);
+    ipc_rpc_destroy(server);
+}
+
+/* Test error statuses for unknown methods and failing handlers */
+static void test_ipc_rpc_errors(void **state) {
+    (void) state; // Unused variable
+
+    pipe_end_t client_end, server_end;
+    pipe_pair(&client_end, &server_end);
+    ipc_rpc_t *client = ipc_rpc_create(&client_end.base, 64, 8);
+    ipc_rpc_t *server = ipc_rpc_create(&server_end.base, 64, 8);
+    assert_int_equal(ipc_rpc_register(server, 3, failing_handler, NULL), IPC_SUCCESS);
+    assert_int_equal(ipc_rpc_register(server, IPC_RPC_MAX_METHODS, echo_handler, NULL), IPC_FAILURE);
+
+    completion_log_t log = {0};
+    completion_t missing = { .log = &log, .tag = 1 };
+    completion_t failing = { .log = &log, .tag = 2 };
+
+    assert_int_equal(ipc_rpc_call_async(client, 9, NULL, 0, on_complete, &missing, NULL), IPC_SUCCESS);
+    assert_int_equal(ipc_rpc_call_async(client, 3, NULL, 0, on_complete, &failing, NULL), IPC_SUCCESS);
+    assert_int_equal(ipc_rpc_poll(server), IPC_SUCCESS);
+    assert_int_equal(ipc_rpc_poll(server), IPC_SUCCESS);
+    assert_int_equal(ipc_rpc_poll(client), IPC_SUCCESS);
+    assert_int_equal(ipc_rpc_poll(client), IPC_SUCCESS);
+
+    assert_int_equal(missing.status, IPC_RPC_ERR_NO_METHOD);
+    assert_int_equal(failing.status, IPC_RPC_ERR_HANDLER);
+
+    ipc_rpc_destroy(client);
+    ipc_rpc_destroy(server);
+}
+
+/* Test that the in-flight limit is enforced */
+static void test_ipc_rpc_inflight_limit(void **state) {
+    (void) state; // Unused variable
+
+    pipe_end_t client_end, server_end;
+    pipe_pair(&client_end, &server_end);
+    ipc_rpc_t *client = ipc_rpc_create(&client_end.base, 64, 2);
+
+    assert_int_equal(ipc_rpc_call_async(client, 1, NULL, 0, NULL, NULL, NULL), IPC_SUCCESS);
+    assert_int_equal(ipc_rpc_call_async(client, 1, NULL, 0, NULL, NULL, NULL), IPC_SUCCESS);
+    assert_int_equal(ipc_rpc_call_async(client, 1, NULL, 0, NULL, NULL, NULL), IPC_FAILURE);
+    assert_int_equal(ipc_rpc_pending(client), 2);
+
+    ipc_rpc_destroy(client);
+}
+
+/* Test that one slow call does not block later calls while the limit is not reached */
+static void test_ipc_rpc_slow_call_no_blocking(void **state) {
+    (void) state; // Unused variable
+
+    pipe_end_t client_end, server_end;
+    pipe_pair(&client_end, &server_end);
+    ipc_rpc_t *client = ipc_rpc_create(&client_end.base, 64, 4);
+    ipc_rpc_t *server = ipc_rpc_create(&server_end.base, 64, 4);
+    assert_int_equal(ipc_rpc_register(server, 1, echo_handler, NULL), IPC_SUCCESS);
+    assert_int_equal(ipc_rpc_register(server, 2, deferred_handler, NULL), IPC_SUCCESS);
+
+    completion_log_t log = {0};
+    completion_t slow = { .log = &log, .tag = 1 };
+    completion_t fast = { .log = &log, .tag = 2 };
+    uint64_t slow_id, fast_id;
+
+    assert_int_equal(ipc_rpc_call_async(client, 2, "slow", 5, on_complete, &slow, &slow_id), IPC_SUCCESS);
+    assert_int_equal(ipc_rpc_poll(server), IPC_SUCCESS); // deferred
+
+    // Far more calls than table slots, each completing while the slow one is outstanding
+    for (int i = 0; i < 10; i++) {
+        log.count = 0;
+        assert_int_equal(ipc_rpc_call_async(client, 1, "fast", 5, on_complete, &fast, &fast_id), IPC_SUCCESS);
+        assert_int_not_equal(fast_id, slow_id);
+        assert_int_equal(ipc_rpc_poll(server), IPC_SUCCESS);
+        assert_int_equal(ipc_rpc_poll(client), IPC_SUCCESS);
+        assert_int_equal(log.count, 1);
+        assert_int_equal(ipc_rpc_pending(client), 1);
+    }
+
+    log.count = 0;
+    assert_int_equal(ipc_rpc_respond(server, deferred_id, IPC_RPC_OK, "done", 5), IPC_SUCCESS);
+    assert_int_equal(ipc_rpc_poll(client), IPC_SUCCESS);
+    assert_int_equal(log.order[0], 1);
+    assert_string_equal(slow.data, "done");
+    assert_int_equal(ipc_rpc_pending(client), 0);
+
+    ipc_rpc_destroy(client);
+    ipc_rpc_destroy(server);
+}
+
+/* Main function for running the tests */
+int main(void) {
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(test_ipc_rpc_out_of_order),
+        cmocka_unit_test(test_ipc_rpc_errors),
+        cmocka_unit_test(test_ipc_rpc_inflight_limit),
+        cmocka_unit_test(test_ipc_rpc_slow_call_no_blocking),
+    };
+
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
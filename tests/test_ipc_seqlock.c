@@ -0,0 +1,185 @@
+/**
+ * @file test_ipc_seqlock.c
+ * @brief Unit tests for ipc_seqlock.c using CMockA.
+ */
+
+#define _GNU_SOURCE /* memmem() */
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "ipc_seqlock.h"
+
+static char chan_name[64];
+
+typedef struct {
+    uint64_t a;
+    uint64_t payload[30];
+    uint64_t b;
+} snapshot_t;
+
+static ipc_handle_t *open_chan(int is_owner) {
+    ipc_handle_t *chan = ipc_seqlock_create(chan_name, sizeof(snapshot_t), is_owner);
+    assert_non_null(chan);
+    assert_int_equal(chan->init(chan), IPC_SUCCESS);
+    return chan;
+}
+
+/* Test that a receiver only sees the latest value */
+static void test_ipc_seqlock_last_value_wins(void **state) {
+    (void) state; // Unused variable
+
+    ipc_handle_t *tx = open_chan(1);
+    ipc_handle_t *rx = open_chan(0);
+    uint64_t version;
+    char buf[sizeof(snapshot_t)];
+
+    assert_int_equal(ipc_seqlock_read(rx, buf, sizeof(buf), NULL), IPC_FAILURE);
+    assert_int_equal(errno, EAGAIN);
+    assert_int_equal(ipc_seqlock_version(rx), 0);
+    assert_int_equal(ipc_seqlock_version(NULL), 0);
+    assert_int_equal(ipc_seqlock_wait(rx, 0, 10), IPC_FAILURE);
+    assert_int_equal(errno, ETIMEDOUT);
+
+    assert_int_equal(tx->send(tx, "one", 3), IPC_SUCCESS);
+    assert_int_equal(tx->send(tx, "two", 3), IPC_SUCCESS);
+    assert_int_equal(tx->send(tx, "three", 5), IPC_SUCCESS);
+
+    assert_int_equal(rx->receive(rx, buf, sizeof(buf)), 5);
+    assert_memory_equal(buf, "three", 5);
+    assert_int_equal(ipc_seqlock_version(rx), 3);
+    assert_int_equal(ipc_seqlock_wait(rx, 3, 0), IPC_FAILURE);
+
+    assert_int_equal(ipc_seqlock_read(rx, buf, 2, &version), IPC_FAILURE);
+    assert_int_equal(errno, EMSGSIZE);
+    assert_int_equal(version, 3);
+
+    char big[sizeof(snapshot_t) + 1] = {0};
+    assert_int_equal(tx->send(tx, big, sizeof(big)), IPC_FAILURE);
+    assert_int_equal(errno, EMSGSIZE);
+
+    rx->destroy(rx);
+    tx->destroy(tx);
+}
+
+static volatile int writer_done;
+
+static void *writer_thread(void *arg) {
+    ipc_handle_t *tx = (ipc_handle_t *)arg;
+    snapshot_t snap;
+
+    for (uint64_t i = 1; i <= 200000; i++) {
+        snap.a = i;
+        for (int k = 0; k < 30; k++) {
+            snap.payload[k] = i;
+        }
+        snap.b = i;
+        tx->send(tx, &snap, sizeof(snap));
+    }
+    writer_done = 1;
+    return NULL;
+}
+
+/* Test that readers never observe a torn value while the writer runs */
+static void test_ipc_seqlock_consistent_snapshots(void **state) {
+    (void) state; // Unused variable
+
+    ipc_handle_t *tx = open_chan(1);
+    ipc_handle_t *rx = open_chan(0);
+    pthread_t writer;
+    snapshot_t snap;
+    uint64_t last = 0;
+    int torn = 0;
+
+    writer_done = 0;
+    pthread_create(&writer, NULL, writer_thread, tx);
+    while (!writer_done) {
+        if (ipc_seqlock_read(rx, &snap, sizeof(snap), NULL) != sizeof(snap)) {
+            continue;
+        }
+        if (snap.a != snap.b || snap.payload[15] != snap.a || snap.a < last) {
+            torn++;
+        }
+        last = snap.a;
+    }
+    pthread_join(writer, NULL);
+    assert_int_equal(torn, 0);
+    assert_int_equal(ipc_seqlock_version(rx), 200000);
+
+    rx->destroy(rx);
+    tx->destroy(tx);
+}
+
+/* Test that the doorbell wakes a poller once a value is published */
+static void test_ipc_seqlock_doorbell(void **state) {
+    (void) state; // Unused variable
+
+    ipc_handle_t *rx = open_chan(1);
+    ipc_handle_t *tx = open_chan(0);
+    ipc_seqlock_t *chan = (ipc_seqlock_t *)rx;
+    char buf[16];
+
+    assert_int_equal(ipc_seqlock_attach_doorbell(tx, ipc_handle_get_fd(rx)), IPC_SUCCESS);
+    assert_int_equal(ipc_seqlock_wait(rx, 0, 0), IPC_FAILURE);
+    assert_int_equal(ipc_doorbell_wait(&chan->doorbell, 0), IPC_FAILURE);
+    tx->send(tx, "tick", 4);
+    assert_int_equal(ipc_doorbell_wait(&chan->doorbell, 0), IPC_SUCCESS);
+    assert_int_equal(rx->receive(rx, buf, sizeof(buf)), 4);
+    assert_int_equal(ipc_doorbell_wait(&chan->doorbell, 0), IPC_FAILURE);
+
+    tx->destroy(tx);
+    rx->destroy(rx);
+}
+
+/* Test that a value corrupted in the segment fails its checksum */
+static void test_ipc_seqlock_checksum(void **state) {
+    (void) state; // Unused variable
+
+    ipc_handle_t *tx = open_chan(1);
+    ipc_handle_t *rx = open_chan(0);
+    char buf[sizeof(snapshot_t)];
+
+    assert_int_equal(ipc_seqlock_set_checksum(tx, 1), IPC_SUCCESS);
+    assert_int_equal(ipc_seqlock_set_checksum(rx, 1), IPC_SUCCESS);
+    assert_int_equal(tx->send(tx, "quote", 5), IPC_SUCCESS);
+    assert_int_equal(ipc_seqlock_read(rx, buf, sizeof(buf), NULL), 5);
+
+    // A stray write into the slot, outside the seqlock protocol
+    ipc_seqlock_t *chan = (ipc_seqlock_t *)rx;
+    unsigned char *base = (unsigned char *)chan->shm;
+    unsigned char *hit = memmem(base, chan->map_size, "quote", 5);
+    assert_non_null(hit);
+    hit[0] = 'Q';
+    assert_int_equal(ipc_seqlock_read(rx, buf, sizeof(buf), NULL), IPC_FAILURE);
+    assert_int_equal(errno, EBADMSG);
+
+    // A reader that does not verify still gets the value
+    assert_int_equal(ipc_seqlock_set_checksum(rx, 0), IPC_SUCCESS);
+    assert_int_equal(ipc_seqlock_read(rx, buf, sizeof(buf), NULL), 5);
+    assert_memory_equal(buf, "Quote", 5);
+
+    rx->destroy(rx);
+    tx->destroy(tx);
+}
+
+/* Main function for running the tests */
+int main(void) {
+    snprintf(chan_name, sizeof(chan_name), "/test_ipc_seqlock_%d", (int)getpid());
+
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(test_ipc_seqlock_last_value_wins),
+        cmocka_unit_test(test_ipc_seqlock_consistent_snapshots),
+        cmocka_unit_test(test_ipc_seqlock_doorbell),
+        cmocka_unit_test(test_ipc_seqlock_checksum),
+    };
+
+    int ret = cmocka_run_group_tests(tests, NULL, NULL);
+    ipc_seqlock_unlink(chan_name);
+    return ret;
+}
@@ -0,0 +1,218 @@
+/**
+ * @file test_ipc_slab.c
+ * @brief Unit tests for ipc_slab.c using CMockA.
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "ipc_slab.h"
+
+static char slab_name[64];
+
+static ipc_handle_t *open_slab(int is_owner, size_t heap_size, size_t depth) {
+    ipc_handle_t *slab = ipc_slab_create(slab_name, heap_size, depth, is_owner);
+    assert_non_null(slab);
+    assert_int_equal(slab->init(slab), IPC_SUCCESS);
+    return slab;
+}
+
+/* Test that freed blocks are reused by their size class */
+static void test_ipc_slab_alloc_free(void **state) {
+    (void) state; // Unused variable
+
+    ipc_handle_t *slab = open_slab(1, 1 << 20, 16);
+    uint64_t a, b, c;
+
+    assert_non_null(ipc_slab_alloc(slab, 10, &a));
+    assert_non_null(ipc_slab_alloc(slab, 1000, &b));
+    assert_int_equal(ipc_slab_free(slab, a), IPC_SUCCESS);
+    assert_int_equal(ipc_slab_free(slab, a), IPC_FAILURE); // already free
+    assert_int_equal(errno, EINVAL);
+
+    assert_non_null(ipc_slab_alloc(slab, 50, &c));
+    assert_int_equal(c, a); // same 64-byte class
+    assert_int_equal(ipc_slab_free(slab, c), IPC_SUCCESS);
+    assert_int_equal(ipc_slab_free(slab, b), IPC_SUCCESS);
+    assert_int_equal(ipc_slab_free(slab, b + 8), IPC_FAILURE);
+
+    assert_null(ipc_slab_alloc(slab, IPC_SLAB_MAX_BLOCK, &a));
+    assert_int_equal(errno, EMSGSIZE);
+    assert_null(ipc_slab_alloc(slab, 2 << 20, &a));
+    assert_int_equal(errno, ENOMEM);
+
+    slab->destroy(slab);
+}
+
+/* Test passing messages by offset and by copy */
+static void test_ipc_slab_offsets(void **state) {
+    (void) state; // Unused variable
+
+    ipc_handle_t *tx = open_slab(1, 1 << 16, 4);
+    ipc_handle_t *rx = open_slab(0, 0, 0);
+    const void *data;
+    uint64_t off, got;
+    size_t len;
+    char buf[64];
+
+    char *msg = (char *)ipc_slab_alloc(tx, 5, &off);
+    memcpy(msg, "hello", 5);
+    assert_int_equal(ipc_slab_send_offset(tx, off, 5), IPC_SUCCESS);
+    assert_int_equal(tx->send(tx, "world!", 6), IPC_SUCCESS);
+
+    assert_int_equal(ipc_slab_receive_view(rx, &got, &data, &len, 0), IPC_SUCCESS);
+    assert_int_equal(got, off);
+    assert_int_equal(len, 5);
+    assert_memory_equal(data, "hello", 5);
+    assert_ptr_equal(ipc_slab_ptr(rx, got), data);
+    assert_int_equal(ipc_slab_free(rx, got), IPC_SUCCESS);
+
+    assert_int_equal(rx->receive(rx, buf, sizeof(buf)), 6);
+    assert_memory_equal(buf, "world!", 6);
+
+    assert_int_equal(ipc_slab_receive_view(rx, &got, &data, &len, 0), IPC_FAILURE);
+    assert_int_equal(errno, EAGAIN);
+    assert_int_equal(ipc_slab_receive_view(rx, &got, &data, &len, 10), IPC_FAILURE);
+    assert_int_equal(errno, ETIMEDOUT);
+
+    // The queue holds four messages
+    for (int i = 0; i < 4; i++) {
+        assert_int_equal(tx->send(tx, "x", 1), IPC_SUCCESS);
+    }
+    assert_int_equal(tx->send(tx, "x", 1), IPC_FAILURE);
+    assert_int_equal(errno, EAGAIN);
+
+    rx->destroy(rx);
+    tx->destroy(tx);
+}
+
+/* Test a receiver in another process blocking until messages arrive */
+static void test_ipc_slab_cross_process(void **state) {
+    (void) state; // Unused variable
+
+    ipc_handle_t *tx = open_slab(1, 1 << 20, 64);
+    int status;
+
+    pid_t pid = fork();
+    if (pid == 0) {
+        ipc_handle_t *rx = ipc_slab_create(slab_name, 0, 0, 0);
+        const void *data;
+        uint64_t off;
+        size_t len;
+        if (rx->init(rx) != IPC_SUCCESS) {
+            _exit(1);
+        }
+        for (uint32_t i = 0; i < 1000; i++) {
+            if (ipc_slab_receive_view(rx, &off, &data, &len, 5000) != IPC_SUCCESS ||
+                len != 100 + i % 500 || ((const unsigned char *)data)[len - 1] != (unsigned char)i) {
+                _exit(2);
+            }
+            ipc_slab_free(rx, off);
+        }
+        _exit(0);
+    }
+
+    for (uint32_t i = 0; i < 1000; i++) {
+        uint64_t off;
+        size_t len = 100 + i % 500;
+        unsigned char *msg;
+        while (!(msg = (unsigned char *)ipc_slab_alloc(tx, len, &off))) {
+            usleep(100);
+        }
+        memset(msg, (unsigned char)i, len);
+        while (ipc_slab_send_offset(tx, off, len) != IPC_SUCCESS) {
+            usleep(100);
+        }
+    }
+    assert_int_equal(waitpid(pid, &status, 0), pid);
+    assert_true(WIFEXITED(status));
+    assert_int_equal(WEXITSTATUS(status), 0);
+
+    tx->destroy(tx);
+}
+
+/* Test that the doorbell becomes readable for a poller once a message arrives */
+static void test_ipc_slab_doorbell(void **state) {
+    (void) state; // Unused variable
+
+    ipc_handle_t *rx = open_slab(1, 1 << 16, 4);
+    ipc_handle_t *tx = open_slab(0, 0, 0);
+    const void *data;
+    uint64_t off;
+    size_t len;
+
+    assert_int_equal(ipc_handle_get_fd(tx), IPC_FAILURE);
+    assert_int_equal(ipc_slab_attach_doorbell(tx, ipc_handle_get_fd(rx)), IPC_SUCCESS);
+
+    // An empty receive arms the doorbell
+    assert_int_equal(ipc_slab_receive_view(rx, &off, &data, &len, 0), IPC_FAILURE);
+    ipc_slab_t *slab = (ipc_slab_t *)rx;
+    assert_int_equal(ipc_doorbell_wait(&slab->doorbell, 0), IPC_FAILURE);
+    assert_int_equal(tx->send(tx, "ping", 4), IPC_SUCCESS);
+    assert_int_equal(ipc_doorbell_wait(&slab->doorbell, 0), IPC_SUCCESS);
+    assert_int_equal(ipc_slab_receive_view(rx, &off, &data, &len, 0), IPC_SUCCESS);
+    assert_int_equal(ipc_doorbell_wait(&slab->doorbell, 0), IPC_FAILURE);
+    ipc_slab_free(rx, off);
+
+    tx->destroy(tx);
+    rx->destroy(rx);
+}
+
+/* Test that a block modified after it was queued fails its checksum */
+static void test_ipc_slab_checksum(void **state) {
+    (void) state; // Unused variable
+
+    ipc_handle_t *tx = open_slab(1, 1 << 16, 4);
+    ipc_handle_t *rx = open_slab(0, 0, 0);
+    const void *data;
+    uint64_t off, got;
+    size_t len;
+    char buf[16];
+
+    assert_int_equal(ipc_slab_set_checksum(tx, 1), IPC_SUCCESS);
+    assert_int_equal(ipc_slab_set_checksum(rx, 1), IPC_SUCCESS);
+
+    assert_int_equal(tx->send(tx, "checked", 7), IPC_SUCCESS);
+    assert_int_equal(rx->receive(rx, buf, sizeof(buf)), 7);
+    assert_memory_equal(buf, "checked", 7);
+
+    char *msg = (char *)ipc_slab_alloc(tx, 5, &off);
+    memcpy(msg, "clean", 5);
+    assert_int_equal(ipc_slab_send_offset(tx, off, 5), IPC_SUCCESS);
+    msg[0] = 'C'; // The sender no longer owns the block
+    assert_int_equal(ipc_slab_receive_view(rx, &got, &data, &len, 0), IPC_FAILURE);
+    assert_int_equal(errno, EBADMSG);
+    assert_int_equal(ipc_slab_free(rx, got), IPC_FAILURE); // already freed
+
+    // Messages queued without a checksum are accepted
+    assert_int_equal(ipc_slab_set_checksum(tx, 0), IPC_SUCCESS);
+    assert_int_equal(tx->send(tx, "plain", 5), IPC_SUCCESS);
+    assert_int_equal(rx->receive(rx, buf, sizeof(buf)), 5);
+
+    rx->destroy(rx);
+    tx->destroy(tx);
+}
+
+/* Main function for running the tests */
+int main(void) {
+    snprintf(slab_name, sizeof(slab_name), "/test_ipc_slab_%d", (int)getpid());
+
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(test_ipc_slab_alloc_free),
+        cmocka_unit_test(test_ipc_slab_offsets),
+        cmocka_unit_test(test_ipc_slab_cross_process),
+        cmocka_unit_test(test_ipc_slab_doorbell),
+        cmocka_unit_test(test_ipc_slab_checksum),
+    };
+
+    int ret = cmocka_run_group_tests(tests, NULL, NULL);
+    ipc_slab_unlink(slab_name);
+    return ret;
+}
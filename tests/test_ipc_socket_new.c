@@ -3,6 +3,7 @@
  * @brief Unit tests for ipc_socket.c using CMockA, adapted to use libipc function pointers.
  */
 
+#define _GNU_SOURCE /* CPU_SETSIZE */
 #include <stdarg.h>
 #include <stddef.h>
 #include <setjmp.h>
@@ -12,9 +13,17 @@
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <unistd.h>
+#include <fcntl.h>
 #include <stdlib.h>
 #include <string.h>
+#include <errno.h>
+#include <sched.h>
+#include <sys/time.h>
+#include <sys/ioctl.h>
+#include <pthread.h>
 #include "ipc_socket.h"
+#include "ipc_frame.h"
+#include "ipc_crc32c.h"
 #include "ipc.h"  // For ipc_handle_t and related function pointers
 
 /* Mocking system calls */
@@ -207,6 +216,359 @@ static void test_ipc_socket_create(void **state) {
     sock->destroy(sock); // Cleanup
 }
 
+/* Loopback helpers for the tests that run against real sockets */
+typedef struct {
+    int fd; /**< Descriptor to read from. */
+    size_t len; /**< Bytes to read. */
+    unsigned char *data; /**< Bytes read. */
+} reader_t;
+
+static void connect_pair(ipc_handle_t **server, ipc_handle_t **client, ipc_handle_t **conn) {
+    struct sockaddr_in addr;
+    socklen_t addr_len = sizeof(addr);
+
+    // Listen on a port picked by the kernel, so reruns never collide with TIME_WAIT
+    *server = ipc_socket_create("127.0.0.1", 0, 1);
+    assert_non_null(*server);
+    assert_int_equal((*server)->init(*server), IPC_SUCCESS);
+    assert_int_equal(getsockname((*server)->get_fd(*server), (struct sockaddr *)&addr, &addr_len), 0);
+    *client = ipc_socket_create("127.0.0.1", ntohs(addr.sin_port), 0);
+    assert_non_null(*client);
+    assert_int_equal((*client)->init(*client), IPC_SUCCESS);
+    *conn = (*server)->accept(*server);
+    assert_non_null(*conn);
+}
+
+static void set_timeout(ipc_handle_t *handle) {
+    struct timeval tv = { 5, 0 };
+
+    // Lost bytes fail the test instead of hanging it
+    setsockopt(handle->get_fd(handle), SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+}
+
+static int queued(ipc_handle_t *handle) {
+    int bytes = -1;
+
+    ioctl(handle->get_fd(handle), FIONREAD, &bytes);
+    return bytes;
+}
+
+static void close_pair(ipc_handle_t *server, ipc_handle_t *client, ipc_handle_t *conn) {
+    client->destroy(client);
+    conn->destroy(conn);
+    server->destroy(server);
+}
+
+static void *read_all(void *arg) {
+    reader_t *r = (reader_t *)arg;
+    size_t got = 0;
+
+    while (got < r->len) {
+        ssize_t n = read(r->fd, r->data + got, r->len - got);
+        if (n <= 0) {
+            break;
+        }
+        got += (size_t)n;
+    }
+    r->len = got;
+    return NULL;
+}
+
+static void *echo_once(void *arg) {
+    ipc_handle_t *conn = (ipc_handle_t *)arg;
+    char buf[64];
+
+    int len = conn->receive(conn, buf, sizeof(buf));
+    if (len > 0) {
+        conn->send(conn, buf, (size_t)len);
+    }
+    return NULL;
+}
+
+/* Test that a busy-polled socket sends a message larger than its send buffer in full */
+static void test_ipc_socket_busy_poll_large_send(void **state) {
+    (void) state; // Unused variable
+
+    ipc_handle_t *server, *client, *conn;
+    size_t len = 4 << 20;
+    int sndbuf = 16384;
+    unsigned char *msg = (unsigned char *)malloc(len);
+    reader_t reader = { 0, len, (unsigned char *)malloc(len) };
+    pthread_t thread;
+
+    assert_non_null(msg);
+    assert_non_null(reader.data);
+    for (size_t i = 0; i < len; i++) {
+        msg[i] = (unsigned char)(i * 7 + (i >> 12));
+    }
+    connect_pair(&server, &client, &conn);
+    assert_int_equal(ipc_socket_set_busy_poll(client, CPU_SETSIZE, 50), IPC_FAILURE);
+    assert_int_equal(errno, EINVAL);
+    setsockopt(client->get_fd(client), SOL_SOCKET, SO_SNDBUF, &sndbuf, sizeof(sndbuf));
+    assert_int_equal(ipc_socket_set_busy_poll(client, -1, 50), IPC_SUCCESS);
+
+    // Lost bytes end the read with a timeout instead of hanging the test
+    struct timeval tv = { 5, 0 };
+    reader.fd = conn->get_fd(conn);
+    setsockopt(reader.fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    assert_int_equal(pthread_create(&thread, NULL, read_all, &reader), 0);
+    assert_int_equal(client->send(client, msg, len), IPC_SUCCESS);
+    pthread_join(thread, NULL);
+    assert_int_equal(reader.len, len);
+    assert_memory_equal(reader.data, msg, len);
+
+    close_pair(server, client, conn);
+    free(reader.data);
+    free(msg);
+}
+
+/* Test read-ahead views across reads, oversize frames and resizing */
+static void test_ipc_socket_read_ahead(void **state) {
+    (void) state; // Unused variable
+
+    ipc_handle_t *server, *client, *conn;
+    unsigned char msg[100];
+    const void *data;
+    size_t len;
+
+    connect_pair(&server, &client, &conn);
+    set_timeout(conn);
+    assert_int_equal(ipc_socket_set_framing(client, 1), IPC_SUCCESS);
+    assert_int_equal(ipc_socket_set_framing(conn, 1), IPC_SUCCESS);
+    assert_int_equal(ipc_socket_set_read_ahead(conn, IPC_FRAME_HDR_SIZE + IPC_CRC32C_SIZE - 1), IPC_FAILURE);
+    assert_int_equal(errno, EINVAL);
+    assert_int_equal(ipc_socket_set_read_ahead(conn, 64), IPC_SUCCESS);
+
+    // Three 28-byte frames do not fit in 64 bytes, so the last one spans two reads
+    for (int i = 0; i < 3; i++) {
+        memset(msg, 'a' + i, 20);
+        assert_int_equal(client->send(client, msg, 20), IPC_SUCCESS);
+    }
+    for (int i = 0; i < 3; i++) {
+        memset(msg, 'a' + i, 20);
+        assert_int_equal(ipc_socket_receive_view(conn, &data, &len), IPC_SUCCESS);
+        assert_int_equal(len, 20);
+        assert_memory_equal(data, msg, 20);
+    }
+
+    // A frame larger than the buffer is discarded and the stream stays in sync
+    memset(msg, 'x', sizeof(msg));
+    assert_int_equal(client->send(client, msg, sizeof(msg)), IPC_SUCCESS);
+    assert_int_equal(client->send(client, "next", 4), IPC_SUCCESS);
+    assert_int_equal(ipc_socket_receive_view(conn, &data, &len), IPC_FAILURE);
+    assert_int_equal(errno, EMSGSIZE);
+    assert_int_equal(ipc_socket_receive_view(conn, &data, &len), IPC_SUCCESS);
+    assert_int_equal(len, 4);
+    assert_memory_equal(data, "next", 4);
+
+    // Buffered frames survive growing the buffer but block shrinking it
+    for (int i = 0; i < 3; i++) {
+        memset(msg, '0' + i, 4);
+        assert_int_equal(client->send(client, msg, 4), IPC_SUCCESS);
+    }
+    assert_int_equal(ipc_socket_receive_view(conn, &data, &len), IPC_SUCCESS);
+    assert_int_equal(ipc_socket_set_read_ahead(conn, 16), IPC_FAILURE);
+    assert_int_equal(errno, EBUSY);
+    assert_int_equal(ipc_socket_set_read_ahead(conn, 256), IPC_SUCCESS);
+    for (int i = 1; i < 3; i++) {
+        memset(msg, '0' + i, 4);
+        assert_int_equal(ipc_socket_receive_view(conn, &data, &len), IPC_SUCCESS);
+        assert_int_equal(len, 4);
+        assert_memory_equal(data, msg, 4);
+    }
+    assert_int_equal(ipc_socket_set_read_ahead(conn, 0), IPC_SUCCESS);
+
+    close_pair(server, client, conn);
+}
+
+/* Test when the write buffer is written: when full, when flushed and before a receive */
+static void test_ipc_socket_write_coalescing(void **state) {
+    (void) state; // Unused variable
+
+    ipc_handle_t *server, *client, *conn;
+    unsigned char msg[40], buf[64];
+    pthread_t thread;
+
+    connect_pair(&server, &client, &conn);
+    set_timeout(client);
+    set_timeout(conn);
+    assert_int_equal(ipc_socket_set_framing(client, 1), IPC_SUCCESS);
+    assert_int_equal(ipc_socket_set_framing(conn, 1), IPC_SUCCESS);
+    assert_int_equal(ipc_socket_set_write_buffer(client, 64, 0), IPC_SUCCESS);
+
+    // Three 12-byte frames stay buffered; a 48-byte one overflows and goes with them
+    for (int i = 0; i < 3; i++) {
+        assert_int_equal(client->send(client, "abcd", 4), IPC_SUCCESS);
+    }
+    assert_int_equal(queued(conn), 0);
+    memset(msg, 'm', sizeof(msg));
+    assert_int_equal(client->send(client, msg, sizeof(msg)), IPC_SUCCESS);
+    assert_int_equal(queued(conn), 3 * 12 + 48);
+    for (int i = 0; i < 3; i++) {
+        assert_int_equal(conn->receive(conn, buf, sizeof(buf)), 4);
+        assert_memory_equal(buf, "abcd", 4);
+    }
+    assert_int_equal(conn->receive(conn, buf, sizeof(buf)), sizeof(msg));
+    assert_memory_equal(buf, msg, sizeof(msg));
+
+    // An explicit flush writes what is buffered
+    assert_int_equal(client->send(client, "efgh", 4), IPC_SUCCESS);
+    assert_int_equal(queued(conn), 0);
+    assert_int_equal(ipc_socket_flush(client), IPC_SUCCESS);
+    assert_int_equal(queued(conn), 12);
+    assert_int_equal(conn->receive(conn, buf, sizeof(buf)), 4);
+    assert_memory_equal(buf, "efgh", 4);
+
+    // A receive flushes the buffered request before waiting for the reply
+    assert_int_equal(pthread_create(&thread, NULL, echo_once, conn), 0);
+    assert_int_equal(client->send(client, "ping", 4), IPC_SUCCESS);
+    assert_int_equal(client->receive(client, buf, sizeof(buf)), 4);
+    assert_memory_equal(buf, "ping", 4);
+    pthread_join(thread, NULL);
+
+    close_pair(server, client, conn);
+}
+
+static void *fill_pipe(void *arg) {
+    reader_t *w = (reader_t *)arg;
+
+    // Writes more than a pipe holds, so the sender splices while this blocks
+    if (write(w->fd, w->data, w->len) != (ssize_t)w->len) {
+        w->len = 0;
+    }
+    close(w->fd);
+    return NULL;
+}
+
+/* Test streaming a file with sendfile() and a pipe with splice() */
+static void test_ipc_socket_send_file(void **state) {
+    (void) state; // Unused variable
+
+    ipc_handle_t *server, *client, *conn;
+    char path[] = "/tmp/test_ipc_send_file_XXXXXX";
+    size_t size = 2 << 20, skip = 100, len = size - skip - 50;
+    int sndbuf = 16384;
+    unsigned char *data = (unsigned char *)malloc(size);
+    reader_t reader = { 0, 0, (unsigned char *)malloc(size) };
+    pthread_t thread, writer;
+    int pipefd[2];
+
+    assert_non_null(data);
+    assert_non_null(reader.data);
+    for (size_t i = 0; i < size; i++) {
+        data[i] = (unsigned char)(i * 13 + (i >> 10));
+    }
+    int fd = mkstemp(path);
+    assert_true(fd >= 0);
+    unlink(path);
+    assert_int_equal(write(fd, data, size), (ssize_t)size);
+
+    connect_pair(&server, &client, &conn);
+    set_timeout(conn);
+    reader.fd = conn->get_fd(conn);
+
+    // A non-blocking sender with a small buffer resumes sendfile() after EAGAIN
+    setsockopt(client->get_fd(client), SOL_SOCKET, SO_SNDBUF, &sndbuf, sizeof(sndbuf));
+    assert_int_equal(ipc_socket_set_busy_poll(client, -1, 50), IPC_SUCCESS);
+    reader.len = len;
+    assert_int_equal(pthread_create(&thread, NULL, read_all, &reader), 0);
+    assert_int_equal(ipc_send_file(client, fd, (off_t)skip, len), IPC_SUCCESS);
+    pthread_join(thread, NULL);
+    assert_int_equal(reader.len, len);
+    assert_memory_equal(reader.data, data + skip, len);
+    assert_int_equal(lseek(fd, 0, SEEK_CUR), (off_t)size);
+
+    // sendfile() cannot read a pipe, so this goes through splice()
+    reader_t source = { 0, 256 << 10, data };
+    assert_int_equal(pipe(pipefd), 0);
+    source.fd = pipefd[1];
+    assert_int_equal(pthread_create(&writer, NULL, fill_pipe, &source), 0);
+    reader.len = source.len;
+    assert_int_equal(pthread_create(&thread, NULL, read_all, &reader), 0);
+    assert_int_equal(ipc_send_file(client, pipefd[0], 0, source.len), IPC_SUCCESS);
+    pthread_join(writer, NULL);
+    pthread_join(thread, NULL);
+    close(pipefd[0]);
+    assert_int_equal(source.len, 256 << 10);
+    assert_int_equal(reader.len, source.len);
+    assert_memory_equal(reader.data, data, source.len);
+
+    // Framed, the range arrives as one message
+    assert_int_equal(ipc_socket_set_framing(client, 1), IPC_SUCCESS);
+    assert_int_equal(ipc_socket_set_framing(conn, 1), IPC_SUCCESS);
+    assert_int_equal(ipc_send_file(client, fd, 0, 1000), IPC_SUCCESS);
+    assert_int_equal(conn->receive(conn, reader.data, size), 1000);
+    assert_memory_equal(reader.data, data, 1000);
+
+    // A file shorter than the range fails with EIO
+    assert_int_equal(ipc_socket_set_framing(client, 0), IPC_SUCCESS);
+    assert_int_equal(ipc_send_file(client, fd, (off_t)size, 10), IPC_FAILURE);
+    assert_int_equal(errno, EIO);
+
+    close_pair(server, client, conn);
+    close(fd);
+    free(reader.data);
+    free(data);
+}
+
+/* Test that a framed checksum mismatch fails with EBADMSG and keeps the stream in sync */
+static void test_ipc_socket_checksum(void **state) {
+    (void) state; // Unused variable
+
+    ipc_handle_t *server, *client, *conn;
+    unsigned char frame[IPC_FRAME_HDR_SIZE + 5 + IPC_CRC32C_SIZE];
+    ipc_frame_hdr_t hdr = { .length = 5, .flags = IPC_FRAME_FLAG_CRC32C };
+    char buf[64];
+
+    connect_pair(&server, &client, &conn);
+    set_timeout(conn);
+    assert_int_equal(ipc_socket_set_framing(client, 1), IPC_SUCCESS);
+    assert_int_equal(ipc_socket_set_framing(conn, 1), IPC_SUCCESS);
+    assert_int_equal(ipc_socket_set_checksum(client, 1), IPC_SUCCESS);
+    assert_int_equal(ipc_socket_set_checksum(conn, 1), IPC_SUCCESS);
+
+    // A frame whose trailer does not match its payload, then a good one
+    ipc_frame_hdr_encode(frame, &hdr);
+    memcpy(frame + IPC_FRAME_HDR_SIZE, "hello", 5);
+    ipc_frame_crc_encode(frame + IPC_FRAME_HDR_SIZE + 5, ipc_crc32c(0, "hello", 5) ^ 1);
+    assert_int_equal(write(client->get_fd(client), frame, sizeof(frame)), (ssize_t)sizeof(frame));
+    assert_int_equal(client->send(client, "world", 5), IPC_SUCCESS);
+
+    assert_int_equal(conn->receive(conn, buf, sizeof(buf)), IPC_FAILURE);
+    assert_int_equal(errno, EBADMSG);
+    assert_int_equal(conn->receive(conn, buf, sizeof(buf)), 5);
+    assert_memory_equal(buf, "world", 5);
+
+    close_pair(server, client, conn);
+}
+
+/* Test that a send on a blocking socket still honours SO_SNDTIMEO */
+static void test_ipc_socket_send_timeout(void **state) {
+    (void) state; // Unused variable
+
+    ipc_handle_t *server, *client, *conn;
+    size_t len = 16 << 20;
+    unsigned char *msg = (unsigned char *)calloc(1, len);
+    struct timeval tv = { 0, 100000 };
+    int fd;
+
+    assert_non_null(msg);
+    connect_pair(&server, &client, &conn);
+    setsockopt(client->get_fd(client), SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+
+    // Nobody reads conn, so the buffers fill up and the send times out
+    assert_int_equal(client->send(client, msg, len), IPC_FAILURE);
+    assert_true(errno == EAGAIN || errno == EWOULDBLOCK);
+    fd = open("/dev/zero", O_RDONLY);
+    assert_true(fd >= 0);
+    assert_int_equal(ipc_send_file(client, fd, 0, len), IPC_FAILURE);
+    assert_true(errno == EAGAIN || errno == EWOULDBLOCK);
+    close(fd);
+
+    close_pair(server, client, conn);
+    free(msg);
+}
+
 /* Main function for running the tests */
 int main(void) {
     const struct CMUnitTest tests[] = {
@@ -217,6 +579,12 @@ int main(void) {
         cmocka_unit_test(test_ipc_socket_destroy),
         cmocka_unit_test(test_ipc_socket_accept),
         cmocka_unit_test(test_ipc_socket_create),
+        cmocka_unit_test(test_ipc_socket_busy_poll_large_send),
+        cmocka_unit_test(test_ipc_socket_read_ahead),
+        cmocka_unit_test(test_ipc_socket_write_coalescing),
+        cmocka_unit_test(test_ipc_socket_send_file),
+        cmocka_unit_test(test_ipc_socket_checksum),
+        cmocka_unit_test(test_ipc_socket_send_timeout),
     };
 
     return cmocka_run_group_tests(tests, NULL, NULL);
@@ -0,0 +1,139 @@
+/**
+ * @file test_ipc_udp.c
+ * @brief Unit tests for ipc_udp.c using CMockA.
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/time.h>
+#include "ipc_udp.h"
+
+#define TEST_PORT 9461
+
+static ipc_handle_t *open_udp(int port, int is_server) {
+    ipc_handle_t *udp = ipc_udp_create("127.0.0.1", port, is_server);
+    struct timeval tv = { 2, 0 };
+
+    assert_non_null(udp);
+    assert_int_equal(udp->init(udp), IPC_SUCCESS);
+    // A datagram sent to the wrong peer fails the test instead of hanging it
+    setsockopt(udp->get_fd(udp), SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    return udp;
+}
+
+/* Test that batched datagrams of mixed sizes arrive intact and in order */
+static void test_ipc_udp_batch(void **state) {
+    (void) state; // Unused variable
+
+    ipc_handle_t *rx = open_udp(TEST_PORT, 1);
+    ipc_handle_t *tx = open_udp(TEST_PORT, 0);
+    unsigned char msg[512], buf[512];
+
+    assert_int_equal(ipc_udp_set_batch(tx, 8, 512), IPC_SUCCESS);
+    assert_int_equal(ipc_udp_set_batch(rx, 8, 512), IPC_SUCCESS);
+    for (int i = 0; i < 20; i++) {
+        memset(msg, i, sizeof(msg));
+        assert_int_equal(tx->send(tx, msg, (size_t)(i * 17 + 1)), IPC_SUCCESS);
+    }
+    assert_int_equal(ipc_udp_flush(tx), IPC_SUCCESS);
+
+    for (int i = 0; i < 20; i++) {
+        assert_int_equal(rx->receive(rx, buf, sizeof(buf)), i * 17 + 1);
+        memset(msg, i, sizeof(msg));
+        assert_memory_equal(buf, msg, (size_t)(i * 17 + 1));
+    }
+    assert_int_equal(ipc_udp_pending(rx), 0);
+
+    // A datagram larger than the receive buffer is dropped with EMSGSIZE
+    assert_int_equal(tx->send(tx, msg, 100), IPC_SUCCESS);
+    assert_int_equal(ipc_udp_flush(tx), IPC_SUCCESS);
+    assert_int_equal(rx->receive(rx, buf, 10), IPC_FAILURE);
+    assert_int_equal(errno, EMSGSIZE);
+
+    tx->destroy(tx);
+    rx->destroy(rx);
+}
+
+/* Test that a GSO batch is split back into the original datagrams */
+static void test_ipc_udp_offload(void **state) {
+    (void) state; // Unused variable
+
+    ipc_handle_t *rx = open_udp(TEST_PORT + 1, 1);
+    ipc_handle_t *tx = open_udp(TEST_PORT + 1, 0);
+    unsigned char msg[200], buf[200];
+
+    assert_int_equal(ipc_udp_set_batch(tx, 16, 200), IPC_SUCCESS);
+    assert_int_equal(ipc_udp_set_batch(rx, 16, 200), IPC_SUCCESS);
+    if (ipc_udp_set_offload(tx, 1, 0) != IPC_SUCCESS || ipc_udp_set_offload(rx, 0, 1) != IPC_SUCCESS) {
+        assert_int_equal(errno, ENOPROTOOPT);
+        tx->destroy(tx);
+        rx->destroy(rx);
+        skip(); // Kernel without UDP_SEGMENT / UDP_GRO
+    }
+
+    // 15 full-size datagrams and a shorter last one
+    for (int i = 0; i < 16; i++) {
+        memset(msg, 'a' + i, sizeof(msg));
+        assert_int_equal(tx->send(tx, msg, i == 15 ? 50 : 200), IPC_SUCCESS);
+    }
+    for (int i = 0; i < 16; i++) {
+        assert_int_equal(rx->receive(rx, buf, sizeof(buf)), i == 15 ? 50 : 200);
+        memset(msg, 'a' + i, sizeof(msg));
+        assert_memory_equal(buf, msg, i == 15 ? 50 : 200);
+    }
+
+    tx->destroy(tx);
+    rx->destroy(rx);
+}
+
+/* Test that queued server replies go to the client each one answers */
+static void test_ipc_udp_server_reply_address(void **state) {
+    (void) state; // Unused variable
+
+    ipc_handle_t *server = open_udp(TEST_PORT + 2, 1);
+    ipc_handle_t *a = open_udp(TEST_PORT + 2, 0);
+    ipc_handle_t *b = open_udp(TEST_PORT + 2, 0);
+    char buf[16];
+
+    // Equal-size replies would be one GSO buffer if destinations were ignored
+    assert_int_equal(ipc_udp_set_batch(server, 4, 16), IPC_SUCCESS);
+    ipc_udp_set_offload(server, 1, 0);
+
+    for (int round = 0; round < 2; round++) {
+        assert_int_equal(a->send(a, "a", 1), IPC_SUCCESS);
+        assert_int_equal(server->receive(server, buf, sizeof(buf)), 1);
+        assert_int_equal(server->send(server, "to-a", 4), IPC_SUCCESS);
+        assert_int_equal(b->send(b, "b", 1), IPC_SUCCESS);
+        assert_int_equal(server->receive(server, buf, sizeof(buf)), 1);
+        assert_int_equal(server->send(server, "to-b", 4), IPC_SUCCESS);
+        assert_int_equal(ipc_udp_flush(server), IPC_SUCCESS);
+
+        assert_int_equal(a->receive(a, buf, sizeof(buf)), 4);
+        assert_memory_equal(buf, "to-a", 4);
+        assert_int_equal(b->receive(b, buf, sizeof(buf)), 4);
+        assert_memory_equal(buf, "to-b", 4);
+        // Second round: the same flow without offload
+        ipc_udp_set_offload(server, 0, 0);
+    }
+
+    b->destroy(b);
+    a->destroy(a);
+    server->destroy(server);
+}
+
+/* Main function for running the tests */
+int main(void) {
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(test_ipc_udp_batch),
+        cmocka_unit_test(test_ipc_udp_offload),
+        cmocka_unit_test(test_ipc_udp_server_reply_address),
+    };
+
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}